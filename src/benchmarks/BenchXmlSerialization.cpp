@@ -0,0 +1,746 @@
+#include <QtTest>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QTemporaryDir>
+#include "XmlDocument.h"
+#include "XmlBatchLoader.h"
+#include "XmlCodecContext.h"
+#include "XmlFastReader.h"
+#include "XmlHelpers.h"
+#include "VehicleTypes.h"
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+/**
+ * Peak resident set size of the process in KiB, -1 if unknown
+ */
+qint64 peakRssKb() {
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return qint64(counters.PeakWorkingSetSize / 1024);
+    }
+    return -1;
+#elif defined(Q_OS_UNIX)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+#if defined(Q_OS_DARWIN)
+    return qint64(usage.ru_maxrss / 1024);  // bytes on macOS
+#else
+    return qint64(usage.ru_maxrss);
+#endif
+#else
+    return -1;
+#endif
+}
+
+/**
+ * Counts QBENCHMARK iterations and reports the rates they imply
+ *
+ * QBENCHMARK itself only prints time per iteration; this adds MB/s,
+ * objects/s and the process's peak RSS so far (it never shrinks, so
+ * read it as the high-water mark up to and including this case).
+ */
+class Throughput {
+public:
+    Throughput() : m_iterations(0) { m_timer.start(); }
+
+    void tick() { ++m_iterations; }
+
+    void report(qint64 bytesPerIteration, qint64 objectsPerIteration) const {
+        const double seconds = m_timer.nsecsElapsed() / 1e9;
+        if (m_iterations == 0 || seconds <= 0) {
+            return;
+        }
+
+        QString line = QString("%1 [%2]:")
+            .arg(QTest::currentTestFunction())
+            .arg(QTest::currentDataTag() ? QTest::currentDataTag() : "");
+        if (bytesPerIteration > 0) {
+            line += QString(" %1 MB/s (%2 bytes),")
+                .arg(bytesPerIteration * m_iterations / seconds / (1024.0 * 1024.0), 0, 'f', 1)
+                .arg(bytesPerIteration);
+        }
+        line += QString(" %1 objects/s, peak RSS %2 MB")
+            .arg(objectsPerIteration * m_iterations / seconds, 0, 'f', 0)
+            .arg(peakRssKb() / 1024);
+        qInfo().noquote() << line;
+    }
+
+private:
+    QElapsedTimer m_timer;
+    qint64 m_iterations;
+};
+
+enum SaveMode { Pretty, Compact, DirectUtf8 };
+
+/**
+ * Same mix as tests/fleet_sample.xml: one plain vehicle for every two cars
+ */
+QSharedPointer<Fleet> makeFleet(int vehicles) {
+    QSharedPointer<Fleet> fleet = QSharedPointer<Fleet>::create();
+    fleet->setName("Corporate Fleet 2024");
+    for (int i = 0; i < vehicles; ++i) {
+        QSharedPointer<Vehicle> vehicle;
+        if (i % 3 == 0) {
+            vehicle = QSharedPointer<Vehicle>::create();
+        } else {
+            QSharedPointer<Car> car = QSharedPointer<Car>::create();
+            car->setNumDoors(i % 2 ? 4 : 2);
+            car->setTrunkCapacity(200.0 + i % 300 + 0.5);
+            vehicle = car;
+        }
+        vehicle->setId(QString("V%1").arg(i, 7, 10, QChar('0')));
+        vehicle->setLicensePlate(QString("ABC-%1").arg(i % 10000, 4, 10, QChar('0')));
+        vehicle->setYear(2000 + i % 25);
+        vehicle->setManufacturer(i % 2 ? "Generic Motors" : "Luxury Cars Inc");
+        fleet->addVehicle(vehicle);
+    }
+    return fleet;
+}
+
+enum BuildMode { Copy, Move, Build };
+
+/**
+ * makeFleet's vehicles through the copying setters (as before the rvalue
+ * overloads), the moving setters with emplaceVehicle, or Car::Builder
+ */
+QSharedPointer<Fleet> buildFleet(int vehicles, BuildMode mode) {
+    QSharedPointer<Fleet> fleet = QSharedPointer<Fleet>::create();
+    fleet->setName(QString("Corporate Fleet 2024"));
+    if (mode != Copy) {
+        fleet->reserveVehicles(vehicles);
+    }
+    for (int i = 0; i < vehicles; ++i) {
+        QString id = QString("V%1").arg(i, 7, 10, QChar('0'));
+        QString plate = QString("ABC-%1").arg(i % 10000, 4, 10, QChar('0'));
+        QString manufacturer = i % 2 ? "Generic Motors" : "Luxury Cars Inc";
+        if (mode == Copy) {
+            QSharedPointer<Vehicle> vehicle;
+            if (i % 3 == 0) {
+                vehicle = QSharedPointer<Vehicle>::create();
+            } else {
+                QSharedPointer<Car> car = QSharedPointer<Car>::create();
+                car->setNumDoors(i % 2 ? 4 : 2);
+                car->setTrunkCapacity(200.0 + i % 300 + 0.5);
+                vehicle = car;
+            }
+            vehicle->setId(id);
+            vehicle->setLicensePlate(plate);
+            vehicle->setYear(2000 + i % 25);
+            vehicle->setManufacturer(manufacturer);
+            fleet->addVehicle(vehicle);
+        } else if (mode == Move || i % 3 == 0) {
+            Vehicle* vehicle;
+            if (i % 3 == 0) {
+                vehicle = fleet->emplaceVehicle().data();
+            } else {
+                Car* car = fleet->emplaceVehicle<Car>().data();
+                car->setNumDoors(i % 2 ? 4 : 2);
+                car->setTrunkCapacity(200.0 + i % 300 + 0.5);
+                vehicle = car;
+            }
+            vehicle->setId(std::move(id));
+            vehicle->setLicensePlate(std::move(plate));
+            vehicle->setYear(2000 + i % 25);
+            vehicle->setManufacturer(std::move(manufacturer));
+        } else {
+            fleet->addVehicle(Car::Builder()
+                .setId(std::move(id))
+                .setLicensePlate(std::move(plate))
+                .setYear(2000 + i % 25)
+                .setManufacturer(std::move(manufacturer))
+                .setNumDoors(i % 2 ? 4 : 2)
+                .setTrunkCapacity(200.0 + i % 300 + 0.5)
+                .build());
+        }
+    }
+    return fleet;
+}
+
+QByteArray save(const QSharedPointer<Fleet>& fleet, SaveMode mode) {
+    XsdQt::XmlDocument<Fleet> doc(fleet);
+    if (mode != Pretty) {
+        XsdQt::XmlWriterOptions options = XsdQt::XmlWriterOptions::compact();
+        options.directUtf8 = mode == DirectUtf8;
+        doc.setWriterOptions(options);
+    }
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    doc.saveToDevice(&buffer);
+    return data;
+}
+
+/**
+ * 1M vehicles needs several GB; opt in with XSDQT_BENCH_LARGE=1
+ */
+bool largeEnabled() {
+    return qEnvironmentVariableIntValue("XSDQT_BENCH_LARGE") != 0;
+}
+
+template<typename Reader>
+int readScalarValues(Reader& reader) {
+    int sum = 0;
+    while (!reader.atEnd()) {
+        reader.readNext();
+        if (!reader.isStartElement()) {
+            continue;
+        }
+        const auto name = reader.name();
+        if (name == QLatin1String("i")) {
+            sum += XsdQt::XmlHelpers::readInt(reader);
+        } else if (name == QLatin1String("d")) {
+            sum += int(XsdQt::XmlHelpers::readDouble(reader));
+        } else if (name == QLatin1String("b")) {
+            sum += XsdQt::XmlHelpers::readBool(reader) ? 1 : 0;
+        } else if (name == QLatin1String("s")) {
+            sum += XsdQt::XmlHelpers::readElementText(reader).size();
+        }
+    }
+    return sum;
+}
+
+template<typename Reader>
+int readPolymorphicChildren(Reader& reader) {
+    int count = 0;
+    // Root element first, then every vehicle below it
+    while (!reader.atEnd() && !reader.isStartElement()) {
+        reader.readNext();
+    }
+    while (!reader.atEnd()) {
+        reader.readNext();
+        if (reader.isStartElement() && XsdQt::XmlHelpers::readPolymorphicElement(reader)) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+/**
+ * Width of the records in wideSequence, in int children f0..f31
+ */
+const int WIDE_FIELDS = 32;
+const int WIDE_RECORDS = 2000;
+
+QByteArray wideXml() {
+    QByteArray xml = "<records>";
+    for (int record = 0; record < WIDE_RECORDS; ++record) {
+        xml += "<record>";
+        for (int field = 0; field < WIDE_FIELDS; ++field) {
+            const QByteArray name = "f" + QByteArray::number(field);
+            xml += "<" + name + ">" + QByteArray::number(record + field) + "</" + name + ">";
+        }
+        xml += "</record>";
+    }
+    xml += "</records>";
+    return xml;
+}
+
+/**
+ * Reads the records with the child dispatch of generated fromXml: the
+ * if-else chain over every name, or for an xs:sequence the expected
+ * next child first
+ */
+template<typename Reader>
+qint64 readWideRecords(Reader& reader, bool predicted) {
+    QVector<QByteArray> names;
+    for (int field = 0; field < WIDE_FIELDS; ++field) {
+        names.append("f" + QByteArray::number(field));
+    }
+
+    qint64 sum = 0;
+    int next = 0;
+    while (!reader.atEnd()) {
+        reader.readNext();
+        if (!reader.isStartElement()) {
+            continue;
+        }
+        const auto name = reader.name();
+        if (name == QLatin1String("record")) {
+            next = 0;
+            continue;
+        }
+
+        int field = -1;
+        if (predicted && next < WIDE_FIELDS && name == QLatin1String(names.at(next))) {
+            field = next;
+        }
+        for (int i = 0; field < 0 && i < WIDE_FIELDS; ++i) {
+            if (name == QLatin1String(names.at(i))) {
+                field = i;
+            }
+        }
+        if (field < 0) {
+            continue;
+        }
+        sum += qint64(XsdQt::XmlHelpers::readInt(reader)) * (field + 1);
+        next = field + 1;
+    }
+    return sum;
+}
+
+} // namespace
+
+class BenchXmlSerialization : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void readScalars_data();
+    void readScalars();
+    void writeScalars_data();
+    void writeScalars();
+    void readPolymorphicElement_data();
+    void readPolymorphicElement();
+    void wideSequence_data();
+    void wideSequence();
+    void factoryLookup_data();
+    void factoryLookup();
+
+    void documentLoad_data();
+    void documentLoad();
+    void documentSave_data();
+    void documentSave();
+    void columnScan_data();
+    void columnScan();
+    void fleetConstruction_data();
+    void fleetConstruction();
+
+    void batchLoader_data();
+    void batchLoader();
+    void codecContext_data();
+    void codecContext();
+
+private:
+    const QByteArray& fleetXml(int vehicles);
+
+    QHash<int, QByteArray> m_fleetXml;
+    QByteArray m_scalarXml;
+    QByteArray m_wideXml;
+};
+
+void BenchXmlSerialization::initTestCase() {
+    m_scalarXml = "<values>";
+    for (int i = 0; i < 10000; ++i) {
+        m_scalarXml += "<i>" + QByteArray::number(100000 + i) + "</i>"
+                       "<d>3.14159</d><b>true</b><s>plain text value</s>";
+    }
+    m_scalarXml += "</values>";
+    m_wideXml = wideXml();
+}
+
+const QByteArray& BenchXmlSerialization::fleetXml(int vehicles) {
+    auto it = m_fleetXml.find(vehicles);
+    if (it == m_fleetXml.end()) {
+        it = m_fleetXml.insert(vehicles, save(makeFleet(vehicles), Pretty));
+    }
+    return it.value();
+}
+
+void BenchXmlSerialization::readScalars_data() {
+    QTest::addColumn<bool>("fast");
+    QTest::newRow("QXmlStreamReader") << false;
+    QTest::newRow("XmlFastReader") << true;
+}
+
+void BenchXmlSerialization::readScalars() {
+    QFETCH(bool, fast);
+
+    int sum = 0;
+    Throughput throughput;
+    QBENCHMARK {
+        if (fast) {
+            XsdQt::XmlFastReader reader(m_scalarXml);
+            sum += readScalarValues(reader);
+        } else {
+            QXmlStreamReader reader(m_scalarXml);
+            sum += readScalarValues(reader);
+        }
+        throughput.tick();
+    }
+    throughput.report(m_scalarXml.size(), 4 * 10000);
+    QVERIFY(sum != 0);
+}
+
+void BenchXmlSerialization::writeScalars_data() {
+    QTest::addColumn<bool>("utf8Writer");
+    QTest::newRow("QXmlStreamWriter") << false;
+    QTest::newRow("XmlUtf8Writer") << true;
+}
+
+void BenchXmlSerialization::writeScalars() {
+    QFETCH(bool, utf8Writer);
+
+    const QString text = QStringLiteral("plain text value");
+    QByteArray output;
+    output.reserve(m_scalarXml.size() * 2);
+
+    Throughput throughput;
+    QBENCHMARK {
+        output.resize(0);
+        if (utf8Writer) {
+            XsdQt::XmlUtf8Writer writer(&output);
+            writer.writeStartElement("values");
+            for (int i = 0; i < 10000; ++i) {
+                writer.writeTextElement("i", 100000 + i);
+                writer.writeTextElement("d", 3.14159);
+                writer.writeTextElement("b", true);
+                writer.writeTextElement("s", text);
+            }
+            writer.writeEndElement();
+        } else {
+            QBuffer buffer(&output);
+            buffer.open(QIODevice::WriteOnly);
+            QXmlStreamWriter writer(&buffer);
+            writer.writeStartElement("values");
+            for (int i = 0; i < 10000; ++i) {
+                XsdQt::XmlHelpers::writeElement(writer, "i", 100000 + i);
+                XsdQt::XmlHelpers::writeElement(writer, "d", 3.14159);
+                XsdQt::XmlHelpers::writeElement(writer, "b", true);
+                XsdQt::XmlHelpers::writeElement(writer, "s", text);
+            }
+            writer.writeEndElement();
+        }
+        throughput.tick();
+    }
+    throughput.report(output.size(), 4 * 10000);
+    QCOMPARE(output, m_scalarXml);
+}
+
+void BenchXmlSerialization::readPolymorphicElement_data() {
+    readScalars_data();
+}
+
+void BenchXmlSerialization::readPolymorphicElement() {
+    QFETCH(bool, fast);
+
+    const QByteArray& xml = fleetXml(10000);
+    int count = 0;
+    Throughput throughput;
+    QBENCHMARK {
+        if (fast) {
+            XsdQt::XmlFastReader reader(xml);
+            count = readPolymorphicChildren(reader);
+        } else {
+            QXmlStreamReader reader(xml);
+            count = readPolymorphicChildren(reader);
+        }
+        throughput.tick();
+    }
+    throughput.report(xml.size(), count);
+    QCOMPARE(count, 10000);
+}
+
+void BenchXmlSerialization::wideSequence_data() {
+    QTest::addColumn<bool>("predicted");
+    QTest::addColumn<bool>("fast");
+    QTest::newRow("chain/QXmlStreamReader") << false << false;
+    QTest::newRow("predicted/QXmlStreamReader") << true << false;
+    QTest::newRow("chain/XmlFastReader") << false << true;
+    QTest::newRow("predicted/XmlFastReader") << true << true;
+}
+
+void BenchXmlSerialization::wideSequence() {
+    QFETCH(bool, predicted);
+    QFETCH(bool, fast);
+
+    qint64 expected = 0;
+    for (int record = 0; record < WIDE_RECORDS; ++record) {
+        for (int field = 0; field < WIDE_FIELDS; ++field) {
+            expected += qint64(record + field) * (field + 1);
+        }
+    }
+
+    qint64 sum = 0;
+    Throughput throughput;
+    QBENCHMARK {
+        if (fast) {
+            XsdQt::XmlFastReader reader(m_wideXml);
+            sum = readWideRecords(reader, predicted);
+        } else {
+            QXmlStreamReader reader(m_wideXml);
+            sum = readWideRecords(reader, predicted);
+        }
+        throughput.tick();
+    }
+    throughput.report(m_wideXml.size(), WIDE_RECORDS * WIDE_FIELDS);
+    QCOMPARE(sum, expected);
+}
+
+void BenchXmlSerialization::factoryLookup_data() {
+    QTest::addColumn<int>("lookup");
+    QTest::newRow("createByElement") << 0;
+    QTest::newRow("createByType") << 1;
+    QTest::newRow("getTypeForElement") << 2;
+}
+
+void BenchXmlSerialization::factoryLookup() {
+    QFETCH(int, lookup);
+
+    const XsdQt::XmlTypeFactory& factory = XsdQt::XmlTypeFactory::instance();
+    const QString names[] = { "vehicle", "car", "fleet" };
+    const QString types[] = { "VehicleType", "CarType", "FleetType" };
+    int found = 0;
+
+    Throughput throughput;
+    QBENCHMARK {
+        for (int i = 0; i < 10000; ++i) {
+            switch (lookup) {
+            case 0: found += factory.createByElement(names[i % 3]) ? 1 : 0; break;
+            case 1: found += factory.createByType(types[i % 3]) ? 1 : 0; break;
+            default: found += factory.getTypeForElement(names[i % 3]).isEmpty() ? 0 : 1; break;
+            }
+        }
+        throughput.tick();
+    }
+    throughput.report(0, 10000);
+    QVERIFY(found > 0);
+}
+
+void BenchXmlSerialization::documentLoad_data() {
+    QTest::addColumn<int>("vehicles");
+    QTest::addColumn<bool>("fast");
+    QTest::newRow("1k/QXmlStreamReader") << 1000 << false;
+    QTest::newRow("1k/XmlFastReader") << 1000 << true;
+    QTest::newRow("100k/QXmlStreamReader") << 100000 << false;
+    QTest::newRow("100k/XmlFastReader") << 100000 << true;
+    QTest::newRow("1M/QXmlStreamReader") << 1000000 << false;
+    QTest::newRow("1M/XmlFastReader") << 1000000 << true;
+}
+
+void BenchXmlSerialization::documentLoad() {
+    QFETCH(int, vehicles);
+    QFETCH(bool, fast);
+    if (vehicles >= 1000000 && !largeEnabled()) {
+        QSKIP("Set XSDQT_BENCH_LARGE=1 to run the 1M vehicle cases");
+    }
+
+    const QByteArray& xml = fleetXml(vehicles);
+    int loaded = 0;
+
+    Throughput throughput;
+    QBENCHMARK {
+        XsdQt::XmlDocument<Fleet> doc;
+        doc.setFastReader(fast);
+        QString errorMsg;
+        QVERIFY2(doc.loadFromData(xml, &errorMsg), qPrintable(errorMsg));
+        loaded = doc.root()->getVehicles().size();
+        throughput.tick();
+    }
+    throughput.report(xml.size(), vehicles + 1);
+    QCOMPARE(loaded, vehicles);
+}
+
+void BenchXmlSerialization::documentSave_data() {
+    QTest::addColumn<int>("vehicles");
+    QTest::addColumn<int>("mode");
+    const int sizes[] = { 1000, 100000, 1000000 };
+    const char* sizeNames[] = { "1k", "100k", "1M" };
+    for (int i = 0; i < 3; ++i) {
+        QTest::newRow(qPrintable(QString("%1/pretty").arg(sizeNames[i]))) << sizes[i] << int(Pretty);
+        QTest::newRow(qPrintable(QString("%1/compact").arg(sizeNames[i]))) << sizes[i] << int(Compact);
+        QTest::newRow(qPrintable(QString("%1/directUtf8").arg(sizeNames[i]))) << sizes[i] << int(DirectUtf8);
+    }
+}
+
+void BenchXmlSerialization::documentSave() {
+    QFETCH(int, vehicles);
+    QFETCH(int, mode);
+    if (vehicles >= 1000000 && !largeEnabled()) {
+        QSKIP("Set XSDQT_BENCH_LARGE=1 to run the 1M vehicle cases");
+    }
+
+    const QSharedPointer<Fleet> fleet = makeFleet(vehicles);
+    QByteArray xml;
+
+    Throughput throughput;
+    QBENCHMARK {
+        xml = save(fleet, SaveMode(mode));
+        throughput.tick();
+    }
+    throughput.report(xml.size(), vehicles + 1);
+    QVERIFY(!xml.isEmpty());
+}
+
+void BenchXmlSerialization::columnScan_data() {
+    QTest::addColumn<int>("vehicles");
+    QTest::addColumn<bool>("columns");
+    QTest::newRow("100k/objects") << 100000 << false;
+    QTest::newRow("100k/columns") << 100000 << true;
+    QTest::newRow("1M/objects") << 1000000 << false;
+    QTest::newRow("1M/columns") << 1000000 << true;
+}
+
+void BenchXmlSerialization::columnScan() {
+    QFETCH(int, vehicles);
+    QFETCH(bool, columns);
+    if (vehicles >= 1000000 && !largeEnabled()) {
+        QSKIP("Set XSDQT_BENCH_LARGE=1 to run the 1M vehicle cases");
+    }
+
+    // Year and door count summed over the cars: a pointer chase and a type
+    // check per item, against two contiguous arrays of one group
+    const QSharedPointer<Fleet> fleet = makeFleet(vehicles);
+    const FleetVehicleColumns view = FleetVehicleColumns::fromObjects(*fleet);
+    qint64 sum = 0;
+
+    Throughput throughput;
+    QBENCHMARK {
+        sum = 0;
+        if (columns) {
+            const int* years = view.car.year.constData();
+            const int* doors = view.car.numDoors.constData();
+            const int count = view.car.year.size();
+            for (int i = 0; i < count; ++i) {
+                sum += years[i] + doors[i];
+            }
+        } else {
+            for (const auto& vehicle : fleet->getVehicles()) {
+                if (typeid(*vehicle) == typeid(Car)) {
+                    const Car& car = static_cast<const Car&>(*vehicle);
+                    sum += car.getYear() + car.getNumDoors();
+                }
+            }
+        }
+        throughput.tick();
+    }
+    throughput.report(0, vehicles);
+    QVERIFY(sum > 0);
+}
+
+void BenchXmlSerialization::fleetConstruction_data() {
+    QTest::addColumn<int>("vehicles");
+    QTest::addColumn<int>("mode");
+    const int sizes[] = { 100000, 1000000 };
+    const char* sizeNames[] = { "100k", "1M" };
+    for (int i = 0; i < 2; ++i) {
+        QTest::newRow(qPrintable(QString("%1/copy").arg(sizeNames[i]))) << sizes[i] << int(Copy);
+        QTest::newRow(qPrintable(QString("%1/move").arg(sizeNames[i]))) << sizes[i] << int(Move);
+        QTest::newRow(qPrintable(QString("%1/builder").arg(sizeNames[i]))) << sizes[i] << int(Build);
+    }
+}
+
+void BenchXmlSerialization::fleetConstruction() {
+    QFETCH(int, vehicles);
+    QFETCH(int, mode);
+    if (vehicles >= 1000000 && !largeEnabled()) {
+        QSKIP("Set XSDQT_BENCH_LARGE=1 to run the 1M vehicle cases");
+    }
+
+    int built = 0;
+
+    Throughput throughput;
+    QBENCHMARK {
+        built = buildFleet(vehicles, BuildMode(mode))->getVehicles().size();
+        throughput.tick();
+    }
+    throughput.report(0, vehicles + 1);
+    QCOMPARE(built, vehicles);
+}
+
+void BenchXmlSerialization::batchLoader_data() {
+    // 0 is one thread per core; -1 is the plain loop over XmlDocument::loadFromFile()
+    QTest::addColumn<int>("threads");
+    QTest::newRow("loadFromFile") << -1;
+    QTest::newRow("sequential") << 1;
+    QTest::newRow("parallel") << 0;
+}
+
+void BenchXmlSerialization::batchLoader() {
+    QFETCH(int, threads);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    // Many small documents, the case the batch loader is meant for
+    const QByteArray xml = fleetXml(10);
+    QStringList files;
+    for (int i = 0; i < 1000; ++i) {
+        const QString fileName = dir.filePath(QString("fleet%1.xml").arg(i));
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(xml);
+        files << fileName;
+    }
+
+    XsdQt::XmlBatchLoader<Fleet> loader;
+    loader.setMaxThreads(qMax(0, threads));
+    int loaded = 0;
+
+    Throughput throughput;
+    QBENCHMARK {
+        loaded = 0;
+        if (threads < 0) {
+            for (const QString& fileName : files) {
+                XsdQt::XmlDocument<Fleet> doc;
+                loaded += doc.loadFromFile(fileName) ? 1 : 0;
+            }
+        } else {
+            for (const auto& result : loader.load(files)) {
+                loaded += result.isOk() ? 1 : 0;
+            }
+        }
+        throughput.tick();
+    }
+    throughput.report(qint64(xml.size()) * files.size(), files.size());
+    QCOMPARE(loaded, files.size());
+}
+
+void BenchXmlSerialization::codecContext_data() {
+    QTest::addColumn<bool>("reuse");
+    QTest::newRow("fresh") << false;
+    QTest::newRow("context") << true;
+}
+
+void BenchXmlSerialization::codecContext() {
+    QFETCH(bool, reuse);
+
+    QSharedPointer<Car> car = QSharedPointer<Car>::create();
+    car->setId("C001");
+    car->setLicensePlate("XYZ-5678");
+    car->setYear(2022);
+    car->setManufacturer("Luxury Cars Inc");
+    car->setNumDoors(4);
+    car->setTrunkCapacity(450.5);
+    const XsdQt::XmlDocument<Car> request(car);
+    const QString requestXml = request.saveToString();
+    const QByteArray requestData = requestXml.toUtf8();
+
+    XsdQt::XmlCodecContext context;
+    int bytes = 0;
+
+    // One message: parse a request, serialize a reply
+    Throughput throughput;
+    QBENCHMARK {
+        for (int i = 0; i < 1000; ++i) {
+            XsdQt::XmlDocument<Car> doc;
+            if (reuse) {
+                doc.loadFromData(requestData, context);
+                doc.saveToData(context);
+                bytes = context.output().size();
+            } else {
+                doc.loadFromString(requestXml);
+                bytes = doc.saveToString().toUtf8().size();
+            }
+        }
+        throughput.tick();
+    }
+    throughput.report(qint64(requestData.size() + bytes) * 1000, 1000);
+    QCOMPARE(bytes, requestData.size());
+}
+
+QTEST_MAIN(BenchXmlSerialization)
+#include "BenchXmlSerialization.moc"
@@ -0,0 +1,23 @@
+QT += testlib xml
+QT -= gui
+
+TARGET = bench_xsdqt
+CONFIG += qt console warn_on depend_includepath c++14 release
+CONFIG -= app_bundle debug
+
+TEMPLATE = app
+
+# Include runtime library headers and the mock types shared with the tests
+INCLUDEPATH += ../runtime ../tests
+
+# Link against runtime library
+LIBS += -L.. -lxsdqt-runtime
+
+# Peak working set on Windows
+win32: LIBS += -lpsapi
+
+SOURCES += \
+    BenchXmlSerialization.cpp
+
+HEADERS += \
+    ../tests/VehicleTypes.h
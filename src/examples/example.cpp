@@ -169,7 +169,7 @@ void demonstrateTypeConversions() {
     qInfo() << "  xs:dateTime    -> QDateTime";
     qInfo() << "  xs:date        -> QDate";
     qInfo() << "  xs:time        -> QTime";
-    qInfo() << "  maxOccurs > 1  -> QList<T>";
+    qInfo() << "  maxOccurs > 1  -> QVector<T>";
     qInfo() << "  Complex types  -> QSharedPointer<T>";
 }
 
@@ -183,7 +183,7 @@ void demonstrateInheritance() {
     qInfo() << "    └─ MotorcycleType (extends VehicleType)";
     qInfo() << "";
     qInfo() << "Substitution groups allow polymorphic collections:";
-    qInfo() << "  QList<QSharedPointer<Vehicle>> can contain Car, Truck, or Motorcycle objects";
+    qInfo() << "  QVector<QSharedPointer<Vehicle>> can contain Car, Truck, or Motorcycle objects";
     qInfo() << "";
     qInfo() << "The factory pattern automatically creates the correct derived type";
     qInfo() << "based on the XML element name or xsi:type attribute.";
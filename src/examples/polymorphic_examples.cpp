@@ -179,7 +179,7 @@ public:
     QString getName() const { return m_name; }
     void setName(const QString& v) { m_name = v; }
     
-    const QList<QSharedPointer<Vehicle>>& getVehicles() const { return m_vehicles; }
+    const QVector<QSharedPointer<Vehicle>>& getVehicles() const { return m_vehicles; }
     void addVehicle(const QSharedPointer<Vehicle>& v) { m_vehicles.append(v); }
     
     void toXml(QXmlStreamWriter& writer) const override {
@@ -227,7 +227,7 @@ public:
     
 private:
     QString m_name;
-    QList<QSharedPointer<Vehicle>> m_vehicles;
+    QVector<QSharedPointer<Vehicle>> m_vehicles;
 };
 
 // Register all types with factory
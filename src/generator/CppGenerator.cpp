@@ -1,12 +1,24 @@
 #include "CodeGenerator.h"
+#include <QAtomicInt>
+#include <QCryptographicHash>
 #include <QFile>
+#include <QHash>
 #include <QDir>
+#include <QMap>
+#include <QPair>
+#include <QRunnable>
+#include <QSet>
 #include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QtNumeric>
+#include <algorithm>
 
 namespace XsdGen {
 
 CodeGenerator::CodeGenerator(const QSharedPointer<XsdSchema>& schema)
-    : m_schema(schema), m_namespace("Generated")
+    : m_schema(schema), m_namespace("Generated"), m_utf8Writer(false), m_fastReader(false),
+      m_threadCount(0), m_manifest(false), m_validation(false), m_columns(false), m_unityUnits(0), m_filesWritten(0), m_filesUnchanged(0), m_filesRemoved(0)
 {
     // Initialize XSD to C++ type mapping
     m_typeMapping["xs:string"] = "QString";
@@ -40,419 +52,1639 @@ CodeGenerator::CodeGenerator(const QSharedPointer<XsdSchema>& schema)
     m_typeMapping["float"] = "float";
 }
 
+const char* const CodeGenerator::MANIFEST_FILE = "xsd2cpp.manifest";
+
+/**
+ * Emits jobs claimed from a shared counter, like XmlBatchLoader's workers
+ */
+class CodeGenerator::Worker : public QRunnable {
+public:
+    Worker(const CodeGenerator& generator, const QVector<Job>& jobs, const QString& outputDir,
+           JobResult* results, QAtomicInt& next)
+        : m_generator(generator), m_jobs(jobs), m_outputDir(outputDir),
+          m_results(results), m_next(next) {}
+    
+    void run() override {
+        int index;
+        while ((index = m_next.fetchAndAddRelaxed(1)) < m_jobs.size()) {
+            m_generator.generateJob(m_jobs.at(index), m_outputDir, &m_results[index]);
+        }
+    }
+    
+private:
+    const CodeGenerator& m_generator;
+    const QVector<Job>& m_jobs;
+    const QString& m_outputDir;
+    JobResult* m_results;
+    QAtomicInt& m_next;
+};
+
 bool CodeGenerator::generate(const QString& outputDir, QString* errorMsg) {
     QDir dir;
     if (!dir.exists(outputDir)) {
         dir.mkpath(outputDir);
     }
     
-    // Generate code for each complex type
-    for (auto it = m_schema->types.begin(); it != m_schema->types.end(); ++it) {
+    // Element lookup for xmlElementName(), first match in schema order
+    m_elementNames.clear();
+    for (auto it = m_schema->elements.constBegin(); it != m_schema->elements.constEnd(); ++it) {
+        QString className = toCppClassName(it.key());
+        if (!m_elementNames.contains(className)) {
+            m_elementNames.insert(className, it.key());
+        }
+    }
+    
+    registerSimpleTypes();
+    
+    // Complex types, then global elements with inline types
+    QVector<Job> jobs;
+    for (auto it = m_schema->types.constBegin(); it != m_schema->types.constEnd(); ++it) {
         if (it.value()->kind == XsdTypeKind::ComplexType) {
-            QString className = toCppClassName(it.key());
-            
-            if (!generateHeader(className, it.value(), outputDir)) {
-                if (errorMsg) *errorMsg = QString("Failed to generate header for %1").arg(className);
-                return false;
-            }
-            
-            if (!generateImplementation(className, it.value(), outputDir)) {
-                if (errorMsg) *errorMsg = QString("Failed to generate implementation for %1").arg(className);
-                return false;
+            jobs.append({toCppClassName(it.key()), it.value(), false});
+        }
+    }
+    for (auto it = m_schema->elements.constBegin(); it != m_schema->elements.constEnd(); ++it) {
+        if (it.value()->inlineType && it.value()->inlineType->kind == XsdTypeKind::ComplexType) {
+            jobs.append({toCppClassName(it.key()), it.value()->inlineType, true});
+        }
+    }
+    
+    // XmlTypeFactory keys the registry by element name, so a second type
+    // with the same one would silently replace the first
+    QHash<QString, QString> classForElement;
+    for (const Job& job : jobs) {
+        const QString elementName = elementNameFor(job.className);
+        const QString other = classForElement.value(elementName);
+        if (!other.isEmpty() && other != job.className) {
+            if (errorMsg) {
+                *errorMsg = QString("Types %1 and %2 both map to element name \"%3\"").arg(other, job.className, elementName);
             }
+            return false;
         }
+        classForElement.insert(elementName, job.className);
     }
     
-    // Generate code for global elements with inline types
-    for (auto it = m_schema->elements.begin(); it != m_schema->elements.end(); ++it) {
-        if (it.value()->inlineType) {
-            QString className = toCppClassName(it.key());
-            
-            if (!generateHeader(className, it.value()->inlineType, outputDir)) {
-                if (errorMsg) *errorMsg = QString("Failed to generate header for element %1").arg(className);
-                return false;
+    m_filesWritten = m_filesUnchanged = m_filesRemoved = 0;
+    const QStringList previous = m_manifest ? readManifest(outputDir) : QStringList();
+    
+    // From here on the schema and generator state are only read, so
+    // every job can be emitted independently
+    int workers = m_threadCount > 0 ? m_threadCount : QThread::idealThreadCount();
+    workers = qBound(1, workers, jobs.size());
+    
+    QVector<JobResult> results(jobs.size());
+    QAtomicInt next(0);
+    
+    // Detach once up front; workers then write disjoint slots
+    JobResult* out = results.data();
+    
+    // A pool of our own, sized for -j and shared with no one; the
+    // calling thread is the last worker
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(1, workers - 1));
+    for (int i = 1; i < workers; ++i) {
+        pool.start(new Worker(*this, jobs, outputDir, out, next));
+    }
+    Worker(*this, jobs, outputDir, out, next).run();
+    pool.waitForDone();
+    
+    // Report the first failure in job order, independent of scheduling
+    for (const JobResult& result : results) {
+        if (!result.errorMsg.isEmpty()) {
+            if (errorMsg) *errorMsg = result.errorMsg;
+            return false;
+        }
+    }
+    
+    if (m_unityUnits > 0) {
+        results.append(JobResult());
+        if (!generateUnity(jobs, results, outputDir, &results.last())) {
+            if (errorMsg) *errorMsg = results.last().errorMsg;
+            return false;
+        }
+    }
+    
+    // Enum headers are small; emitted here after the class jobs
+    for (auto it = m_enumClasses.constBegin(); it != m_enumClasses.constEnd(); ++it) {
+        results.append(JobResult());
+        if (!generateEnum(it.value(), outputDir, &results.last())) {
+            if (errorMsg) *errorMsg = results.last().errorMsg;
+            return false;
+        }
+    }
+    
+    if (!m_facetTypes.isEmpty()) {
+        results.append(JobResult());
+        if (!generateFacets(outputDir, &results.last())) {
+            if (errorMsg) *errorMsg = results.last().errorMsg;
+            return false;
+        }
+    }
+    
+    if (m_columns) {
+        results.append(JobResult());
+        if (!generateColumns(jobs, outputDir, &results.last())) {
+            if (errorMsg) *errorMsg = results.last().errorMsg;
+            return false;
+        }
+    }
+    
+    results.append(JobResult());
+    if (!generateRegistry(jobs, outputDir, &results.last())) {
+        if (errorMsg) *errorMsg = results.last().errorMsg;
+        return false;
+    }
+    
+    QSet<QString> generated;
+    for (const JobResult& result : results) {
+        for (const OutputFile& file : result.files) {
+            generated.insert(file.fileName);
+            if (file.written) {
+                ++m_filesWritten;
+            } else {
+                ++m_filesUnchanged;
             }
-            
-            if (!generateImplementation(className, it.value()->inlineType, outputDir)) {
-                if (errorMsg) *errorMsg = QString("Failed to generate implementation for element %1").arg(className);
-                return false;
+        }
+    }
+    
+    if (m_manifest) {
+        // Only files this generator wrote before are ever deleted
+        for (const QString& fileName : previous) {
+            if (!generated.contains(fileName) && QFile::remove(outputDir + "/" + fileName)) {
+                ++m_filesRemoved;
             }
         }
+        return writeManifest(outputDir, results, errorMsg);
     }
     
     return true;
 }
 
-QString CodeGenerator::toCppTypeName(const QString& xsdType) {
-    // Remove namespace prefix if present
-    QString cleanType = xsdType;
-    int colonPos = xsdType.indexOf(':');
-    if (colonPos >= 0) {
-        cleanType = xsdType.mid(colonPos + 1);
-    }
+bool CodeGenerator::generateJob(const Job& job, const QString& outputDir, JobResult* result) const {
+    const QString what = job.fromElement ? QString("element %1").arg(job.className) : job.className;
     
-    // Check if it's a built-in type
-    if (m_typeMapping.contains(xsdType)) {
-        return m_typeMapping[xsdType];
+    if (!generateHeader(job.className, job.type, outputDir, result)) {
+        result->errorMsg = QString("Failed to generate header for %1").arg(what);
+        return false;
     }
-    if (m_typeMapping.contains(cleanType)) {
-        return m_typeMapping[cleanType];
+    
+    if (!generateImplementation(job.className, job.type, outputDir, result)) {
+        result->errorMsg = QString("Failed to generate implementation for %1").arg(what);
+        return false;
     }
     
-    // Otherwise it's a user-defined type
-    return toCppClassName(cleanType);
+    return true;
 }
 
-QString CodeGenerator::toCppClassName(const QString& name) {
-    QString result = name;
+bool CodeGenerator::writeFile(const QString& outputDir, const QString& fileName, const QString& content,
+                              JobResult* result) const {
+    const QByteArray data = content.toUtf8();
+    OutputFile output;
+    output.fileName = fileName;
+    output.hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+    output.written = true;
     
-    // Capitalize first letter
-    if (!result.isEmpty()) {
-        result[0] = result[0].toUpper();
+    // Leave identical files alone so their mtime, and the build, stay put
+    QFile file(outputDir + "/" + fileName);
+    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        const QByteArray existing = file.readAll();
+        file.close();
+        if (existing.size() == data.size()
+            && QCryptographicHash::hash(existing, QCryptographicHash::Sha1) == output.hash) {
+            output.written = false;
+        }
     }
     
-    // Remove hyphens and underscores, capitalize following letter
-    for (int i = 0; i < result.length(); ++i) {
-        if (result[i] == '-' || result[i] == '_') {
-            result.remove(i, 1);
-            if (i < result.length()) {
-                result[i] = result[i].toUpper();
-            }
+    if (output.written) {
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)
+            || file.write(data) != data.size()) {
+            return false;
         }
     }
     
-    return result;
+    result->files.append(output);
+    return true;
 }
 
-QString CodeGenerator::toCppMemberName(const QString& name) {
-    QString result = name;
-    
-    // Start with lowercase
-    if (!result.isEmpty()) {
-        result[0] = result[0].toLower();
+QStringList CodeGenerator::readManifest(const QString& outputDir) const {
+    QStringList fileNames;
+    QFile file(outputDir + "/" + MANIFEST_FILE);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return fileNames;
     }
     
-    // Remove hyphens, capitalize following letter
-    for (int i = 0; i < result.length(); ++i) {
-        if (result[i] == '-') {
-            result.remove(i, 1);
-            if (i < result.length()) {
-                result[i] = result[i].toUpper();
-            }
+    // "<sha1> <file name>" per line
+    while (!file.atEnd()) {
+        const QString line = QString::fromUtf8(file.readLine()).trimmed();
+        const int space = line.indexOf(' ');
+        if (line.startsWith('#') || space < 0) {
+            continue;
+        }
+        const QString fileName = line.mid(space + 1);
+        // Never follow entries out of the output directory
+        if (!fileName.contains('/') && !fileName.contains('\\')) {
+            fileNames.append(fileName);
         }
     }
-    
-    return "m_" + result;
+    return fileNames;
 }
 
-QString CodeGenerator::getIncludeGuard(const QString& className) {
-    return className.toUpper() + "_H";
-}
-
-bool CodeGenerator::generateHeader(const QString& className, const QSharedPointer<XsdType>& type, const QString& outputDir) {
-    QString filename = outputDir + "/" + className + ".h";
-    QFile file(filename);
+bool CodeGenerator::writeManifest(const QString& outputDir, const QVector<JobResult>& results, QString* errorMsg) const {
+    QStringList lines;
+    for (const JobResult& result : results) {
+        for (const OutputFile& output : result.files) {
+            lines.append(QString::fromLatin1(output.hash.toHex()) + " " + output.fileName);
+        }
+    }
+    lines.sort();
+    
+    QString content = "# xsd2cpp manifest\n";
+    for (const QString& line : lines) {
+        content += line + "\n";
+    }
     
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    // Goes through writeFile() too, so an unchanged manifest keeps its mtime
+    JobResult manifest;
+    if (!writeFile(outputDir, MANIFEST_FILE, content, &manifest)) {
+        if (errorMsg) *errorMsg = QString("Cannot write manifest: %1/%2").arg(outputDir).arg(MANIFEST_FILE);
         return false;
     }
+    return true;
+}
+
+bool CodeGenerator::generateUnity(const QVector<Job>& jobs, const QVector<JobResult>& results, const QString& outputDir,
+                                  JobResult* unity) const {
+    // Class headers don't include their members' headers, so the umbrella
+    // lists bases before derived classes and otherwise keeps schema order
+    QHash<QString, int> indexOfClass;
+    for (int i = 0; i < jobs.size(); ++i) {
+        indexOfClass.insert(jobs.at(i).className, i);
+    }
     
-    QTextStream out(&file);
+    QVector<int> order;
+    QVector<bool> visited(jobs.size(), false);
+    for (int i = 0; i < jobs.size(); ++i) {
+        QVector<int> chain;
+        for (int index = i; index >= 0 && !visited.at(index); ) {
+            visited[index] = true;
+            chain.prepend(index);
+            const QString& base = jobs.at(index).type->baseTypeName;
+            index = base.isEmpty() ? -1 : indexOfClass.value(getBaseClassName(base), -1);
+        }
+        order += chain;
+    }
     
-    QString guard = getIncludeGuard(className);
+    QString header;
+    QTextStream out(&header);
+    const QString guard = getIncludeGuard(m_namespace + "All");
     out << "#ifndef " << guard << "\n";
     out << "#define " << guard << "\n\n";
-    
+    out << "// Umbrella header for the unity build; suitable as precompiled header\n\n";
     writeHeaderIncludes(out);
+    out << "#include \"XmlAttributeBinder.h\"\n";
+    for (int index : order) {
+        out << "#include \"" << jobs.at(index).className << ".h\"\n";
+    }
+    out << "#include \"" << registryHeaderName() << "\"\n";
+    if (!m_facetTypes.isEmpty()) {
+        out << "#include \"" << facetsHeaderName() << "\"\n";
+    }
+    out << "\n#endif // " << guard << "\n";
+    out.flush();
     
-    out << "namespace " << m_namespace << " {\n\n";
-    
-    writeClassDeclaration(out, className, type);
+    if (!writeFile(outputDir, unityHeaderName(), header, unity)) {
+        unity->errorMsg = QString("Failed to generate %1").arg(unityHeaderName());
+        return false;
+    }
     
-    out << "} // namespace " << m_namespace << "\n\n";
-    out << "#endif // " << guard << "\n";
+    // Contiguous slices in schema order, so a type keeps its unit
+    // unless types are added or removed before it
+    const int units = qMax(1, qMin(m_unityUnits, jobs.size()));
+    const int perUnit = (jobs.size() + units - 1) / units;
+    for (int unit = 0; unit < units; ++unit) {
+        QString content;
+        QTextStream unitOut(&content);
+        unitOut << "#include \"" << unityHeaderName() << "\"\n\n";
+        
+        const int end = qMin(jobs.size(), (unit + 1) * perUnit);
+        for (int i = unit * perUnit; i < end; ++i) {
+            unitOut << "// " << jobs.at(i).className << "\n\n";
+            unitOut << results.at(i).implementation << "\n";
+        }
+        unitOut.flush();
+        
+        if (!writeFile(outputDir, unityUnitName(unit), content, unity)) {
+            unity->errorMsg = QString("Failed to generate %1").arg(unityUnitName(unit));
+            return false;
+        }
+    }
     
     return true;
 }
 
-void CodeGenerator::writeHeaderIncludes(QTextStream& out) {
-    out << "#include \"XmlSerializable.h\"\n";
-    out << "#include \"XmlHelpers.h\"\n";
-    out << "#include <QString>\n";
-    out << "#include <QDateTime>\n";
-    out << "#include <QList>\n";
-    out << "#include <QSharedPointer>\n\n";
-}
-
-void CodeGenerator::writeClassDeclaration(QTextStream& out, const QString& className, const QSharedPointer<XsdType>& type) {
-    // Forward declarations for cyclic dependencies
-    out << "// Forward declarations\n";
-    for (const auto& elem : type->elements) {
-        QString elemType = toCppTypeName(elem->typeName);
-        if (!m_typeMapping.contains(elem->typeName) && !elem->typeName.isEmpty()) {
-            out << "class " << elemType << ";\n";
-        }
-    }
-    out << "\n";
+bool CodeGenerator::generateRegistry(const QVector<Job>& jobs, const QString& outputDir, JobResult* registry) const {
+    QString header;
+    QTextStream out(&header);
+    const QString guard = getIncludeGuard(m_namespace + "Registry");
+    out << "#ifndef " << guard << "\n";
+    out << "#define " << guard << "\n\n";
+    out << "namespace " << m_namespace << " {\n\n";
+    out << "/**\n";
+    out << " * Register every generated type with XsdQt::XmlTypeFactory\n";
+    out << " * Call once before loading documents; later calls do nothing\n";
+    out << " */\n";
+    out << "void registerAllTypes();\n\n";
+    out << "} // namespace " << m_namespace << "\n\n";
+    out << "#endif // " << guard << "\n";
+    out.flush();
     
-    // Class declaration
-    QString baseClass = "XsdQt::XmlSerializable";
-    if (!type->baseTypeName.isEmpty()) {
-        baseClass = getBaseClassName(type->baseTypeName);
+    if (!writeFile(outputDir, registryHeaderName(), header, registry)) {
+        registry->errorMsg = QString("Failed to generate %1").arg(registryHeaderName());
+        return false;
     }
     
-    out << "class " << className << " : public " << baseClass << " {\n";
-    out << "public:\n";
-    out << "    " << className << "();\n";
+    // Sorted by element name so the table is stable across runs
+    QVector<QPair<QString, int>> rows;
+    for (int i = 0; i < jobs.size(); ++i) {
+        rows.append(qMakePair(elementNameFor(jobs.at(i).className), i));
+    }
+    std::sort(rows.begin(), rows.end());
     
-    if (!type->baseTypeName.isEmpty()) {
-        out << "    virtual ~" << className << "() = default;\n\n";
+    QString source;
+    QTextStream cpp(&source);
+    cpp << "#include \"" << registryHeaderName() << "\"\n";
+    for (const auto& row : rows) {
+        cpp << "#include \"" << jobs.at(row.second).className << ".h\"\n";
     }
+    cpp << "\nnamespace " << m_namespace << " {\n\n";
     
-    writeGettersSetters(out, type);
-    writeSerializationMethods(out, className);
+    if (rows.isEmpty()) {
+        cpp << "void registerAllTypes() {\n";
+        cpp << "}\n\n";
+    } else {
+        cpp << "namespace {\n\n";
+        cpp << "constexpr XsdQt::XmlTypeEntry types[] = {\n";
+        for (const auto& row : rows) {
+            const Job& job = jobs.at(row.second);
+            cpp << "    { \"" << row.first << "\", \"" << job.type->name << "\", "
+                << "&XsdQt::createXmlType<" << job.className << "> },\n";
+        }
+        cpp << "};\n\n";
+        cpp << "} // anonymous namespace\n\n";
+        cpp << "void registerAllTypes() {\n";
+        cpp << "    // Thread-safe one-time initialization\n";
+        cpp << "    static const bool registered = (XsdQt::XmlTypeFactory::instance().registerTypes(types), true);\n";
+        cpp << "    Q_UNUSED(registered);\n";
+        cpp << "}\n\n";
+    }
+    cpp << "} // namespace " << m_namespace << "\n";
+    cpp.flush();
     
-    out << "\nprivate:\n";
-    writeMemberVariables(out, type);
+    if (!writeFile(outputDir, registrySourceName(), source, registry)) {
+        registry->errorMsg = QString("Failed to generate %1").arg(registrySourceName());
+        return false;
+    }
     
-    out << "};\n\n";
+    return true;
 }
 
-void CodeGenerator::writeMemberVariables(QTextStream& out, const QSharedPointer<XsdType>& type) {
-    // Write member variables for elements
-    for (const auto& elem : type->elements) {
-        QString cppType = toCppTypeName(elem->typeName);
-        QString memberName = toCppMemberName(elem->name);
-        
-        if (elem->maxOccurs == -1 || elem->maxOccurs > 1) {
-            // List/array type
-            if (m_typeMapping.contains(elem->typeName)) {
-                out << "    QList<" << cppType << "> " << memberName << ";\n";
-            } else {
-                out << "    QList<QSharedPointer<" << cppType << ">> " << memberName << ";\n";
-            }
-        } else {
-            // Single value
-            if (m_typeMapping.contains(elem->typeName)) {
-                out << "    " << cppType << " " << memberName << ";\n";
-            } else {
-                out << "    QSharedPointer<" << cppType << "> " << memberName << ";\n";
-            }
+void CodeGenerator::registerSimpleTypes() {
+    // Named simple types become their built-in base type, or an enum class
+    // for xs:enumeration restrictions; the rest of the generator then sees
+    // them through m_typeMapping like the built-ins
+    m_enumClasses.clear();
+    m_facetTypes.clear();
+    for (auto it = m_schema->types.constBegin(); it != m_schema->types.constEnd(); ++it) {
+        if (it.value()->kind != XsdTypeKind::SimpleType) {
+            continue;
+        }
+        const QString cppType = simpleCppType(it.value());
+        m_typeMapping[it.key()] = cppType;
+        if (!it.value()->enumValues.isEmpty()) {
+            m_enumClasses.insert(cppType, it.value());
         }
     }
     
-    // Write member variables for attributes
-    for (const auto& attr : type->attributes) {
-        QString cppType = toCppTypeName(attr->typeName);
-        QString memberName = toCppMemberName(attr->name);
-        out << "    " << cppType << " " << memberName << ";\n";
+    // With --validate, the other restrictions get a validator each; enums
+    // are checked by parsing them
+    if (!m_validation) {
+        return;
+    }
+    for (auto it = m_schema->types.constBegin(); it != m_schema->types.constEnd(); ++it) {
+        if (it.value()->kind != XsdTypeKind::SimpleType || isEnum(m_typeMapping.value(it.key()))) {
+            continue;
+        }
+        const Facets facets = facetsOf(it.value());
+        if (!facets.patterns.isEmpty() || facets.minLength >= 0 || facets.maxLength >= 0
+            || !facets.minInclusive.isEmpty() || !facets.maxInclusive.isEmpty()
+            || !facets.minExclusive.isEmpty() || !facets.maxExclusive.isEmpty()) {
+            m_facetTypes.insert(it.key(), it.value());
+        }
     }
 }
 
-void CodeGenerator::writeGettersSetters(QTextStream& out, const QSharedPointer<XsdType>& type) {
-    // Getters and setters for elements
-    for (const auto& elem : type->elements) {
-        QString cppType = toCppTypeName(elem->typeName);
-        QString memberName = toCppMemberName(elem->name);
-        QString propertyName = elem->name;
-        propertyName[0] = propertyName[0].toUpper();
-        
-        if (elem->maxOccurs == -1 || elem->maxOccurs > 1) {
-            // List type
-            if (m_typeMapping.contains(elem->typeName)) {
-                out << "    const QList<" << cppType << ">& get" << propertyName << "() const { return " << memberName << "; }\n";
-                out << "    void set" << propertyName << "(const QList<" << cppType << ">& value) { " << memberName << " = value; }\n";
-                out << "    void add" << propertyName << "(const " << cppType << "& value) { " << memberName << ".append(value); }\n";
-            } else {
-                out << "    const QList<QSharedPointer<" << cppType << ">>& get" << propertyName << "() const { return " << memberName << "; }\n";
-                out << "    void set" << propertyName << "(const QList<QSharedPointer<" << cppType << ">>& value) { " << memberName << " = value; }\n";
-                out << "    void add" << propertyName << "(const QSharedPointer<" << cppType << ">& value) { " << memberName << ".append(value); }\n";
-            }
-        } else {
-            // Single value
-            if (m_typeMapping.contains(elem->typeName)) {
-                out << "    " << cppType << " get" << propertyName << "() const { return " << memberName << "; }\n";
-                out << "    void set" << propertyName << "(const " << cppType << "& value) { " << memberName << " = value; }\n";
-            } else {
-                out << "    QSharedPointer<" << cppType << "> get" << propertyName << "() const { return " << memberName << "; }\n";
-                out << "    void set" << propertyName << "(const QSharedPointer<" << cppType << ">& value) { " << memberName << " = value; }\n";
-            }
-        }
-        out << "\n";
+QString CodeGenerator::simpleCppType(const QSharedPointer<XsdType>& type, int depth) const {
+    if (!type->enumValues.isEmpty()) {
+        return toCppClassName(type->name);
     }
     
-    // Getters and setters for attributes
-    for (const auto& attr : type->attributes) {
-        QString cppType = toCppTypeName(attr->typeName);
-        QString memberName = toCppMemberName(attr->name);
-        QString propertyName = attr->name;
-        propertyName[0] = propertyName[0].toUpper();
-        
-        out << "    " << cppType << " get" << propertyName << "() const { return " << memberName << "; }\n";
-        out << "    void set" << propertyName << "(const " << cppType << "& value) { " << memberName << " = value; }\n\n";
+    const QString base = type->baseType.mid(type->baseType.indexOf(':') + 1);
+    QSharedPointer<XsdType> baseType = findType(base);
+    if (baseType && baseType->kind == XsdTypeKind::SimpleType && depth < 32) {
+        return simpleCppType(baseType, depth + 1);
     }
+    
+    // Built-in base; lists and unions are kept as text
+    return m_typeMapping.value(type->baseType, m_typeMapping.value(base, "QString"));
 }
 
-void CodeGenerator::writeSerializationMethods(QTextStream& out, const QString& className) {
-    out << "    // Serialization\n";
-    out << "    void toXml(QXmlStreamWriter& writer) const override;\n";
-    out << "    bool fromXml(QXmlStreamReader& reader) override;\n";
-    out << "    QString xmlElementName() const override;\n";
-    out << "    QString xsdTypeName() const override;\n";
+bool CodeGenerator::isSimpleType(const QString& typeName) const {
+    return m_typeMapping.contains(typeName) || m_typeMapping.contains(typeName.mid(typeName.indexOf(':') + 1));
 }
 
-QString CodeGenerator::getBaseClassName(const QString& baseTypeName) {
-    return toCppClassName(baseTypeName);
+QStringList CodeGenerator::enumeratorNames(const QSharedPointer<XsdType>& type) const {
+    // "diesel-hybrid" -> DieselHybrid, "4wd" -> Value4wd; clashes get the index appended
+    QStringList names;
+    for (int i = 0; i < type->enumValues.size(); ++i) {
+        QString name;
+        bool upper = true;
+        for (QChar c : type->enumValues.at(i)) {
+            if (c.isLetterOrNumber() && c.unicode() < 0x80) {
+                name += upper ? c.toUpper() : c;
+                upper = false;
+            } else {
+                upper = true;
+            }
+        }
+        if (name.isEmpty() || name.at(0).isDigit()) {
+            name.prepend("Value");
+        }
+        if (names.contains(name)) {
+            name += QString::number(i);
+        }
+        names.append(name);
+    }
+    return names;
 }
 
-QSharedPointer<XsdType> CodeGenerator::findType(const QString& typeName) {
-    return m_schema->types.value(typeName);
+QString CodeGenerator::enumeratorFor(const QString& cppType, const QString& value) const {
+    const QSharedPointer<XsdType> type = m_enumClasses.value(cppType);
+    const int index = qMax(0, type->enumValues.indexOf(value));
+    return cppType + "::" + enumeratorNames(type).at(index);
 }
 
-bool CodeGenerator::generateImplementation(const QString& className, const QSharedPointer<XsdType>& type, const QString& outputDir) {
-    QString filename = outputDir + "/" + className + ".cpp";
-    QFile file(filename);
+QVector<int> CodeGenerator::buildEnumTable(const QStringList& values, quint32* seed, int* bits) {
+    // At most half the slots used, so a miss always reaches an empty slot
+    *bits = 1;
+    while ((1 << *bits) < 2 * values.size()) {
+        ++*bits;
+    }
     
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        return false;
+    // Seed with the fewest probe steps; zero is a perfect hash
+    QVector<int> best;
+    int bestSteps = -1;
+    for (quint32 candidate = 0; candidate < 4096 && bestSteps != 0; ++candidate) {
+        QVector<int> table(1 << *bits, -1);
+        int steps = 0;
+        for (int i = 0; i < values.size(); ++i) {
+            int slot = hashSlot(nameHash(values.at(i), candidate), *bits);
+            while (table.at(slot) >= 0) {
+                slot = (slot + 1) & (table.size() - 1);
+                ++steps;
+            }
+            table[slot] = i;
+        }
+        if (bestSteps < 0 || steps < bestSteps) {
+            best = table;
+            bestSteps = steps;
+            *seed = candidate;
+        }
     }
+    return best;
+}
+
+int CodeGenerator::hashSlot(quint32 hash, int bits) {
+    // Must match XsdQt::xmlHashSlot
+    return bits > 0 ? int(((hash ^ (hash >> 16)) * 0x45d9f3bu) >> (32 - bits)) : 0;
+}
+
+bool CodeGenerator::generateEnum(const QSharedPointer<XsdType>& type, const QString& outputDir, JobResult* result) const {
+    const QString className = toCppClassName(type->name);
+    const QStringList enumerators = enumeratorNames(type);
+    const QStringList& values = type->enumValues;
     
-    QTextStream out(&file);
+    // Duplicate values (legal in XSD) parse to their first enumerator
+    QStringList distinct = values;
+    distinct.removeDuplicates();
+    quint32 seed = 0;
+    int bits = 0;
+    QVector<int> slotIndex = buildEnumTable(distinct, &seed, &bits);
+    for (int& index : slotIndex) {
+        if (index >= 0) {
+            index = values.indexOf(distinct.at(index));
+        }
+    }
     
-    writeImplementationIncludes(out, className);
+    QString content;
+    QTextStream out(&content);
     
+    const QString guard = getIncludeGuard(className);
+    out << "#ifndef " << guard << "\n";
+    out << "#define " << guard << "\n\n";
+    out << "#include \"XmlEnum.h\"\n";
+    out << "#include <QString>\n\n";
     out << "namespace " << m_namespace << " {\n\n";
     
-    writeConstructor(out, className, type);
-    writeToXmlImplementation(out, className, type);
-    writeFromXmlImplementation(out, className, type);
-    
-    // Find element name for this type
-    QString elementName = className;
-    elementName[0] = elementName[0].toLower();
-    for (auto it = m_schema->elements.begin(); it != m_schema->elements.end(); ++it) {
-        if (toCppClassName(it.key()) == className) {
-            elementName = it.key();
-            break;
-        }
+    out << "/**\n";
+    out << " * xs:enumeration values of " << type->name << "\n";
+    out << " */\n";
+    out << "enum class " << className << " : " << (values.size() <= 256 ? "quint8" : "quint16") << " {\n";
+    for (int i = 0; i < values.size(); ++i) {
+        out << "    " << enumerators.at(i) << (i + 1 < values.size() ? "," : "") << "\n";
+    }
+    out << "};\n\n";
+    
+    // Found through ADL by XsdQt::parseXmlEnum
+    out << "inline const XsdQt::XmlEnumTable& xmlEnumTable(" << className << ") {\n";
+    out << "    static constexpr XsdQt::XmlUtf8View names[] = {\n";
+    for (const QString& value : values) {
+        out << "        \"" << escaped(value) << "\",\n";
     }
+    out << "    };\n";
+    out << "    static constexpr qint16 slotIndex[] = {";
+    for (int i = 0; i < slotIndex.size(); ++i) {
+        out << (i % 16 == 0 ? "\n        " : " ") << slotIndex.at(i) << ",";
+    }
+    out << "\n    };\n";
+    out << "    static constexpr XsdQt::XmlEnumTable table = { names, slotIndex, " << seed << "u, " << bits << " };\n";
+    out << "    return table;\n";
+    out << "}\n\n";
     
-    writeRegistration(out, className, elementName, type->name);
+    out << "inline QString toXmlString(" << className << " value) {\n";
+    out << "    static const QString names[] = {\n";
+    for (const QString& value : values) {
+        out << "        QStringLiteral(\"" << escaped(value) << "\"),\n";
+    }
+    out << "    };\n";
+    out << "    return names[int(value)];\n";
+    out << "}\n\n";
     
-    out << "} // namespace " << m_namespace << "\n";
+    out << "} // namespace " << m_namespace << "\n\n";
+    out << "#endif // " << guard << "\n";
+    out.flush();
     
+    if (!writeFile(outputDir, className + ".h", content, result)) {
+        result->errorMsg = QString("Failed to generate enum %1").arg(className);
+        return false;
+    }
     return true;
 }
 
-void CodeGenerator::writeImplementationIncludes(QTextStream& out, const QString& className) {
-    out << "#include \"" << className << ".h\"\n\n";
+QString CodeGenerator::escaped(QString value) {
+    // Contents of a C++ string literal
+    return value.replace('\\', "\\\\").replace('"', "\\\"");
 }
 
-void CodeGenerator::writeConstructor(QTextStream& out, const QString& className, const QSharedPointer<XsdType>& type) {
-    out << className << "::" << className << "() {\n";
-    
-    // Initialize simple type members with defaults
-    for (const auto& elem : type->elements) {
-        if (m_typeMapping.contains(elem->typeName) && !elem->defaultValue.isEmpty()) {
-            QString memberName = toCppMemberName(elem->name);
-            QString cppType = toCppTypeName(elem->typeName);
-            
-            if (cppType == "QString") {
-                out << "    " << memberName << " = \"" << elem->defaultValue << "\";\n";
-            } else if (cppType == "int" || cppType.contains("int")) {
-                out << "    " << memberName << " = " << elem->defaultValue << ";\n";
-            } else if (cppType == "bool") {
-                out << "    " << memberName << " = " << (elem->defaultValue == "true" ? "true" : "false") << ";\n";
-            }
+CodeGenerator::Facets CodeGenerator::facetsOf(const QSharedPointer<XsdType>& type) const {
+    // A restriction only narrows its base, so the first bound found
+    // walking up from the derived type is the tightest
+    Facets facets;
+    QSharedPointer<XsdType> current = type;
+    for (int depth = 0; current && current->kind == XsdTypeKind::SimpleType && depth < 32; ++depth) {
+        if (!current->pattern.isEmpty()) {
+            facets.patterns.append(current->pattern);
         }
+        if (facets.minLength < 0) facets.minLength = current->minLength;
+        if (facets.maxLength < 0) facets.maxLength = current->maxLength;
+        if (facets.minInclusive.isEmpty()) facets.minInclusive = current->minInclusive;
+        if (facets.maxInclusive.isEmpty()) facets.maxInclusive = current->maxInclusive;
+        if (facets.minExclusive.isEmpty()) facets.minExclusive = current->minExclusive;
+        if (facets.maxExclusive.isEmpty()) facets.maxExclusive = current->maxExclusive;
+        current = findType(current->baseType.mid(current->baseType.indexOf(':') + 1));
     }
-    
+    return facets;
+}
+
+QString CodeGenerator::validatorFor(const QString& typeName) const {
+    const QString name = typeName.mid(typeName.indexOf(':') + 1);
+    return m_facetTypes.contains(name) ? "validate" + toCppClassName(name) : QString();
+}
+
+bool CodeGenerator::usesValidators(const QSharedPointer<XsdType>& type) const {
+    for (const auto& elem : allElements(type)) {
+        if (!validatorFor(elem->typeName).isEmpty()) {
+            return true;
+        }
+    }
+    for (const auto& attr : allAttributes(type)) {
+        if (!validatorFor(attr->typeName).isEmpty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CodeGenerator::generateFacets(const QString& outputDir, JobResult* result) const {
+    QString content;
+    QTextStream out(&content);
+    
+    const QString guard = getIncludeGuard(m_namespace + "Facets");
+    out << "#ifndef " << guard << "\n";
+    out << "#define " << guard << "\n\n";
+    out << "#include \"XmlFacets.h\"\n";
+    out << "#include <QDateTime>\n";
+    out << "#include <QString>\n\n";
+    out << "namespace " << m_namespace << " {\n\n";
+    
+    for (auto it = m_facetTypes.constBegin(); it != m_facetTypes.constEnd(); ++it) {
+        writeValidator(out, it.key(), it.value());
+    }
+    
+    out << "} // namespace " << m_namespace << "\n\n";
+    out << "#endif // " << guard << "\n";
+    out.flush();
+    
+    if (!writeFile(outputDir, facetsHeaderName(), content, result)) {
+        result->errorMsg = QString("Failed to generate %1").arg(facetsHeaderName());
+        return false;
+    }
+    return true;
+}
+
+bool CodeGenerator::generateColumns(const QVector<Job>& jobs, const QString& outputDir, JobResult* result) const {
+    QHash<QString, QSharedPointer<XsdType>> typeOfClass;
+    for (const Job& job : jobs) {
+        typeOfClass.insert(job.className, job.type);
+    }
+    
+    // One view per repeated complex element a class declares; derived
+    // classes use their base's view
+    struct View {
+        QString name;
+        QString ownerClass;
+        QSharedPointer<XsdElement> elem;
+        QStringList classes;    // concrete classes, the declared one last
+    };
+    QVector<View> views;
+    QStringList includes;
+    QStringList enums;
+    for (const Job& job : jobs) {
+        for (const auto& elem : job.type->elements) {
+            if ((elem->maxOccurs != -1 && elem->maxOccurs <= 1) || elem->typeName.isEmpty() || isSimpleType(elem->typeName)) {
+                continue;
+            }
+            View view;
+            view.ownerClass = job.className;
+            view.elem = elem;
+            view.name = job.className + toCppClassName(elem->name) + "Columns";
+            const QString declared = toCppTypeName(elem->typeName);
+            for (const auto& substitute : substitutesFor(elem)) {
+                if (substitute.second != declared && typeOfClass.contains(substitute.second)
+                    && !view.classes.contains(substitute.second)) {
+                    view.classes.append(substitute.second);
+                }
+            }
+            if (!typeOfClass.contains(declared)) {
+                continue;
+            }
+            view.classes.append(declared);
+            
+            includes.append(job.className);
+            for (const QString& cls : view.classes) {
+                includes.append(cls);
+                for (const auto& field : columnFields(typeOfClass.value(cls))) {
+                    enums.append(toCppTypeName(field->typeName));
+                }
+                for (const auto& attr : allAttributes(typeOfClass.value(cls))) {
+                    enums.append(toCppTypeName(attr->typeName));
+                }
+            }
+            views.append(view);
+        }
+    }
+    includes.removeDuplicates();
+    includes.sort();
+    enums.removeDuplicates();
+    enums.sort();
+    
+    auto lowerFirst = [](QString name) {
+        name[0] = name[0].toLower();
+        return name;
+    };
+    auto getter = [](QString name) {
+        name[0] = name[0].toUpper();
+        return "get" + name + "()";
+    };
+    
+    QString header;
+    QTextStream out(&header);
+    const QString guard = getIncludeGuard(m_namespace + "Columns");
+    out << "#ifndef " << guard << "\n";
+    out << "#define " << guard << "\n\n";
+    out << "#include <QDateTime>\n";
+    out << "#include <QString>\n";
+    out << "#include <QVector>\n";
+    for (const QString& cppType : enums) {
+        if (isEnum(cppType)) {
+            out << "#include \"" << cppType << ".h\"\n";
+        }
+    }
+    out << "\nnamespace " << m_namespace << " {\n\n";
+    for (const QString& cls : includes) {
+        out << "class " << cls << ";\n";
+    }
+    out << "\n";
+    
+    for (const View& view : views) {
+        const QString declared = view.classes.last();
+        out << "/**\n";
+        out << " * " << view.ownerClass << "'s " << view.elem->name << " list as columns: one contiguous array per\n";
+        out << " * scalar field, grouped by the concrete class of the items\n";
+        out << " */\n";
+        out << "struct " << view.name << " {\n";
+        for (const QString& cls : view.classes) {
+            const QSharedPointer<XsdType> type = typeOfClass.value(cls);
+            out << "    struct " << cls << "Columns {\n";
+            // The trailing underscore keeps it apart from field columns such as position
+            out << "        QVector<int> itemPosition_;  // index of the item in the list\n";
+            for (const auto& field : columnFields(type)) {
+                out << "        QVector<" << toCppTypeName(field->typeName) << "> " << toCppMemberName(field->name).mid(2) << ";\n";
+            }
+            for (const auto& attr : allAttributes(type)) {
+                out << "        QVector<" << toCppTypeName(attr->typeName) << "> " << toCppMemberName(attr->name).mid(2) << ";\n";
+            }
+            out << "    };\n\n";
+        }
+        for (const QString& cls : view.classes) {
+            out << "    " << cls << "Columns " << lowerFirst(cls) << ";\n";
+        }
+        out << "\n";
+        out << "    /**\n";
+        out << "     * Columns of the owner's list; null items are left out\n";
+        out << "     */\n";
+        out << "    static " << view.name << " fromObjects(const " << view.ownerClass << "& owner);\n";
+        out << "\n";
+        out << "    /**\n";
+        out << "     * Add one item, e.g. while building the list; classes outside\n";
+        out << "     * the substitution group go to " << lowerFirst(declared) << "\n";
+        out << "     */\n";
+        out << "    void append(const " << declared << "& item, int position);\n";
+        QStringList sizes;
+        for (const QString& cls : view.classes) {
+            sizes.append(lowerFirst(cls) + ".itemPosition_.size()");
+        }
+        out << "    int size() const { return " << sizes.join(" + ") << "; }\n";
+        out << "};\n\n";
+    }
+    
+    out << "} // namespace " << m_namespace << "\n\n";
+    out << "#endif // " << guard << "\n";
+    out.flush();
+    
+    if (!writeFile(outputDir, columnsHeaderName(), header, result)) {
+        result->errorMsg = QString("Failed to generate %1").arg(columnsHeaderName());
+        return false;
+    }
+    
+    QString source;
+    QTextStream cpp(&source);
+    cpp << "#include \"" << columnsHeaderName() << "\"\n";
+    for (const QString& cls : includes) {
+        cpp << "#include \"" << cls << ".h\"\n";
+    }
+    cpp << "#include <typeinfo>\n\n";
+    cpp << "namespace " << m_namespace << " {\n\n";
+    
+    for (const View& view : views) {
+        const QString declared = view.classes.last();
+        cpp << view.name << " " << view.name << "::fromObjects(const " << view.ownerClass << "& owner) {\n";
+        cpp << "    " << view.name << " columns;\n";
+        cpp << "    const auto& items = owner." << getter(view.elem->name) << ";\n";
+        cpp << "    for (int i = 0; i < items.size(); ++i) {\n";
+        cpp << "        if (items.at(i)) {\n";
+        cpp << "            columns.append(*items.at(i), i);\n";
+        cpp << "        }\n";
+        cpp << "    }\n";
+        cpp << "    return columns;\n";
+        cpp << "}\n\n";
+        
+        cpp << "void " << view.name << "::append(const " << declared << "& item, int position) {\n";
+        if (view.classes.size() > 1) {
+            // Exact classes, so a derived item never lands in its base's group
+            cpp << "    const std::type_info& type = typeid(item);\n";
+        }
+        for (const QString& cls : view.classes) {
+            const QSharedPointer<XsdType> type = typeOfClass.value(cls);
+            const QString group = lowerFirst(cls);
+            QString indent = "    ";
+            QString row = "item";
+            if (cls != declared) {
+                cpp << "    if (type == typeid(" << cls << ")) {\n";
+                cpp << "        const " << cls << "& row = static_cast<const " << cls << "&>(item);\n";
+                indent = "        ";
+                row = "row";
+            } else if (view.classes.size() > 1) {
+                cpp << "\n";
+            }
+            cpp << indent << group << ".itemPosition_.append(position);\n";
+            for (const auto& field : columnFields(type)) {
+                cpp << indent << group << "." << toCppMemberName(field->name).mid(2) << ".append(" << row << "." << getter(field->name) << ");\n";
+            }
+            for (const auto& attr : allAttributes(type)) {
+                cpp << indent << group << "." << toCppMemberName(attr->name).mid(2) << ".append(" << row << "." << getter(attr->name) << ");\n";
+            }
+            if (cls != declared) {
+                cpp << "        return;\n";
+                cpp << "    }\n";
+            }
+        }
+        cpp << "}\n\n";
+    }
+    
+    cpp << "} // namespace " << m_namespace << "\n";
+    cpp.flush();
+    
+    if (!writeFile(outputDir, columnsSourceName(), source, result)) {
+        result->errorMsg = QString("Failed to generate %1").arg(columnsSourceName());
+        return false;
+    }
+    return true;
+}
+
+QList<QSharedPointer<XsdElement>> CodeGenerator::columnFields(const QSharedPointer<XsdType>& type) const {
+    // Single scalar elements, inherited ones first
+    QList<QSharedPointer<XsdElement>> result;
+    for (const auto& elem : allElements(type)) {
+        if (elem->maxOccurs == 1 && isSimpleType(elem->typeName)) {
+            result.append(elem);
+        }
+    }
+    return result;
+}
+
+void CodeGenerator::writeValidator(QTextStream& out, const QString& typeName, const QSharedPointer<XsdType>& type) const {
+    const QString cppType = simpleCppType(type);
+    const Facets facets = facetsOf(type);
+    const bool isString = cppType == "QString";
+    const bool isDate = cppType == "QDateTime" || cppType == "QDate" || cppType == "QTime";
+    const bool isNumber = cppType.contains("int") || cppType == "double" || cppType == "float";
+    
+    // The failed facet is described by a literal, so checking formats nothing
+    auto fail = [&](const QString& condition, const QString& expected) {
+        out << "    if (" << condition << ") {\n";
+        out << "        if (expected) *expected = \"" << escaped(expected) << "\";\n";
+        out << "        return false;\n";
+        out << "    }\n";
+    };
+    
+    out << "/**\n";
+    out << " * Facets of " << typeName << "\n";
+    out << " */\n";
+    out << "inline bool " << validatorFor(typeName) << "("
+        << (isString || isDate ? "const " + cppType + "&" : cppType) << " value, const char** expected = nullptr) {\n";
+    
+    // Length first, patterns last: the cheap checks reject most bad values
+    if (isString && (facets.minLength >= 0 || facets.maxLength >= 0)) {
+        out << "    const int length = XsdQt::xmlLength(value);\n";
+        if (facets.minLength == facets.maxLength) {
+            fail(QString("length != %1").arg(facets.minLength), QString("exactly %1 characters").arg(facets.minLength));
+        } else {
+            if (facets.minLength >= 0) {
+                fail(QString("length < %1").arg(facets.minLength), QString("at least %1 characters").arg(facets.minLength));
+            }
+            if (facets.maxLength >= 0) {
+                fail(QString("length > %1").arg(facets.maxLength), QString("at most %1 characters").arg(facets.maxLength));
+            }
+        }
+    }
+    
+    // Bounds that don't parse as the value type are left out
+    auto bound = [&](const QString& name, const QString& value, const char* op, const char* allowed) {
+        if (value.isEmpty()) {
+            return;
+        }
+        QString literal;
+        bool ok = false;
+        if (isDate) {
+            out << "    static const " << cppType << " " << name << " = " << cppType
+                << "::fromString(QStringLiteral(\"" << escaped(value.trimmed()) << "\"), Qt::ISODate);\n";
+            literal = name;
+        } else if (cppType.contains("int")) {
+            const qlonglong number = value.trimmed().toLongLong(&ok);
+            if (!ok) {
+                return;
+            }
+            literal = QString::number(number);
+        } else if (isNumber) {
+            const double number = value.trimmed().toDouble(&ok);
+            if (!ok || !qIsFinite(number)) {
+                return;
+            }
+            literal = QString::number(number, 'g', 17);
+        } else {
+            return;
+        }
+        fail(QString("value %1 %2").arg(op, literal), QString("%1 %2").arg(allowed, value.trimmed()));
+    };
+    bound("minInclusive", facets.minInclusive, "<", ">=");
+    bound("maxInclusive", facets.maxInclusive, ">", "<=");
+    bound("minExclusive", facets.minExclusive, "<=", ">");
+    bound("maxExclusive", facets.maxExclusive, ">=", "<");
+    
+    // Compiled on first use, once per process
+    if (isString) {
+        for (int i = 0; i < facets.patterns.size(); ++i) {
+            out << "    static const QRegularExpression pattern" << i << " = XsdQt::compileXmlPattern(QStringLiteral(\""
+                << escaped(facets.patterns.at(i)) << "\"));\n";
+            fail(QString("!pattern%1.match(value).hasMatch()").arg(i), "pattern " + facets.patterns.at(i));
+        }
+    }
+    
+    out << "    return true;\n";
+    out << "}\n\n";
+}
+
+QString CodeGenerator::toCppTypeName(const QString& xsdType) const {
+    // Remove namespace prefix if present
+    QString cleanType = xsdType;
+    int colonPos = xsdType.indexOf(':');
+    if (colonPos >= 0) {
+        cleanType = xsdType.mid(colonPos + 1);
+    }
+    
+    // Check if it's a built-in type
+    if (m_typeMapping.contains(xsdType)) {
+        return m_typeMapping.value(xsdType);
+    }
+    if (m_typeMapping.contains(cleanType)) {
+        return m_typeMapping.value(cleanType);
+    }
+    
+    // Otherwise it's a user-defined type
+    return toCppClassName(cleanType);
+}
+
+QString CodeGenerator::toCppClassName(const QString& name) const {
+    QString result = name;
+    
+    // Capitalize first letter
+    if (!result.isEmpty()) {
+        result[0] = result[0].toUpper();
+    }
+    
+    // Remove hyphens and underscores, capitalize following letter
+    for (int i = 0; i < result.length(); ++i) {
+        if (result[i] == '-' || result[i] == '_') {
+            result.remove(i, 1);
+            if (i < result.length()) {
+                result[i] = result[i].toUpper();
+            }
+        }
+    }
+    
+    return result;
+}
+
+QString CodeGenerator::toCppMemberName(const QString& name) const {
+    QString result = name;
+    
+    // Start with lowercase
+    if (!result.isEmpty()) {
+        result[0] = result[0].toLower();
+    }
+    
+    // Remove hyphens, capitalize following letter
+    for (int i = 0; i < result.length(); ++i) {
+        if (result[i] == '-') {
+            result.remove(i, 1);
+            if (i < result.length()) {
+                result[i] = result[i].toUpper();
+            }
+        }
+    }
+    
+    return "m_" + result;
+}
+
+QString CodeGenerator::getIncludeGuard(const QString& className) const {
+    return className.toUpper() + "_H";
+}
+
+bool CodeGenerator::generateHeader(const QString& className, const QSharedPointer<XsdType>& type, const QString& outputDir,
+                                   JobResult* result) const {
+    QString content;
+    QTextStream out(&content);
+    
+    QString guard = getIncludeGuard(className);
+    out << "#ifndef " << guard << "\n";
+    out << "#define " << guard << "\n\n";
+    
+    writeHeaderIncludes(out);
+    if (isChoiceUnion(type)) {
+        out << "#include \"XmlChoice.h\"\n\n";
+    }
+    if (!type->baseTypeName.isEmpty()) {
+        out << "#include \"" << getBaseClassName(type->baseTypeName) << ".h\"\n\n";
+    }
+    
+    // Enum members are held by value, so their headers come first
+    QStringList enums;
+    for (const auto& elem : type->elements) {
+        enums.append(toCppTypeName(elem->typeName));
+    }
+    for (const auto& attr : type->attributes) {
+        enums.append(toCppTypeName(attr->typeName));
+    }
+    enums.removeDuplicates();
+    enums.sort();
+    bool anyEnum = false;
+    for (const QString& cppType : enums) {
+        if (isEnum(cppType)) {
+            out << "#include \"" << cppType << ".h\"\n";
+            anyEnum = true;
+        }
+    }
+    if (anyEnum) {
+        out << "\n";
+    }
+    
+    out << "namespace " << m_namespace << " {\n\n";
+    
+    writeClassDeclaration(out, className, type);
+    
+    out << "} // namespace " << m_namespace << "\n\n";
+    out << "#endif // " << guard << "\n";
+    out.flush();
+    
+    return writeFile(outputDir, className + ".h", content, result);
+}
+
+void CodeGenerator::writeHeaderIncludes(QTextStream& out) const {
+    out << "#include \"XmlSerializable.h\"\n";
+    out << "#include \"XmlHelpers.h\"\n";
+    out << "#include <QString>\n";
+    out << "#include <QDateTime>\n";
+    out << "#include <QVector>\n";
+    out << "#include <QSharedPointer>\n\n";
+}
+
+void CodeGenerator::writeClassDeclaration(QTextStream& out, const QString& className, const QSharedPointer<XsdType>& type) const {
+    // Forward declarations for cyclic dependencies
+    out << "// Forward declarations\n";
+    for (const auto& elem : type->elements) {
+        QString elemType = toCppTypeName(elem->typeName);
+        if (!isSimpleType(elem->typeName) && !elem->typeName.isEmpty()) {
+            out << "class " << elemType << ";\n";
+        }
+    }
+    out << "\n";
+    
+    // Class declaration
+    QString baseClass = "XsdQt::XmlSerializable";
+    if (!type->baseTypeName.isEmpty()) {
+        baseClass = getBaseClassName(type->baseTypeName);
+    }
+    
+    out << "class " << className << " : public " << baseClass << " {\n";
+    out << "public:\n";
+    out << "    " << className << "();\n";
+    
+    if (!type->baseTypeName.isEmpty()) {
+        out << "    virtual ~" << className << "() = default;\n\n";
+    }
+    
+    writeGettersSetters(out, type);
+    writeSerializationMethods(out, className);
+    writeBuilder(out, className, type);
+    
+    // Derived classes read inherited members in their fromXml
+    out << "\nprotected:\n";
+    writeMemberVariables(out, type);
+    
+    out << "};\n\n";
+}
+
+void CodeGenerator::writeMemberVariables(QTextStream& out, const QSharedPointer<XsdType>& type) const {
+    // Write member variables for elements; the alternatives of a choice share one storage
+    if (isChoiceUnion(type)) {
+        QStringList alternatives;
+        for (const auto& elem : type->elements) {
+            alternatives.append(storageType(elem));
+        }
+        out << "    XsdQt::XmlChoice<" << alternatives.join(", ") << "> " << choiceMember(type) << ";\n";
+    } else {
+        for (const auto& elem : type->elements) {
+            out << "    " << storageType(elem) << " " << toCppMemberName(elem->name) << ";\n";
+        }
+    }
+    
+    // Write member variables for attributes
+    for (const auto& attr : type->attributes) {
+        QString cppType = toCppTypeName(attr->typeName);
+        QString memberName = toCppMemberName(attr->name);
+        out << "    " << cppType << " " << memberName << ";\n";
+    }
+    
+    // One bit per optional scalar member that was read or set
+    const int present = presenceElements(type).size();
+    if (present > 0) {
+        out << "    " << bitsDeclaration(presenceMember(type), present) << ";\n";
+    }
+}
+
+void CodeGenerator::writeGettersSetters(QTextStream& out, const QSharedPointer<XsdType>& type) const {
+    const bool choice = isChoiceUnion(type);
+    if (choice) {
+        QStringList alternatives("None = -1");
+        for (const auto& elem : type->elements) {
+            QString propertyName = elem->name;
+            propertyName[0] = propertyName[0].toUpper();
+            alternatives.append(propertyName);
+        }
+        out << "    // Alternative of the xs:choice that is set, setting another replaces it\n";
+        out << "    enum class Choice : int { " << alternatives.join(", ") << " };\n";
+        out << "    Choice getChoice() const { return static_cast<Choice>(" << choiceMember(type) << ".index()); }\n";
+        out << "    void clearChoice() { " << choiceMember(type) << ".clear(); }\n\n";
+    }
+    
+    // Getters and setters for elements
+    for (int i = 0; i < type->elements.size(); ++i) {
+        const auto& elem = type->elements.at(i);
+        const QString cppType = toCppTypeName(elem->typeName);
+        const QString item = isSimpleType(elem->typeName) ? cppType : "QSharedPointer<" + cppType + ">";
+        const QString read = memberRead(type, elem);
+        const QString write = memberWrite(type, elem);
+        const QString present = presenceSet(type, elem);
+        QString propertyName = elem->name;
+        propertyName[0] = propertyName[0].toUpper();
+        
+        if (elem->maxOccurs == -1 || elem->maxOccurs > 1) {
+            // List type
+            out << "    const " << storageType(elem) << "& get" << propertyName << "() const { return " << read << "; }\n";
+            out << "    void set" << propertyName << "(const " << storageType(elem) << "& value) { " << write << " = value; }\n";
+            out << "    void set" << propertyName << "(" << storageType(elem) << "&& value) { " << write << " = std::move(value); }\n";
+            out << "    void add" << propertyName << "(const " << item << "& value) { " << write << ".append(value); }\n";
+            out << "    void add" << propertyName << "(" << item << "&& value) { " << write << ".append(std::move(value)); }\n";
+            out << "    void reserve" << propertyName << "(int count) { " << write << ".reserve(count); }\n";
+            if (isSimpleType(elem->typeName)) {
+                out << "    template<typename... Args>\n";
+                out << "    " << item << "& emplace" << propertyName << "(Args&&... args) { " << write << ".append("
+                    << item << "(std::forward<Args>(args)...)); return " << write << ".last(); }\n";
+            } else {
+                // Constructs the item, of this class or a derived one, in its shared block
+                out << "    template<typename Class = " << cppType << ", typename... Args>\n";
+                out << "    QSharedPointer<Class> emplace" << propertyName << "(Args&&... args) {\n";
+                out << "        QSharedPointer<Class> item = QSharedPointer<Class>::create(std::forward<Args>(args)...);\n";
+                out << "        " << write << ".append(item);\n";
+                out << "        return item;\n";
+                out << "    }\n";
+            }
+        } else if (isMovable(elem->typeName)) {
+            // Single value, moved in and read without a copy
+            out << "    const " << item << "& get" << propertyName << "() const { return " << read << "; }\n";
+            out << "    void set" << propertyName << "(const " << item << "& value) { " << write << " = value;"
+                << (present.isEmpty() ? "" : " " + present) << " }\n";
+            out << "    void set" << propertyName << "(" << item << "&& value) { " << write << " = std::move(value);"
+                << (present.isEmpty() ? "" : " " + present) << " }\n";
+        } else {
+            // Single value
+            out << "    " << item << " get" << propertyName << "() const { return " << read << "; }\n";
+            out << "    void set" << propertyName << "(const " << item << "& value) { " << write << " = value;"
+                << (present.isEmpty() ? "" : " " + present) << " }\n";
+        }
+        if (choice) {
+            out << "    bool has" << propertyName << "() const { return " << choiceMember(type) << ".index() == " << i << "; }\n";
+        } else if (!present.isEmpty()) {
+            // Cleared fields keep their value but are no longer written
+            out << "    bool has" << propertyName << "() const { return " << presenceTest(type, elem) << " != 0; }\n";
+            out << "    void clear" << propertyName << "() { " << presenceClear(type, elem) << " }\n";
+        } else if (elem->minOccurs == 0 && elem->maxOccurs == 1) {
+            out << "    bool has" << propertyName << "() const { return !" << read << ".isNull(); }\n";
+            out << "    void clear" << propertyName << "() { " << write << ".clear(); }\n";
+        }
+        out << "\n";
+    }
+    
+    // Getters and setters for attributes
+    for (const auto& attr : type->attributes) {
+        QString cppType = toCppTypeName(attr->typeName);
+        QString memberName = toCppMemberName(attr->name);
+        QString propertyName = attr->name;
+        propertyName[0] = propertyName[0].toUpper();
+        
+        if (isMovable(attr->typeName)) {
+            out << "    const " << cppType << "& get" << propertyName << "() const { return " << memberName << "; }\n";
+            out << "    void set" << propertyName << "(const " << cppType << "& value) { " << memberName << " = value; }\n";
+            out << "    void set" << propertyName << "(" << cppType << "&& value) { " << memberName << " = std::move(value); }\n\n";
+        } else {
+            out << "    " << cppType << " get" << propertyName << "() const { return " << memberName << "; }\n";
+            out << "    void set" << propertyName << "(const " << cppType << "& value) { " << memberName << " = value; }\n\n";
+        }
+    }
+}
+
+bool CodeGenerator::isMovable(const QString& typeName) const {
+    // Types whose copy touches a reference count or the heap; numbers,
+    // enums and dates are cheaper to copy than to refer to
+    if (!isSimpleType(typeName)) {
+        return true;
+    }
+    const QString cppType = toCppTypeName(typeName);
+    return cppType == "QString" || cppType == "QDateTime";
+}
+
+void CodeGenerator::writeBuilder(QTextStream& out, const QString& className, const QSharedPointer<XsdType>& type) const {
+    // Values are taken by value and moved on, so callers passing
+    // temporaries or std::move()d values copy nothing
+    out << "\n";
+    out << "    /**\n";
+    out << "     * Builds a " << className << " in place: " << className << "::Builder().setX(x).addY(y).build()\n";
+    out << "     * build() hands the object over; the next setter starts a new one\n";
+    out << "     */\n";
+    out << "    class Builder {\n";
+    out << "    public:\n";
+    for (const auto& elem : allElements(type)) {
+        const QString cppType = toCppTypeName(elem->typeName);
+        const QString item = isSimpleType(elem->typeName) ? cppType : "QSharedPointer<" + cppType + ">";
+        QString propertyName = elem->name;
+        propertyName[0] = propertyName[0].toUpper();
+        if (elem->maxOccurs == -1 || elem->maxOccurs > 1) {
+            out << "        Builder& set" << propertyName << "(" << storageType(elem) << " value) { object().set"
+                << propertyName << "(std::move(value)); return *this; }\n";
+            out << "        Builder& add" << propertyName << "(" << item << " value) { object().add"
+                << propertyName << "(std::move(value)); return *this; }\n";
+        } else {
+            out << "        Builder& set" << propertyName << "(" << item << " value) { object().set"
+                << propertyName << "(std::move(value)); return *this; }\n";
+        }
+    }
+    for (const auto& attr : allAttributes(type)) {
+        QString propertyName = attr->name;
+        propertyName[0] = propertyName[0].toUpper();
+        out << "        Builder& set" << propertyName << "(" << toCppTypeName(attr->typeName) << " value) { object().set"
+            << propertyName << "(std::move(value)); return *this; }\n";
+    }
+    out << "\n";
+    out << "        QSharedPointer<" << className << "> build() { object(); return std::move(m_object); }\n\n";
+    out << "    private:\n";
+    out << "        // Created on first use, so a builder can be reused after build()\n";
+    out << "        " << className << "& object() {\n";
+    out << "            if (!m_object) {\n";
+    out << "                m_object = QSharedPointer<" << className << ">::create();\n";
+    out << "            }\n";
+    out << "            return *m_object;\n";
+    out << "        }\n\n";
+    out << "        QSharedPointer<" << className << "> m_object;\n";
+    out << "    };\n";
+}
+
+void CodeGenerator::writeSerializationMethods(QTextStream& out, const QString& className) const {
+    out << "    // Serialization\n";
+    out << "    void toXml(QXmlStreamWriter& writer) const override;\n";
+    if (m_utf8Writer) {
+        out << "    bool toXml(XsdQt::XmlUtf8Writer& writer) const override;\n";
+    }
+    out << "    bool fromXml(QXmlStreamReader& reader) override;\n";
+    if (m_fastReader) {
+        out << "    bool fromXml(XsdQt::XmlFastReader& reader) override;\n";
+    }
+    out << "    QString xmlElementName() const override;\n";
+    out << "    QString xsdTypeName() const override;\n";
+}
+
+QString CodeGenerator::getBaseClassName(const QString& baseTypeName) const {
+    // Strips the namespace prefix ("tns:VehicleType")
+    return toCppTypeName(baseTypeName);
+}
+
+QSharedPointer<XsdType> CodeGenerator::findType(const QString& typeName) const {
+    return m_schema->types.value(typeName);
+}
+
+bool CodeGenerator::generateImplementation(const QString& className, const QSharedPointer<XsdType>& type, const QString& outputDir,
+                                           JobResult* result) const {
+    QString content;
+    QTextStream out(&content);
+    
+    // Unity units include the umbrella header once instead
+    if (m_unityUnits <= 0) {
+        writeImplementationIncludes(out, className, type);
+    }
+    
+    out << "namespace " << m_namespace << " {\n\n";
+    
+    writeConstructor(out, className, type);
+    writeToXmlImplementation(out, className, type);
+    if (m_utf8Writer) {
+        writeToXmlUtf8Implementation(out, className, type);
+    }
+    writeFromXmlImplementation(out, className, type, "QXmlStreamReader");
+    if (m_fastReader) {
+        writeFromXmlImplementation(out, className, type, "XsdQt::XmlFastReader");
+    }
+    
+    writeTypeNames(out, className, elementNameFor(className), type->name);
+    
+    out << "} // namespace " << m_namespace << "\n";
+    out.flush();
+    
+    if (m_unityUnits > 0) {
+        result->implementation = content;
+        return true;
+    }
+    return writeFile(outputDir, className + ".cpp", content, result);
+}
+
+void CodeGenerator::writeImplementationIncludes(QTextStream& out, const QString& className, const QSharedPointer<XsdType>& type) const {
+    out << "#include \"" << className << ".h\"\n";
+    if (!allAttributes(type).isEmpty()) {
+        out << "#include \"XmlAttributeBinder.h\"\n";
+    }
+    if (usesValidators(type)) {
+        out << "#include \"" << facetsHeaderName() << "\"\n";
+    }
+    
+    // fromXml constructs every class its fields dispatch to
+    QStringList classes;
+    for (const auto& elem : allElements(type)) {
+        if (isSimpleType(elem->typeName)) {
+            continue;
+        }
+        for (const auto& substitute : substitutesFor(elem)) {
+            if (substitute.second != className && !classes.contains(substitute.second)) {
+                classes.append(substitute.second);
+            }
+        }
+    }
+    classes.sort();
+    for (const QString& cls : classes) {
+        out << "#include \"" << cls << ".h\"\n";
+    }
+    out << "\n";
+}
+
+void CodeGenerator::writeConstructor(QTextStream& out, const QString& className, const QSharedPointer<XsdType>& type) const {
+    out << className << "::" << className << "() {\n";
+    
+    // Initialize simple type members with defaults; a choice starts with none set
+    const QList<QSharedPointer<XsdElement>> members = isChoiceUnion(type) ? QList<QSharedPointer<XsdElement>>() : type->elements;
+    for (const auto& elem : members) {
+        const bool isList = elem->maxOccurs == -1 || elem->maxOccurs > 1;
+        const QString cppType = toCppTypeName(elem->typeName);
+        if (isEnum(cppType) && !isList) {
+            // The default value, else the first xs:enumeration value
+            out << "    " << toCppMemberName(elem->name) << " = " << enumeratorFor(cppType, elem->defaultValue) << ";\n";
+            continue;
+        }
+        
+        if (isSimpleType(elem->typeName) && !elem->defaultValue.isEmpty()) {
+            QString memberName = toCppMemberName(elem->name);
+            
+            if (cppType == "QString") {
+                out << "    " << memberName << " = \"" << elem->defaultValue << "\";\n";
+            } else if (cppType == "int" || cppType.contains("int")) {
+                out << "    " << memberName << " = " << elem->defaultValue << ";\n";
+            } else if (cppType == "bool") {
+                out << "    " << memberName << " = " << (elem->defaultValue == "true" ? "true" : "false") << ";\n";
+            }
+        }
+    }
+    for (const auto& attr : type->attributes) {
+        const QString cppType = toCppTypeName(attr->typeName);
+        if (isEnum(cppType)) {
+            out << "    " << toCppMemberName(attr->name) << " = " << enumeratorFor(cppType, attr->defaultValue) << ";\n";
+        }
+    }
+    
+    out << "}\n\n";
+}
+
+void CodeGenerator::writeToXmlImplementation(QTextStream& out, const QString& className, const QSharedPointer<XsdType>& type) const {
+    out << "void " << className << "::toXml(QXmlStreamWriter& writer) const {\n";
+    
+    // Call base class if there's inheritance
+    if (!type->baseTypeName.isEmpty()) {
+        QString baseClass = getBaseClassName(type->baseTypeName);
+        out << "    " << baseClass << "::toXml(writer);\n\n";
+    }
+    
+    // Write attributes
+    for (const auto& attr : type->attributes) {
+        QString value = toCppMemberName(attr->name);
+        if (isEnum(toCppTypeName(attr->typeName))) {
+            value = "toXmlString(" + value + ")";
+        }
+        out << "    XsdQt::XmlHelpers::writeAttribute(writer, \"" << attr->name << "\", " << value << ");\n";
+    }
+    
+    if (!type->attributes.isEmpty()) {
+        out << "\n";
+    }
+    
+    // Write elements; of a choice only the alternative that is set
+    const bool choice = isChoiceUnion(type);
+    if (choice) {
+        out << "    switch (" << choiceMember(type) << ".index()) {\n";
+    }
+    for (int i = 0; i < type->elements.size(); ++i) {
+        const auto& elem = type->elements.at(i);
+        const QString memberName = memberRead(type, elem);
+        const QString cppType = toCppTypeName(elem->typeName);
+        const QString present = presenceTest(type, elem);
+        QString indent = "    ";
+        if (choice) {
+            out << "    case " << i << ":\n";
+            indent += "    ";
+        }
+        if (!present.isEmpty()) {
+            out << indent << "if " << present << " {\n";
+            indent += "    ";
+        }
+        
+        if (elem->maxOccurs == -1 || elem->maxOccurs > 1) {
+            // List type
+            out << indent << "for (const auto& item : " << memberName << ") {\n";
+            if (isEnum(cppType)) {
+                out << indent << "    XsdQt::XmlHelpers::writeElement(writer, \"" << elem->name << "\", toXmlString(item));\n";
+            } else if (isSimpleType(elem->typeName)) {
+                out << indent << "    XsdQt::XmlHelpers::writeElement(writer, \"" << elem->name << "\", item);\n";
+            } else {
+                out << indent << "    if (item) {\n";
+                out << indent << "        XsdQt::XmlHelpers::writePolymorphicElement(writer, item);\n";
+                out << indent << "    }\n";
+            }
+            out << indent << "}\n";
+        } else {
+            // Single value
+            if (isEnum(cppType)) {
+                out << indent << "XsdQt::XmlHelpers::writeElement(writer, \"" << elem->name << "\", toXmlString(" << memberName << "));\n";
+            } else if (isSimpleType(elem->typeName)) {
+                out << indent << "XsdQt::XmlHelpers::writeElement(writer, \"" << elem->name << "\", " << memberName << ");\n";
+            } else {
+                out << indent << "if (" << memberName << ") {\n";
+                out << indent << "    XsdQt::XmlHelpers::writePolymorphicElement(writer, " << memberName << ");\n";
+                out << indent << "}\n";
+            }
+        }
+        
+        if (!present.isEmpty()) {
+            out << indent.left(indent.size() - 4) << "}\n";
+        }
+        if (choice) {
+            out << "        break;\n";
+        }
+    }
+    if (choice) {
+        out << "    }\n";
+    }
+    
     out << "}\n\n";
 }
 
-void CodeGenerator::writeToXmlImplementation(QTextStream& out, const QString& className, const QSharedPointer<XsdType>& type) {
-    out << "void " << className << "::toXml(QXmlStreamWriter& writer) const {\n";
+void CodeGenerator::writeToXmlUtf8Implementation(QTextStream& out, const QString& className, const QSharedPointer<XsdType>& type) const {
+    // Names are written as string literals, i.e. pre-encoded UTF-8 constants
+    out << "bool " << className << "::toXml(XsdQt::XmlUtf8Writer& writer) const {\n";
     
-    // Call base class if there's inheritance
     if (!type->baseTypeName.isEmpty()) {
         QString baseClass = getBaseClassName(type->baseTypeName);
-        out << "    " << baseClass << "::toXml(writer);\n\n";
+        out << "    if (!" << baseClass << "::toXml(writer)) {\n";
+        out << "        return false;\n";
+        out << "    }\n\n";
     }
     
-    // Write attributes
     for (const auto& attr : type->attributes) {
-        QString memberName = toCppMemberName(attr->name);
-        out << "    XsdQt::XmlHelpers::writeAttribute(writer, \"" << attr->name << "\", " << memberName << ");\n";
+        QString value = toCppMemberName(attr->name);
+        if (isEnum(toCppTypeName(attr->typeName))) {
+            value = "toXmlString(" + value + ")";
+        }
+        out << "    writer.writeAttribute(\"" << attr->name << "\", " << value << ");\n";
     }
     
     if (!type->attributes.isEmpty()) {
         out << "\n";
     }
     
-    // Write elements
-    for (const auto& elem : type->elements) {
-        QString memberName = toCppMemberName(elem->name);
-        QString cppType = toCppTypeName(elem->typeName);
+    const bool choice = isChoiceUnion(type);
+    if (choice) {
+        out << "    switch (" << choiceMember(type) << ".index()) {\n";
+    }
+    for (int i = 0; i < type->elements.size(); ++i) {
+        const auto& elem = type->elements.at(i);
+        const QString memberName = memberRead(type, elem);
+        const bool enumField = isEnum(toCppTypeName(elem->typeName));
+        const QString present = presenceTest(type, elem);
+        QString indent = "    ";
+        if (choice) {
+            out << "    case " << i << ":\n";
+            indent += "    ";
+        }
+        if (!present.isEmpty()) {
+            out << indent << "if " << present << " {\n";
+            indent += "    ";
+        }
         
         if (elem->maxOccurs == -1 || elem->maxOccurs > 1) {
-            // List type
-            out << "    for (const auto& item : " << memberName << ") {\n";
-            if (m_typeMapping.contains(elem->typeName)) {
-                out << "        XsdQt::XmlHelpers::writeElement(writer, \"" << elem->name << "\", item);\n";
+            out << indent << "for (const auto& item : " << memberName << ") {\n";
+            if (enumField) {
+                out << indent << "    writer.writeTextElement(\"" << elem->name << "\", toXmlString(item));\n";
+            } else if (isSimpleType(elem->typeName)) {
+                out << indent << "    writer.writeTextElement(\"" << elem->name << "\", item);\n";
             } else {
-                out << "        if (item) {\n";
-                out << "            XsdQt::XmlHelpers::writePolymorphicElement(writer, item);\n";
-                out << "        }\n";
+                out << indent << "    if (item && !XsdQt::XmlHelpers::writePolymorphicElement(writer, item)) {\n";
+                out << indent << "        return false;\n";
+                out << indent << "    }\n";
             }
-            out << "    }\n";
+            out << indent << "}\n";
         } else {
-            // Single value
-            if (m_typeMapping.contains(elem->typeName)) {
-                out << "    XsdQt::XmlHelpers::writeElement(writer, \"" << elem->name << "\", " << memberName << ");\n";
+            if (enumField) {
+                out << indent << "writer.writeTextElement(\"" << elem->name << "\", toXmlString(" << memberName << "));\n";
+            } else if (isSimpleType(elem->typeName)) {
+                out << indent << "writer.writeTextElement(\"" << elem->name << "\", " << memberName << ");\n";
             } else {
-                out << "    if (" << memberName << ") {\n";
-                out << "        XsdQt::XmlHelpers::writePolymorphicElement(writer, " << memberName << ");\n";
-                out << "    }\n";
+                out << indent << "if (" << memberName << " && !XsdQt::XmlHelpers::writePolymorphicElement(writer, " << memberName << ")) {\n";
+                out << indent << "    return false;\n";
+                out << indent << "}\n";
             }
         }
+        
+        if (!present.isEmpty()) {
+            out << indent.left(indent.size() - 4) << "}\n";
+        }
+        if (choice) {
+            out << "        break;\n";
+        }
+    }
+    if (choice) {
+        out << "    }\n";
     }
     
+    out << "    return true;\n";
     out << "}\n\n";
 }
 
-void CodeGenerator::writeFromXmlImplementation(QTextStream& out, const QString& className, const QSharedPointer<XsdType>& type) {
-    out << "bool " << className << "::fromXml(QXmlStreamReader& reader) {\n";
+void CodeGenerator::writeFromXmlImplementation(QTextStream& out, const QString& className, const QSharedPointer<XsdType>& type,
+                                               const QString& readerType) const {
+    // The XmlHelpers overloads make the body identical for both readers
+    out << "bool " << className << "::fromXml(" << readerType << "& reader) {\n";
     
-    // Read attributes first
-    if (!type->attributes.isEmpty()) {
-        out << "    // Read attributes\n";
-        for (const auto& attr : type->attributes) {
-            QString memberName = toCppMemberName(attr->name);
-            QString cppType = toCppTypeName(attr->typeName);
-            
-            if (cppType == "QString") {
-                out << "    " << memberName << " = XsdQt::XmlHelpers::readAttribute(reader, \"" << attr->name << "\"";
-                if (!attr->defaultValue.isEmpty()) {
-                    out << ", \"" << attr->defaultValue << "\"";
-                }
-                out << ");\n";
-            } else if (cppType == "int" || cppType.contains("int")) {
-                out << "    " << memberName << " = XsdQt::XmlHelpers::readIntAttribute(reader, \"" << attr->name << "\"";
-                if (!attr->defaultValue.isEmpty()) {
-                    out << ", " << attr->defaultValue;
-                }
-                out << ");\n";
-            } else if (cppType == "bool") {
-                out << "    " << memberName << " = XsdQt::XmlHelpers::readBoolAttribute(reader, \"" << attr->name << "\"";
-                if (!attr->defaultValue.isEmpty()) {
-                    out << ", " << (attr->defaultValue == "true" ? "true" : "false");
-                }
-                out << ");\n";
+    // Inherited members are protected, so one pass reads the whole content
+    const QList<QSharedPointer<XsdElement>> elements = allElements(type);
+    const QList<QSharedPointer<XsdAttribute>> attributes = allAttributes(type);
+    const Occurrences occurrences = occurrencesOf(type);
+    
+    // One branch per element that may appear here; a complex field has one
+    // per substitution group member, each constructing its class directly
+    struct Branch {
+        QString name;
+        QSharedPointer<XsdElement> elem;
+        QString substituteClass;
+        int next;   // branch expected after this one in a sequence
+    };
+    QVector<Branch> branches;
+    for (const auto& elem : elements) {
+        const bool isList = elem->maxOccurs == -1 || elem->maxOccurs > 1;
+        const int first = branches.size();
+        if (isSimpleType(elem->typeName)) {
+            branches.append({elem->name, elem, QString(), 0});
+        } else {
+            for (const auto& substitute : substitutesFor(elem)) {
+                branches.append({substitute.first, elem, substitute.second, 0});
             }
         }
+        // Items of a list usually repeat the same element
+        for (int i = first; i < branches.size(); ++i) {
+            branches[i].next = isList ? i : branches.size();
+        }
+    }
+    QStringList names;
+    for (const Branch& branch : branches) {
+        names.append(branch.name);
+    }
+    
+    // In an xs:sequence children arrive in declaration order, so the
+    // expected next child is compared first and the full dispatch only
+    // runs on a mismatch (optional children left out, a list ending)
+    const bool predicted = branches.size() >= 3 && isSequence(type);
+    
+    // Which single and required children (and required attributes) were seen
+    if (occurrences.bitCount > 0) {
+        out << "    " << bitsDeclaration("seen", occurrences.bitCount) << ";\n";
+    }
+    for (const QString& counter : occurrences.counters) {
+        out << "    int " << counter << " = 0;\n";
+    }
+    if (predicted) {
+        out << "    int next = 0;\n";
+    }
+    if (occurrences.bitCount > 0 || !occurrences.counters.isEmpty() || predicted) {
         out << "\n";
     }
     
+    // Read attributes in one pass over the list, dispatched on the name hash
+    if (!attributes.isEmpty()) {
+        writeAttributeBinding(out, attributes, readerType, occurrences);
+    }
+    
     // Read child elements
     out << "    // Read child elements\n";
     out << "    while (!reader.atEnd()) {\n";
@@ -461,82 +1693,286 @@ void CodeGenerator::writeFromXmlImplementation(QTextStream& out, const QString&
     out << "            break;\n";
     out << "        }\n\n";
     out << "        if (reader.isStartElement()) {\n";
-    out << "            QString name = reader.name().toString();\n\n";
+    if (readerType == "QXmlStreamReader") {
+        out << "            QString name = reader.name().toString();\n\n";
+    } else {
+        // Compared in place against the literals, no QString per element
+        out << "            const XsdQt::XmlUtf8View name = reader.name();\n\n";
+    }
     
-    // Generate if-else chain for each element
-    bool first = true;
-    for (const auto& elem : type->elements) {
-        QString memberName = toCppMemberName(elem->name);
-        QString cppType = toCppTypeName(elem->typeName);
-        
-        out << "            ";
-        if (!first) out << "else ";
-        out << "if (name == \"" << elem->name << "\") {\n";
-        
-        if (elem->maxOccurs == -1 || elem->maxOccurs > 1) {
-            // List type
-            if (m_typeMapping.contains(elem->typeName)) {
-                if (cppType == "QString") {
-                    out << "                " << memberName << ".append(XsdQt::XmlHelpers::readElementText(reader));\n";
-                } else if (cppType == "int" || cppType.contains("int")) {
-                    out << "                " << memberName << ".append(XsdQt::XmlHelpers::readInt(reader));\n";
-                } else if (cppType == "double" || cppType == "float") {
-                    out << "                " << memberName << ".append(XsdQt::XmlHelpers::readDouble(reader));\n";
-                } else if (cppType == "bool") {
-                    out << "                " << memberName << ".append(XsdQt::XmlHelpers::readBool(reader));\n";
-                } else if (cppType == "QDateTime") {
-                    out << "                " << memberName << ".append(XsdQt::XmlHelpers::readDateTime(reader));\n";
-                } else if (cppType == "QDate") {
-                    out << "                " << memberName << ".append(XsdQt::XmlHelpers::readDate(reader));\n";
-                } else if (cppType == "QTime") {
-                    out << "                " << memberName << ".append(XsdQt::XmlHelpers::readTime(reader));\n";
-                }
-            } else {
-                out << "                auto item = XsdQt::XmlHelpers::readPolymorphicElement(reader, \"" << elem->name << "\");\n";
-                out << "                if (item) {\n";
-                out << "                    " << memberName << ".append(item.dynamicCast<" << cppType << ">());\n";
-                out << "                }\n";
-            }
+    auto writeBranch = [&](const Branch& branch) {
+        const QString indent = "                ";
+        if (branch.substituteClass.isEmpty()) {
+            writeOccurrenceCount(out, occurrences, branch.elem, indent);
+            writeSimpleElementRead(out, type, branch.elem);
+            return;
+        }
+        const QString memberName = memberWrite(type, branch.elem);
+        const QString read = QString("XsdQt::XmlHelpers::readSubstitutedElement<%1, %2>(reader)")
+            .arg(toCppTypeName(branch.elem->typeName), branch.substituteClass);
+        out << indent << "const XsdQt::XmlErrorPath path(\"" << branch.name << "\");\n";
+        writeOccurrenceCount(out, occurrences, branch.elem, indent);
+        if (branch.elem->maxOccurs == -1 || branch.elem->maxOccurs > 1) {
+            out << indent << "auto item = " << read << ";\n";
+            out << indent << "if (item) {\n";
+            writeReserveHint(out, memberName, branch.elem, indent + "    ");
+            out << indent << "    " << memberName << ".append(std::move(item));\n";
+            out << indent << "}\n";
         } else {
-            // Single value
-            if (m_typeMapping.contains(elem->typeName)) {
-                if (cppType == "QString") {
-                    out << "                " << memberName << " = XsdQt::XmlHelpers::readElementText(reader);\n";
-                } else if (cppType == "int" || cppType.contains("int")) {
-                    out << "                " << memberName << " = XsdQt::XmlHelpers::readInt(reader);\n";
-                } else if (cppType == "double" || cppType == "float") {
-                    out << "                " << memberName << " = XsdQt::XmlHelpers::readDouble(reader);\n";
-                } else if (cppType == "bool") {
-                    out << "                " << memberName << " = XsdQt::XmlHelpers::readBool(reader);\n";
-                } else if (cppType == "QDateTime") {
-                    out << "                " << memberName << " = XsdQt::XmlHelpers::readDateTime(reader);\n";
-                } else if (cppType == "QDate") {
-                    out << "                " << memberName << " = XsdQt::XmlHelpers::readDate(reader);\n";
-                } else if (cppType == "QTime") {
-                    out << "                " << memberName << " = XsdQt::XmlHelpers::readTime(reader);\n";
-                }
-            } else {
-                out << "                " << memberName << " = XsdQt::XmlHelpers::readPolymorphicElement(reader, \"" << elem->name << "\").dynamicCast<" << cppType << ">();\n";
-            }
+            out << indent << memberName << " = " << read << ";\n";
         }
-        
-        out << "            }\n";
-        first = false;
-    }
+    };
     
-    if (!type->elements.isEmpty()) {
-        out << "            else {\n";
+    // Undeclared children are skipped, and with --validate reported first
+    auto writeUnexpected = [&]() {
+        if (m_validation) {
+            const QString expected = names.isEmpty() ? QString("no child elements") : names.join(" | ");
+            out << "                if (!XsdQt::XmlErrorCollector::report(reader, XsdQt::XmlParseError::UnexpectedElement, nullptr,\n";
+            out << "                                                      \"" << escaped(expected) << "\", "
+                << (readerType == "QXmlStreamReader" ? "name" : "name.toString()") << ")) {\n";
+            out << "                    return false;\n";
+            out << "                }\n";
+        }
         out << "                XsdQt::XmlHelpers::skipCurrentElement(reader);\n";
+    };
+    
+    if (predicted) {
+        out << "            // Expected next child of the sequence first\n";
+        out << "            int field = -1;\n";
+        out << "            switch (next) {\n";
+        for (int i = 0; i < branches.size(); ++i) {
+            out << "            case " << i << ": field = name == \"" << branches.at(i).name << "\" ? " << i << " : -1; break;\n";
+        }
+        out << "            default: break;\n";
+        out << "            }\n";
+        out << "            if (field < 0) {\n";
+        for (int i = 0; i < branches.size(); ++i) {
+            out << "                " << (i ? "else " : "") << "if (name == \"" << branches.at(i).name << "\") field = " << i << ";\n";
+        }
+        out << "            }\n\n";
+        out << "            switch (field) {\n";
+        for (int i = 0; i < branches.size(); ++i) {
+            out << "            case " << i << ": {\n";
+            writeBranch(branches.at(i));
+            out << "                next = " << branches.at(i).next << ";\n";
+            out << "                break;\n";
+            out << "            }\n";
+        }
+        out << "            default:\n";
+        writeUnexpected();
+        out << "                break;\n";
+        out << "            }\n";
+    } else {
+        // Generate if-else chain for each element
+        for (int i = 0; i < branches.size(); ++i) {
+            out << "            " << (i ? "else " : "") << "if (name == \"" << branches.at(i).name << "\") {\n";
+            writeBranch(branches.at(i));
+            out << "            }\n";
+        }
+        out << "            " << (branches.isEmpty() ? "{\n" : "else {\n");
+        writeUnexpected();
         out << "            }\n";
     }
     
     out << "        }\n";
     out << "    }\n\n";
+    if (!occurrences.minimum.isEmpty() || !occurrences.maximum.isEmpty()) {
+        writeOccurrenceChecks(out, occurrences);
+    }
+    
+    // A required choice needs one of its alternatives
+    QList<QSharedPointer<XsdType>> owners;
+    for (const auto& elem : elements) {
+        const QSharedPointer<XsdType> owner = ownerOf(type, elem);
+        if (m_validation && !owners.contains(owner) && isChoiceUnion(owner) && owner->compositorMinOccurs > 0) {
+            QStringList alternatives;
+            for (const auto& alternative : owner->elements) {
+                alternatives.append(alternative->name);
+            }
+            out << "    if (!reader.hasError() && " << choiceMember(owner) << ".isEmpty()\n";
+            out << "        && !XsdQt::XmlErrorCollector::report(reader, XsdQt::XmlParseError::Occurrences, nullptr, \"one of "
+                << escaped(alternatives.join(" | ")) << "\", \"0\")) {\n";
+            out << "        return false;\n";
+            out << "    }\n\n";
+        }
+        owners.append(owner);
+    }
     out << "    return true;\n";
     out << "}\n\n";
 }
 
-void CodeGenerator::writeRegistration(QTextStream& out, const QString& className, const QString& elementName, const QString& typeName) {
+void CodeGenerator::writeSimpleElementRead(QTextStream& out, const QSharedPointer<XsdType>& type,
+                                           const QSharedPointer<XsdElement>& elem) const {
+    const QString memberName = memberWrite(type, elem);
+    const QString cppType = toCppTypeName(elem->typeName);
+    const bool isList = elem->maxOccurs == -1 || elem->maxOccurs > 1;
+    const QString validator = validatorFor(elem->typeName);
+    const QString indent = "                ";
+    const QString present = presenceSet(type, elem);
+    QString store = isList ? memberName + ".append(%1);" : memberName + " = %1;";
+    if (!present.isEmpty()) {
+        store += "\n" + indent + present;
+    }
+    if (isList) {
+        writeReserveHint(out, memberName, elem, indent);
+    }
+    
+    // Text needs no conversion; everything else reports text that does
+    // not convert, enumerations only when validating
+    QString read;
+    if (cppType == "QString") {
+        read = QString("XsdQt::XmlHelpers::%1(reader)").arg(isInterned(type, elem) ? "readInternedText" : "readElementText");
+        if (validator.isEmpty()) {
+            out << indent << store.arg(read) << "\n";
+            return;
+        }
+        out << indent << "const QString value = " << read << ";\n";
+    } else {
+        if (isEnum(cppType)) {
+            // Lists have no member to fall back on
+            const QString fallback = isList ? cppType + "()" : memberRead(type, elem);
+            if (!m_validation) {
+                out << indent << store.arg(QString("XsdQt::XmlHelpers::readEnum(reader, %1)").arg(fallback)) << "\n";
+                return;
+            }
+            read = QString("XsdQt::XmlHelpers::readEnum(reader, %1, &ok, &text)").arg(fallback);
+        } else if (cppType == "int" || cppType.contains("int")) {
+            read = "XsdQt::XmlHelpers::read" + integerConversion(cppType) + "(reader, &ok, &text)";
+            if (isNarrowInteger(cppType)) {
+                read = "XsdQt::XmlHelpers::narrowed<" + cppType + ">(" + read + ", " + cppType + "(), &ok, &text)";
+            }
+        } else if (cppType == "double" || cppType == "float") {
+            read = "XsdQt::XmlHelpers::readDouble(reader, &ok, &text)";
+        } else if (cppType == "bool") {
+            read = "XsdQt::XmlHelpers::readBool(reader, &ok, &text)";
+        } else if (cppType == "QDateTime") {
+            read = "XsdQt::XmlHelpers::readDateTime(reader, &ok, &text)";
+        } else if (cppType == "QDate") {
+            read = "XsdQt::XmlHelpers::readDate(reader, &ok, &text)";
+        } else if (cppType == "QTime") {
+            read = "XsdQt::XmlHelpers::readTime(reader, &ok, &text)";
+        } else {
+            out << indent << "XsdQt::XmlHelpers::skipCurrentElement(reader);\n";
+            return;
+        }
+        out << indent << "bool ok = false;\n";
+        out << indent << "QString text;\n";
+        out << indent << "const " << cppType << " value = " << read << ";\n";
+        out << indent << "if (!ok && !XsdQt::XmlErrorCollector::" << conversionReport() << "(reader, XsdQt::XmlParseError::InvalidValue, \""
+            << elem->name << "\", \"" << escaped(elem->typeName) << "\", text)) {\n";
+        out << indent << "    return false;\n";
+        out << indent << "}\n";
+    }
+    
+    if (!validator.isEmpty()) {
+        out << indent << "const char* expected = nullptr;\n";
+        out << indent << "if (" << (cppType == "QString" ? "" : "ok && ") << "!" << validator << "(value, &expected)\n";
+        out << indent << "    && !XsdQt::XmlErrorCollector::report(reader, XsdQt::XmlParseError::InvalidValue, \""
+            << elem->name << "\", expected, " << valueText(cppType, "value") << ")) {\n";
+        out << indent << "    return false;\n";
+        out << indent << "}\n";
+    }
+    out << indent << store.arg("value") << "\n";
+}
+
+void CodeGenerator::writeAttributeBinding(QTextStream& out, const QList<QSharedPointer<XsdAttribute>>& attributes,
+                                          const QString& readerType, const Occurrences& occurrences) const {
+    // Absent attributes keep their defaults
+    QMap<quint32, QList<QSharedPointer<XsdAttribute>>> byHash;
+    for (const auto& attr : attributes) {
+        QString memberName = toCppMemberName(attr->name);
+        QString cppType = toCppTypeName(attr->typeName);
+        QString value;
+        
+        if (cppType == "QString") {
+            value = attr->defaultValue.isEmpty() ? "QString()" : "\"" + attr->defaultValue + "\"";
+        } else if (isEnum(cppType)) {
+            value = enumeratorFor(cppType, attr->defaultValue);
+        } else if (cppType == "bool") {
+            value = attr->defaultValue == "true" ? "true" : "false";
+        } else if (isBoundAttribute(cppType)) {
+            value = attr->defaultValue.isEmpty() ? "0" : attr->defaultValue;
+        } else {
+            continue;
+        }
+        
+        out << "    " << memberName << " = " << value << ";\n";
+        byHash[nameHash(attr->name)].append(attr);
+    }
+    
+    out << "    const XsdQt::XmlAttributeBinder<" << readerType << "> attributes(reader);\n";
+    out << "    for (int i = 0; i < attributes.count(); ++i) {\n";
+    out << "        switch (attributes.nameHash(i)) {\n";
+    for (auto it = byHash.constBegin(); it != byHash.constEnd(); ++it) {
+        // Colliding names share a case and are told apart by nameIs()
+        out << "        case XsdQt::xmlNameHash(\"" << it.value().first()->name << "\"):\n";
+        bool first = true;
+        for (const auto& attr : it.value()) {
+            QString memberName = toCppMemberName(attr->name);
+            QString cppType = toCppTypeName(attr->typeName);
+            const QString validator = validatorFor(attr->typeName);
+            const bool checked = cppType != "QString" && (!isEnum(cppType) || m_validation);
+            QString read;
+            
+            if (cppType == "QString") {
+                read = "attributes.text(i)";
+            } else if (isEnum(cppType)) {
+                read = "attributes.toEnum(i, " + memberName + (checked ? ", &ok)" : ")");
+            } else if (cppType == "bool") {
+                read = "attributes.toBool(i, " + memberName + ", &ok)";
+            } else if (cppType == "double" || cppType == "float") {
+                read = "attributes.toDouble(i, " + memberName + ", &ok)";
+            } else {
+                read = "attributes.to" + integerConversion(cppType) + "(i, " + memberName + ", &ok)";
+                if (isNarrowInteger(cppType)) {
+                    read = "XsdQt::XmlHelpers::narrowed<" + cppType + ">(" + read + ", " + memberName + ", &ok)";
+                }
+            }
+            
+            out << "            " << (first ? "" : "else ") << "if (attributes.nameIs(i, \"" << attr->name << "\")) {\n";
+            if (occurrences.bits.contains("@" + attr->name)) {
+                out << "                " << occurrences.set(occurrences.bits.value("@" + attr->name)) << "\n";
+            }
+            if (checked) {
+                out << "                bool ok = false;\n";
+            }
+            out << "                " << memberName << " = " << read << ";\n";
+            if (checked) {
+                out << "                if (!ok && !XsdQt::XmlErrorCollector::" << conversionReport()
+                    << "(reader, XsdQt::XmlParseError::InvalidValue, \"@"
+                    << attr->name << "\", \"" << escaped(attr->typeName) << "\", attributes.text(i))) {\n";
+                out << "                    return false;\n";
+                out << "                }\n";
+            }
+            if (!validator.isEmpty()) {
+                out << "                const char* expected = nullptr;\n";
+                out << "                if (" << (checked ? "ok && " : "") << "!" << validator << "(" << memberName << ", &expected)\n";
+                out << "                    && !XsdQt::XmlErrorCollector::report(reader, XsdQt::XmlParseError::InvalidValue, \"@"
+                    << attr->name << "\", expected, attributes.text(i))) {\n";
+                out << "                    return false;\n";
+                out << "                }\n";
+            }
+            out << "            }\n";
+            first = false;
+        }
+        out << "            break;\n";
+    }
+    out << "        default:\n";
+    out << "            break;\n";
+    out << "        }\n";
+    out << "    }\n\n";
+}
+
+quint32 CodeGenerator::nameHash(const QString& name, quint32 seed) {
+    // Must match XsdQt::xmlNameHash (FNV-1a over UTF-8)
+    quint32 hash = 2166136261u ^ seed;
+    for (char byte : name.toUtf8()) {
+        hash = (hash ^ quint8(byte)) * 16777619u;
+    }
+    return hash;
+}
+
+void CodeGenerator::writeTypeNames(QTextStream& out, const QString& className, const QString& elementName, const QString& typeName) const {
     out << "QString " << className << "::xmlElementName() const {\n";
     out << "    return \"" << elementName << "\";\n";
     out << "}\n\n";
@@ -544,9 +1980,399 @@ void CodeGenerator::writeRegistration(QTextStream& out, const QString& className
     out << "QString " << className << "::xsdTypeName() const {\n";
     out << "    return \"" << typeName << "\";\n";
     out << "}\n\n";
+}
+
+QList<QPair<QString, QString>> CodeGenerator::substitutesFor(const QSharedPointer<XsdElement>& elem) const {
+    // (element name, class) pairs; members only for references to a
+    // global element, a local element of the same name is not a head
+    QList<QPair<QString, QString>> result;
+    if (!elem->isAbstract && !elem->typeName.isEmpty()) {
+        result.append(qMakePair(elem->name, toCppTypeName(elem->typeName)));
+    }
     
-    out << "// Static registration\n";
-    out << "static XsdQt::XmlTypeRegistrar<" << className << "> registrar_" << className << "(\"" << elementName << "\", \"" << typeName << "\");\n\n";
+    if (!elem->refName.isEmpty()) {
+        for (const QString& member : m_schema->substitutionGroups.value(elem->name)) {
+            QSharedPointer<XsdElement> global = m_schema->elements.value(member);
+            if (!global || global->isAbstract || (global->typeName.isEmpty() && !global->inlineType)) {
+                continue;
+            }
+            QString memberClass = global->inlineType ? toCppClassName(member) : toCppTypeName(global->typeName);
+            result.append(qMakePair(member, memberClass));
+        }
+    }
+    
+    return result;
+}
+
+bool CodeGenerator::isInterned(const QSharedPointer<XsdType>& type, const QSharedPointer<XsdElement>& elem) const {
+    if (elem->intern || m_internedFields.contains(elem->name)) {
+        return true;
+    }
+    // "Type.element" also names the element in types derived from Type
+    QSharedPointer<XsdType> current = type;
+    for (int depth = 0; current && depth < 32; ++depth) {
+        if (m_internedFields.contains(current->name + "." + elem->name)) {
+            return true;
+        }
+        current = current->baseTypeName.isEmpty() ? QSharedPointer<XsdType>() : findType(localTypeName(current->baseTypeName));
+    }
+    return false;
+}
+
+QList<QSharedPointer<XsdElement>> CodeGenerator::allElements(const QSharedPointer<XsdType>& type) const {
+    // Base elements first, as they appear in the instance; a restriction
+    // redeclaring an element replaces the inherited one
+    QList<QSharedPointer<XsdElement>> result = type->elements;
+    QSet<QString> seen;
+    for (const auto& elem : result) {
+        seen.insert(elem->name);
+    }
+    QSharedPointer<XsdType> base = type;
+    for (int depth = 0; depth < 32; ++depth) {
+        base = base->baseTypeName.isEmpty() ? QSharedPointer<XsdType>() : findType(localTypeName(base->baseTypeName));
+        if (!base || base->kind != XsdTypeKind::ComplexType) {
+            break;
+        }
+        QList<QSharedPointer<XsdElement>> inherited;
+        for (const auto& elem : base->elements) {
+            if (!seen.contains(elem->name)) {
+                seen.insert(elem->name);
+                inherited.append(elem);
+            }
+        }
+        result = inherited + result;
+    }
+    return result;
+}
+
+QList<QSharedPointer<XsdAttribute>> CodeGenerator::allAttributes(const QSharedPointer<XsdType>& type) const {
+    QList<QSharedPointer<XsdAttribute>> result = type->attributes;
+    QSet<QString> seen;
+    for (const auto& attr : result) {
+        seen.insert(attr->name);
+    }
+    QSharedPointer<XsdType> base = type;
+    for (int depth = 0; depth < 32; ++depth) {
+        base = base->baseTypeName.isEmpty() ? QSharedPointer<XsdType>() : findType(localTypeName(base->baseTypeName));
+        if (!base || base->kind != XsdTypeKind::ComplexType) {
+            break;
+        }
+        QList<QSharedPointer<XsdAttribute>> inherited;
+        for (const auto& attr : base->attributes) {
+            if (!seen.contains(attr->name)) {
+                seen.insert(attr->name);
+                inherited.append(attr);
+            }
+        }
+        result = inherited + result;
+    }
+    return result;
+}
+
+QString CodeGenerator::localTypeName(const QString& typeName) {
+    return typeName.mid(typeName.indexOf(':') + 1);
+}
+
+QString CodeGenerator::valueText(const QString& cppType, const QString& variable) {
+    // Expression formatting a value for an error message
+    if (cppType == "QString") {
+        return variable;
+    }
+    if (cppType == "QDateTime" || cppType == "QDate" || cppType == "QTime") {
+        return variable + ".toString(Qt::ISODate)";
+    }
+    return "QString::number(" + variable + ")";
+}
+
+QString CodeGenerator::conversionReport() const {
+    // Values that don't convert fail the document only with --validate;
+    // otherwise they go to an installed collector and are read leniently
+    return m_validation ? "report" : "reportIfCollecting";
+}
+
+QString CodeGenerator::integerConversion(const QString& cppType) {
+    // Suffix of the XmlHelpers::read*/XmlAttributeBinder::to* conversion wide
+    // enough for an integer type; narrower types are range-checked from it
+    if (cppType == "qint64") {
+        return "Int64";
+    }
+    if (cppType == "quint32" || cppType == "quint64") {
+        return "UInt64";
+    }
+    return "Int";
+}
+
+bool CodeGenerator::isNarrowInteger(const QString& cppType) {
+    // Read through integerConversion() and range-checked by XmlHelpers::narrowed()
+    return cppType == "qint8" || cppType == "qint16" || cppType == "quint8"
+        || cppType == "quint16" || cppType == "quint32";
+}
+
+QString CodeGenerator::Occurrences::test(int bit) const {
+    return "(" + bitOperation("seen", bit, bitCount, "&") + ")";
+}
+
+QString CodeGenerator::Occurrences::set(int bit) const {
+    return bitOperation("seen", bit, bitCount, "|=") + ";";
+}
+
+QString CodeGenerator::bitsDeclaration(const QString& name, int bitCount) {
+    // One word up to 64 bits, else an array of words
+    if (bitCount <= 32) {
+        return "quint32 " + name + " = 0";
+    }
+    if (bitCount <= 64) {
+        return "quint64 " + name + " = 0";
+    }
+    return QString("quint64 %1[%2] = {}").arg(name).arg((bitCount + 63) / 64);
+}
+
+QString CodeGenerator::bitOperation(const QString& bits, int bit, int bitCount, const char* op) {
+    // e.g. "seen & 0x4u", "seen[1] |= 0x1ull" or "m_present &= ~0x2u"
+    const QString word = bitCount <= 64 ? bits : QString("%1[%2]").arg(bits).arg(bit / 64);
+    const QString mask = bitCount <= 32 ? QString("0x%1u").arg(quint32(1) << bit, 0, 16)
+                                        : QString("0x%1ull").arg(quint64(1) << (bit % 64), 0, 16);
+    const QString operation = QString::fromLatin1(op);
+    return word + " " + operation + (operation.endsWith('~') ? "" : " ") + mask;
+}
+
+QSharedPointer<XsdType> CodeGenerator::ownerOf(const QSharedPointer<XsdType>& type, const QSharedPointer<XsdElement>& elem) const {
+    QSharedPointer<XsdType> current = type;
+    for (int depth = 0; current && depth < 32; ++depth) {
+        if (current->elements.contains(elem)) {
+            return current;
+        }
+        current = current->baseTypeName.isEmpty() ? QSharedPointer<XsdType>() : findType(localTypeName(current->baseTypeName));
+    }
+    return type;
+}
+
+bool CodeGenerator::isChoiceUnion(const QSharedPointer<XsdType>& owner) {
+    // A single xs:choice of elements keeps its alternatives in one XmlChoice
+    return owner && owner->compositor == "choice" && owner->compositorMaxOccurs == 1
+        && !owner->nestedGroups && !owner->elements.isEmpty();
+}
+
+QString CodeGenerator::choiceMember(const QSharedPointer<XsdType>& owner) const {
+    // Named after the type, so a derived class's choice does not hide its base's
+    return toCppMemberName(toCppClassName(owner->name)) + "Choice";
+}
+
+QList<QSharedPointer<XsdElement>> CodeGenerator::presenceElements(const QSharedPointer<XsdType>& owner) const {
+    // Optional scalars, in one bitmask per class; complex ones are null
+    // when absent and the alternatives of a choice have its index
+    QList<QSharedPointer<XsdElement>> result;
+    if (isChoiceUnion(owner)) {
+        return result;
+    }
+    for (const auto& elem : owner->elements) {
+        if (elem->minOccurs == 0 && elem->maxOccurs == 1 && isSimpleType(elem->typeName)) {
+            result.append(elem);
+        }
+    }
+    return result;
+}
+
+QString CodeGenerator::presenceMember(const QSharedPointer<XsdType>& owner) const {
+    return toCppMemberName(toCppClassName(owner->name)) + "Present";
+}
+
+void CodeGenerator::writeReserveHint(QTextStream& out, const QString& member, const QSharedPointer<XsdElement>& elem,
+                                     const QString& indent) const {
+    // A bounded list is sized once, on its first item
+    if (elem->maxOccurs > 1) {
+        out << indent << "if (" << member << ".isEmpty()) {\n";
+        out << indent << "    " << member << ".reserve(" << qMin(elem->maxOccurs, 1024) << ");\n";
+        out << indent << "}\n";
+    }
+}
+
+QString CodeGenerator::storageType(const QSharedPointer<XsdElement>& elem) const {
+    const QString cppType = toCppTypeName(elem->typeName);
+    const QString item = isSimpleType(elem->typeName) ? cppType : "QSharedPointer<" + cppType + ">";
+    // Contiguous, unlike a QList of items larger than a pointer
+    return elem->maxOccurs == -1 || elem->maxOccurs > 1 ? "QVector<" + item + ">" : item;
+}
+
+QString CodeGenerator::memberRead(const QSharedPointer<XsdType>& type, const QSharedPointer<XsdElement>& elem) const {
+    const QSharedPointer<XsdType> owner = ownerOf(type, elem);
+    if (isChoiceUnion(owner)) {
+        return QString("%1.value<%2>()").arg(choiceMember(owner)).arg(owner->elements.indexOf(elem));
+    }
+    return toCppMemberName(elem->name);
+}
+
+QString CodeGenerator::memberWrite(const QSharedPointer<XsdType>& type, const QSharedPointer<XsdElement>& elem) const {
+    // Selecting an alternative of a choice makes it the active one
+    const QSharedPointer<XsdType> owner = ownerOf(type, elem);
+    if (isChoiceUnion(owner)) {
+        return QString("%1.select<%2>()").arg(choiceMember(owner)).arg(owner->elements.indexOf(elem));
+    }
+    return toCppMemberName(elem->name);
+}
+
+QString CodeGenerator::presenceTest(const QSharedPointer<XsdType>& type, const QSharedPointer<XsdElement>& elem) const {
+    const QSharedPointer<XsdType> owner = ownerOf(type, elem);
+    const QList<QSharedPointer<XsdElement>> present = presenceElements(owner);
+    const int bit = present.indexOf(elem);
+    return bit < 0 ? QString() : "(" + bitOperation(presenceMember(owner), bit, present.size(), "&") + ")";
+}
+
+QString CodeGenerator::presenceSet(const QSharedPointer<XsdType>& type, const QSharedPointer<XsdElement>& elem) const {
+    const QSharedPointer<XsdType> owner = ownerOf(type, elem);
+    const QList<QSharedPointer<XsdElement>> present = presenceElements(owner);
+    const int bit = present.indexOf(elem);
+    return bit < 0 ? QString() : bitOperation(presenceMember(owner), bit, present.size(), "|=") + ";";
+}
+
+QString CodeGenerator::presenceClear(const QSharedPointer<XsdType>& type, const QSharedPointer<XsdElement>& elem) const {
+    const QSharedPointer<XsdType> owner = ownerOf(type, elem);
+    const QList<QSharedPointer<XsdElement>> present = presenceElements(owner);
+    const int bit = present.indexOf(elem);
+    return bit < 0 ? QString() : bitOperation(presenceMember(owner), bit, present.size(), "&= ~") + ";";
+}
+
+bool CodeGenerator::isBoundAttribute(const QString& cppType) const {
+    // Types XmlAttributeBinder converts; other attributes are not read
+    return cppType == "QString" || isEnum(cppType) || cppType == "bool"
+        || cppType.contains("int") || cppType == "double" || cppType == "float";
+}
+
+bool CodeGenerator::isSequence(const QSharedPointer<XsdType>& type) const {
+    // Extensions append their sequence to the base content
+    QSharedPointer<XsdType> current = type;
+    for (int depth = 0; current && depth < 32; ++depth) {
+        if (current->compositor == "choice" || current->compositor == "all") {
+            return false;
+        }
+        current = current->baseTypeName.isEmpty() ? QSharedPointer<XsdType>() : findType(localTypeName(current->baseTypeName));
+    }
+    return true;
+}
+
+bool CodeGenerator::isChoiceMember(const QSharedPointer<XsdType>& type, const QSharedPointer<XsdElement>& elem) const {
+    QSharedPointer<XsdType> current = type;
+    for (int depth = 0; current && depth < 32; ++depth) {
+        if (current->elements.contains(elem)) {
+            return current->compositor == "choice";
+        }
+        current = current->baseTypeName.isEmpty() ? QSharedPointer<XsdType>() : findType(localTypeName(current->baseTypeName));
+    }
+    return false;
+}
+
+CodeGenerator::Occurrences CodeGenerator::occurrencesOf(const QSharedPointer<XsdType>& type) const {
+    Occurrences occurrences;
+    if (!m_validation) {
+        return occurrences;
+    }
+    
+    for (const auto& attr : allAttributes(type)) {
+        if (attr->isRequired && isBoundAttribute(toCppTypeName(attr->typeName))) {
+            occurrences.bits.insert("@" + attr->name, occurrences.bitCount++);
+            occurrences.minimum.insert("@" + attr->name, 1);
+        }
+    }
+    for (const auto& elem : allElements(type)) {
+        // Alternatives of a choice are each optional
+        const int minOccurs = isChoiceMember(type, elem) ? 0 : elem->minOccurs;
+        if (elem->maxOccurs == 1 || (elem->maxOccurs == -1 && minOccurs == 1)) {
+            occurrences.bits.insert(elem->name, occurrences.bitCount++);
+        } else if (elem->maxOccurs > 1 || minOccurs > 1) {
+            occurrences.counters.insert(elem->name, toCppMemberName(elem->name).mid(2) + "Count");
+        }
+        if (minOccurs > 0) {
+            occurrences.minimum.insert(elem->name, minOccurs);
+        }
+        if (elem->maxOccurs > 0) {
+            occurrences.maximum.insert(elem->name, elem->maxOccurs);
+        }
+    }
+    return occurrences;
+}
+
+void CodeGenerator::writeOccurrenceCount(QTextStream& out, const Occurrences& occurrences,
+                                         const QSharedPointer<XsdElement>& elem, const QString& indent) const {
+    if (occurrences.bits.contains(elem->name)) {
+        const int bit = occurrences.bits.value(elem->name);
+        // A second single element is reported where it starts
+        if (elem->maxOccurs == 1) {
+            out << indent << "if (" << occurrences.test(bit) << " && !XsdQt::XmlErrorCollector::report(reader, "
+                << "XsdQt::XmlParseError::Occurrences, \"" << elem->name << "\", \"at most 1\", \"2\")) {\n";
+            out << indent << "    return false;\n";
+            out << indent << "}\n";
+        }
+        out << indent << occurrences.set(bit) << "\n";
+    } else if (occurrences.counters.contains(elem->name)) {
+        out << indent << "++" << occurrences.counters.value(elem->name) << ";\n";
+    }
+}
+
+void CodeGenerator::writeOccurrenceChecks(QTextStream& out, const Occurrences& occurrences) const {
+    // Missing content is not reported for a document that ended early
+    out << "    // Required and bounded content, checked once the element is complete\n";
+    out << "    if (!reader.hasError()) {\n";
+    
+    // Bits of required content, so the common case is one comparison per word
+    QVector<quint64> required((occurrences.bitCount + 63) / 64, 0);
+    for (auto it = occurrences.bits.constBegin(); it != occurrences.bits.constEnd(); ++it) {
+        if (occurrences.minimum.contains(it.key())) {
+            required[it.value() / 64] |= quint64(1) << (it.value() % 64);
+        }
+    }
+    QStringList incomplete;
+    for (int word = 0; word < required.size(); ++word) {
+        if (!required.at(word)) {
+            continue;
+        }
+        const QString mask = QString("0x%1%2").arg(required.at(word), 0, 16).arg(occurrences.bitCount <= 32 ? "u" : "ull");
+        const QString seen = occurrences.bitCount <= 64 ? QString("seen") : QString("seen[%1]").arg(word);
+        incomplete.append(QString("(%1 & %2) != %2").arg(seen, mask));
+    }
+    if (!incomplete.isEmpty()) {
+        out << "        if (" << incomplete.join(" || ") << ") {\n";
+        for (auto it = occurrences.bits.constBegin(); it != occurrences.bits.constEnd(); ++it) {
+            if (!occurrences.minimum.contains(it.key())) {
+                continue;
+            }
+            out << "            if (!" << occurrences.test(it.value()) << "\n";
+            out << "                && !XsdQt::XmlErrorCollector::report(reader, XsdQt::XmlParseError::Occurrences, \""
+                << it.key() << "\", \"at least 1\", \"0\")) {\n";
+            out << "                return false;\n";
+            out << "            }\n";
+        }
+        out << "        }\n";
+    }
+    
+    for (auto it = occurrences.counters.constBegin(); it != occurrences.counters.constEnd(); ++it) {
+        const QString found = "QString::number(" + it.value() + ")";
+        if (occurrences.minimum.contains(it.key())) {
+            const QString minimum = QString::number(occurrences.minimum.value(it.key()));
+            out << "        if (" << it.value() << " < " << minimum
+                << " && !XsdQt::XmlErrorCollector::report(reader, XsdQt::XmlParseError::Occurrences, \""
+                << it.key() << "\", \"at least " << minimum << "\", " << found << ")) {\n";
+            out << "            return false;\n";
+            out << "        }\n";
+        }
+        if (occurrences.maximum.contains(it.key())) {
+            const QString maximum = QString::number(occurrences.maximum.value(it.key()));
+            out << "        if (" << it.value() << " > " << maximum
+                << " && !XsdQt::XmlErrorCollector::report(reader, XsdQt::XmlParseError::Occurrences, \""
+                << it.key() << "\", \"at most " << maximum << "\", " << found << ")) {\n";
+            out << "            return false;\n";
+            out << "        }\n";
+        }
+    }
+    out << "    }\n\n";
+}
+
+QString CodeGenerator::elementNameFor(const QString& className) const {
+    QString elementName = m_elementNames.value(className);
+    if (elementName.isEmpty()) {
+        elementName = className;
+        elementName[0] = elementName[0].toLower();
+    }
+    return elementName;
 }
 
 } // namespace XsdGen
@@ -2,8 +2,14 @@
 #define CODEGENERATOR_H
 
 #include "XsdParser.h"
+#include <QByteArray>
+#include <QHash>
+#include <QPair>
+#include <QSet>
 #include <QString>
+#include <QStringList>
 #include <QTextStream>
+#include <QVector>
 
 namespace XsdGen {
 
@@ -21,33 +27,254 @@ public:
      */
     void setNamespace(const QString& ns) { m_namespace = ns; }
     
+    /**
+     * Also generate toXml(XsdQt::XmlUtf8Writer&) for the direct UTF-8 writer
+     */
+    void setUtf8Writer(bool enabled) { m_utf8Writer = enabled; }
+    
+    /**
+     * Also generate fromXml(XsdQt::XmlFastReader&) for the UTF-8 fast reader
+     */
+    void setFastReader(bool enabled) { m_fastReader = enabled; }
+    
+    /**
+     * Worker threads emitting files, 0 means QThread::idealThreadCount()
+     */
+    void setThreadCount(int count) { m_threadCount = count; }
+    
+    /**
+     * Record the generated files and their hashes in MANIFEST_FILE in the
+     * output directory; files listed by the previous run but no longer
+     * generated are deleted
+     */
+    void setManifest(bool enabled) { m_manifest = enabled; }
+    
+    /**
+     * Outcome of the last generate(): files whose content changed (or
+     * are new), files left untouched and stale files removed
+     */
+    int filesWritten() const { return m_filesWritten; }
+    int filesUnchanged() const { return m_filesUnchanged; }
+    int filesRemoved() const { return m_filesRemoved; }
+    
+    /**
+     * Unity build: emit the implementations into this many amalgamated
+     * translation units plus an umbrella header including every class
+     * header; 0 (default) writes one .cpp per class
+     */
+    void setUnityUnits(int units) { m_unityUnits = units; }
+    
+    /**
+     * Fields read through XsdQt::XmlHelpers::readInternedText, as
+     * "TypeName.element" or just "element" for every type; adds to the
+     * fields marked xsdqt:intern="true" in the schema
+     */
+    void setInternedFields(const QStringList& fields) { m_internedFields = QSet<QString>::fromList(fields); }
+    
+    /**
+     * Check simple type facets (pattern, length, ranges) and enumeration
+     * values in generated fromXml; a violation raises a reader error
+     */
+    void setValidation(bool enabled) { m_validation = enabled; }
+    
+    /**
+     * Also generate a columnar view of every repeated complex element
+     * (e.g. FleetTypeVehicleColumns), filled from the object graph
+     */
+    void setColumns(bool enabled) { m_columns = enabled; }
+    
+    /**
+     * Names of the umbrella header and the i-th unit for the current namespace
+     */
+    QString unityHeaderName() const { return m_namespace + "All.h"; }
+    QString unityUnitName(int index) const { return QString("%1Unit%2.cpp").arg(m_namespace).arg(index); }
+    
+    /**
+     * Files declaring and defining registerAllTypes() for the current namespace
+     */
+    QString registryHeaderName() const { return m_namespace + "Registry.h"; }
+    QString registrySourceName() const { return m_namespace + "Registry.cpp"; }
+    
+    /**
+     * Header of the facet validators, written when validation is enabled
+     */
+    QString facetsHeaderName() const { return m_namespace + "Facets.h"; }
+    
+    /**
+     * Files of the columnar views, written when columns are enabled
+     */
+    QString columnsHeaderName() const { return m_namespace + "Columns.h"; }
+    QString columnsSourceName() const { return m_namespace + "Columns.cpp"; }
+    
+    static const char* const MANIFEST_FILE;
+    
 private:
-    QString toCppTypeName(const QString& xsdType);
-    QString toCppClassName(const QString& name);
-    QString toCppMemberName(const QString& name);
-    QString getIncludeGuard(const QString& className);
+    /**
+     * One class to emit (.h and .cpp)
+     */
+    struct Job {
+        QString className;
+        QSharedPointer<XsdType> type;
+        bool fromElement;   // inline type of a global element
+    };
+    
+    struct OutputFile {
+        QString fileName;   // relative to the output directory
+        QByteArray hash;
+        bool written;
+    };
+    
+    struct JobResult {
+        QString errorMsg;
+        QVector<OutputFile> files;
+        QString implementation; // unity mode: body for the amalgamated unit
+    };
+    
+    /**
+     * Facets of a simple type merged along its restriction chain; every
+     * pattern must match, bounds come from the most derived type
+     */
+    struct Facets {
+        QStringList patterns;
+        int minLength = -1;
+        int maxLength = -1;
+        QString minInclusive;
+        QString maxInclusive;
+        QString minExclusive;
+        QString maxExclusive;
+    };
+    
+    /**
+     * Occurrence checks of one class's fromXml (--validate): one bit of
+     * "seen" per single or required child and required attribute, and a
+     * counter per child with bounded maxOccurs or minOccurs above one
+     */
+    struct Occurrences {
+        QMap<QString, int> bits;            // element name or "@attribute" -> bit
+        QMap<QString, QString> counters;    // element name -> counter variable
+        QMap<QString, int> minimum;         // required elements and attributes
+        QMap<QString, int> maximum;         // bounded elements
+        int bitCount = 0;
+        
+        QString test(int bit) const;
+        QString set(int bit) const;
+    };
+    
+    static QString bitsDeclaration(const QString& name, int bitCount);
+    static QString bitOperation(const QString& bits, int bit, int bitCount, const char* op);
+    
+    class Worker;
+    
+    bool generateJob(const Job& job, const QString& outputDir, JobResult* result) const;
+    bool writeFile(const QString& outputDir, const QString& fileName, const QString& content,
+                   JobResult* result) const;
+    
+    QStringList readManifest(const QString& outputDir) const;
+    bool writeManifest(const QString& outputDir, const QVector<JobResult>& results, QString* errorMsg) const;
+    
+    bool generateUnity(const QVector<Job>& jobs, const QVector<JobResult>& results, const QString& outputDir,
+                       JobResult* unity) const;
+    bool generateRegistry(const QVector<Job>& jobs, const QString& outputDir, JobResult* registry) const;
+    bool generateEnum(const QSharedPointer<XsdType>& type, const QString& outputDir, JobResult* result) const;
+    bool generateFacets(const QString& outputDir, JobResult* result) const;
+    bool generateColumns(const QVector<Job>& jobs, const QString& outputDir, JobResult* result) const;
+    QList<QSharedPointer<XsdElement>> columnFields(const QSharedPointer<XsdType>& type) const;
+    
+    void registerSimpleTypes();
+    QString simpleCppType(const QSharedPointer<XsdType>& type, int depth = 0) const;
+    bool isSimpleType(const QString& typeName) const;
+    bool isEnum(const QString& cppType) const { return m_enumClasses.contains(cppType); }
+    QStringList enumeratorNames(const QSharedPointer<XsdType>& type) const;
+    QString enumeratorFor(const QString& cppType, const QString& value) const;
+    static QVector<int> buildEnumTable(const QStringList& values, quint32* seed, int* bits);
+    static int hashSlot(quint32 hash, int bits);
+    Facets facetsOf(const QSharedPointer<XsdType>& type) const;
+    QString validatorFor(const QString& typeName) const;
+    bool usesValidators(const QSharedPointer<XsdType>& type) const;
+    void writeValidator(QTextStream& out, const QString& typeName, const QSharedPointer<XsdType>& type) const;
+    static QString escaped(QString value);
+    
+    QString toCppTypeName(const QString& xsdType) const;
+    QString toCppClassName(const QString& name) const;
+    QString toCppMemberName(const QString& name) const;
+    QString getIncludeGuard(const QString& className) const;
     
-    bool generateHeader(const QString& className, const QSharedPointer<XsdType>& type, const QString& outputDir);
-    bool generateImplementation(const QString& className, const QSharedPointer<XsdType>& type, const QString& outputDir);
+    bool generateHeader(const QString& className, const QSharedPointer<XsdType>& type, const QString& outputDir,
+                        JobResult* result) const;
+    bool generateImplementation(const QString& className, const QSharedPointer<XsdType>& type, const QString& outputDir,
+                                JobResult* result) const;
     
-    void writeHeaderIncludes(QTextStream& out);
-    void writeClassDeclaration(QTextStream& out, const QString& className, const QSharedPointer<XsdType>& type);
-    void writeMemberVariables(QTextStream& out, const QSharedPointer<XsdType>& type);
-    void writeGettersSetters(QTextStream& out, const QSharedPointer<XsdType>& type);
-    void writeSerializationMethods(QTextStream& out, const QString& className);
+    void writeHeaderIncludes(QTextStream& out) const;
+    void writeClassDeclaration(QTextStream& out, const QString& className, const QSharedPointer<XsdType>& type) const;
+    void writeMemberVariables(QTextStream& out, const QSharedPointer<XsdType>& type) const;
+    void writeGettersSetters(QTextStream& out, const QSharedPointer<XsdType>& type) const;
+    void writeSerializationMethods(QTextStream& out, const QString& className) const;
+    void writeBuilder(QTextStream& out, const QString& className, const QSharedPointer<XsdType>& type) const;
+    bool isMovable(const QString& typeName) const;
     
-    void writeImplementationIncludes(QTextStream& out, const QString& className);
-    void writeConstructor(QTextStream& out, const QString& className, const QSharedPointer<XsdType>& type);
-    void writeToXmlImplementation(QTextStream& out, const QString& className, const QSharedPointer<XsdType>& type);
-    void writeFromXmlImplementation(QTextStream& out, const QString& className, const QSharedPointer<XsdType>& type);
-    void writeRegistration(QTextStream& out, const QString& className, const QString& elementName, const QString& typeName);
+    void writeImplementationIncludes(QTextStream& out, const QString& className, const QSharedPointer<XsdType>& type) const;
+    void writeConstructor(QTextStream& out, const QString& className, const QSharedPointer<XsdType>& type) const;
+    void writeToXmlImplementation(QTextStream& out, const QString& className, const QSharedPointer<XsdType>& type) const;
+    void writeToXmlUtf8Implementation(QTextStream& out, const QString& className, const QSharedPointer<XsdType>& type) const;
+    void writeFromXmlImplementation(QTextStream& out, const QString& className, const QSharedPointer<XsdType>& type,
+                                    const QString& readerType) const;
+    void writeSimpleElementRead(QTextStream& out, const QSharedPointer<XsdType>& type,
+                                const QSharedPointer<XsdElement>& elem) const;
+    void writeAttributeBinding(QTextStream& out, const QList<QSharedPointer<XsdAttribute>>& attributes,
+                               const QString& readerType, const Occurrences& occurrences) const;
+    Occurrences occurrencesOf(const QSharedPointer<XsdType>& type) const;
+    bool isBoundAttribute(const QString& cppType) const;
+    bool isSequence(const QSharedPointer<XsdType>& type) const;
+    QSharedPointer<XsdType> ownerOf(const QSharedPointer<XsdType>& type, const QSharedPointer<XsdElement>& elem) const;
+    static bool isChoiceUnion(const QSharedPointer<XsdType>& owner);
+    QString choiceMember(const QSharedPointer<XsdType>& owner) const;
+    QList<QSharedPointer<XsdElement>> presenceElements(const QSharedPointer<XsdType>& owner) const;
+    QString presenceMember(const QSharedPointer<XsdType>& owner) const;
+    QString storageType(const QSharedPointer<XsdElement>& elem) const;
+    void writeReserveHint(QTextStream& out, const QString& member, const QSharedPointer<XsdElement>& elem,
+                          const QString& indent) const;
+    QString memberRead(const QSharedPointer<XsdType>& type, const QSharedPointer<XsdElement>& elem) const;
+    QString memberWrite(const QSharedPointer<XsdType>& type, const QSharedPointer<XsdElement>& elem) const;
+    QString presenceTest(const QSharedPointer<XsdType>& type, const QSharedPointer<XsdElement>& elem) const;
+    QString presenceSet(const QSharedPointer<XsdType>& type, const QSharedPointer<XsdElement>& elem) const;
+    QString presenceClear(const QSharedPointer<XsdType>& type, const QSharedPointer<XsdElement>& elem) const;
+    bool isChoiceMember(const QSharedPointer<XsdType>& type, const QSharedPointer<XsdElement>& elem) const;
+    void writeOccurrenceCount(QTextStream& out, const Occurrences& occurrences, const QSharedPointer<XsdElement>& elem,
+                              const QString& indent) const;
+    void writeOccurrenceChecks(QTextStream& out, const Occurrences& occurrences) const;
+    static quint32 nameHash(const QString& name, quint32 seed = 0);
+    void writeTypeNames(QTextStream& out, const QString& className, const QString& elementName, const QString& typeName) const;
+    QString elementNameFor(const QString& className) const;
+    bool isInterned(const QSharedPointer<XsdType>& type, const QSharedPointer<XsdElement>& elem) const;
+    QList<QSharedPointer<XsdElement>> allElements(const QSharedPointer<XsdType>& type) const;
+    QList<QSharedPointer<XsdAttribute>> allAttributes(const QSharedPointer<XsdType>& type) const;
+    static QString localTypeName(const QString& typeName);
+    static QString valueText(const QString& cppType, const QString& variable);
+    static QString integerConversion(const QString& cppType);
+    static bool isNarrowInteger(const QString& cppType);
+    QString conversionReport() const;
+    QList<QPair<QString, QString>> substitutesFor(const QSharedPointer<XsdElement>& elem) const;
     
-    QString getBaseClassName(const QString& baseTypeName);
-    QSharedPointer<XsdType> findType(const QString& typeName);
+    QString getBaseClassName(const QString& baseTypeName) const;
+    QSharedPointer<XsdType> findType(const QString& typeName) const;
     
     QSharedPointer<XsdSchema> m_schema;
     QString m_namespace;
+    bool m_utf8Writer;
+    bool m_fastReader;
+    int m_threadCount;
+    bool m_manifest;
+    bool m_validation;
+    bool m_columns;
+    int m_unityUnits;
+    int m_filesWritten;
+    int m_filesUnchanged;
+    int m_filesRemoved;
     QMap<QString, QString> m_typeMapping; // XSD type -> C++ type
+    QHash<QString, QString> m_elementNames; // class name -> global element name
+    QSet<QString> m_internedFields;
+    QMap<QString, QSharedPointer<XsdType>> m_enumClasses; // enum class name -> xs:enumeration simpleType
+    QMap<QString, QSharedPointer<XsdType>> m_facetTypes; // simpleType name -> restriction with facets
 };
 
 } // namespace XsdGen
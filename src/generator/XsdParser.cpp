@@ -93,24 +93,22 @@ bool XsdParser::parseSchema(QXmlStreamReader& reader) {
     }
     
     buildSubstitutionGroups();
+    resolveReferences();
     return !reader.hasError();
 }
 
 bool XsdParser::parseElement(QXmlStreamReader& reader, QSharedPointer<XsdElement>& element) {
     element->name = readAttribute(reader, "name");
     element->typeName = readAttribute(reader, "type");
+    element->refName = readAttribute(reader, "ref");
     element->substitutionGroup = readAttribute(reader, "substitutionGroup");
     element->minOccurs = readIntAttribute(reader, "minOccurs", 1);
     element->defaultValue = readAttribute(reader, "default");
     element->isNillable = readBoolAttribute(reader, "nillable", false);
     element->isAbstract = readBoolAttribute(reader, "abstract", false);
+    element->intern = reader.attributes().value(QLatin1String(XSDQT_NAMESPACE), QLatin1String("intern")) == QLatin1String("true");
     
-    QString maxOccursStr = readAttribute(reader, "maxOccurs", "1");
-    if (maxOccursStr == "unbounded") {
-        element->maxOccurs = -1;
-    } else {
-        element->maxOccurs = maxOccursStr.toInt();
-    }
+    element->maxOccurs = readMaxOccurs(reader);
     
     // Check for inline type definition
     while (!reader.atEnd()) {
@@ -154,18 +152,12 @@ bool XsdParser::parseComplexType(QXmlStreamReader& reader, QSharedPointer<XsdTyp
         if (reader.isStartElement()) {
             QString name = reader.name().toString();
             
-            if (name == "sequence") {
-                type->compositor = "sequence";
+            if (name == "sequence" || name == "all") {
                 parseSequence(reader, type);
             }
             else if (name == "choice") {
-                type->compositor = "choice";
                 parseChoice(reader, type);
             }
-            else if (name == "all") {
-                type->compositor = "all";
-                parseSequence(reader, type); // Same parsing logic
-            }
             else if (name == "attribute") {
                 QSharedPointer<XsdAttribute> attr(new XsdAttribute);
                 if (parseAttribute(reader, attr)) {
@@ -224,7 +216,11 @@ bool XsdParser::parseSimpleType(QXmlStreamReader& reader, QSharedPointer<XsdType
                             type->enumValues.append(value);
                         }
                         else if (facetName == "pattern") {
-                            type->pattern = value;
+                            // Patterns of the same restriction are alternatives
+                            type->pattern = type->pattern.isEmpty() ? value : type->pattern + "|" + value;
+                        }
+                        else if (facetName == "length") {
+                            type->minLength = type->maxLength = value.toInt();
                         }
                         else if (facetName == "minLength") {
                             type->minLength = value.toInt();
@@ -232,6 +228,18 @@ bool XsdParser::parseSimpleType(QXmlStreamReader& reader, QSharedPointer<XsdType
                         else if (facetName == "maxLength") {
                             type->maxLength = value.toInt();
                         }
+                        else if (facetName == "minInclusive") {
+                            type->minInclusive = value;
+                        }
+                        else if (facetName == "maxInclusive") {
+                            type->maxInclusive = value;
+                        }
+                        else if (facetName == "minExclusive") {
+                            type->minExclusive = value;
+                        }
+                        else if (facetName == "maxExclusive") {
+                            type->maxExclusive = value;
+                        }
                     }
                 }
             }
@@ -242,10 +250,45 @@ bool XsdParser::parseSimpleType(QXmlStreamReader& reader, QSharedPointer<XsdType
 }
 
 bool XsdParser::parseSequence(QXmlStreamReader& reader, QSharedPointer<XsdType>& type) {
+    // xs:sequence or xs:all
+    type->compositor = reader.name().toString();
+    type->compositorMinOccurs = readIntAttribute(reader, "minOccurs", 1);
+    type->compositorMaxOccurs = readMaxOccurs(reader);
+    
+    QList<QSharedPointer<XsdElement>> elements;
+    bool nested = false;
+    parseModelGroup(reader, elements, &nested);
+    applyGroupOccurs(elements, false, type->compositorMinOccurs, type->compositorMaxOccurs);
+    type->nestedGroups = type->nestedGroups || nested;
+    type->elements.append(elements);
+    return true;
+}
+
+bool XsdParser::parseChoice(QXmlStreamReader& reader, QSharedPointer<XsdType>& type) {
+    // The alternatives keep their occurrences; a repeated choice, or one
+    // holding groups, is flattened like a sequence of optional elements
+    type->compositor = "choice";
+    type->compositorMinOccurs = readIntAttribute(reader, "minOccurs", 1);
+    type->compositorMaxOccurs = readMaxOccurs(reader);
+    
+    QList<QSharedPointer<XsdElement>> elements;
+    bool nested = false;
+    parseModelGroup(reader, elements, &nested);
+    if (nested || type->compositorMaxOccurs != 1) {
+        applyGroupOccurs(elements, true, type->compositorMinOccurs, type->compositorMaxOccurs);
+    }
+    type->nestedGroups = type->nestedGroups || nested;
+    type->elements.append(elements);
+    return true;
+}
+
+void XsdParser::parseModelGroup(QXmlStreamReader& reader, QList<QSharedPointer<XsdElement>>& elements, bool* nested) {
+    // Reads up to the end tag of the group the reader is on; nested
+    // groups are flattened into the element list
     while (!reader.atEnd()) {
         reader.readNext();
         
-        if (reader.isEndElement() && (reader.name() == "sequence" || reader.name() == "all")) {
+        if (reader.isEndElement()) {
             break;
         }
         
@@ -255,18 +298,37 @@ bool XsdParser::parseSequence(QXmlStreamReader& reader, QSharedPointer<XsdType>&
             if (name == "element") {
                 QSharedPointer<XsdElement> element(new XsdElement);
                 if (parseElement(reader, element)) {
-                    type->elements.append(element);
+                    elements.append(element);
                 }
             }
+            else if (name == "sequence" || name == "choice" || name == "all") {
+                const int minOccurs = readIntAttribute(reader, "minOccurs", 1);
+                const int maxOccurs = readMaxOccurs(reader);
+                QList<QSharedPointer<XsdElement>> group;
+                parseModelGroup(reader, group, nested);
+                applyGroupOccurs(group, name == "choice", minOccurs, maxOccurs);
+                elements.append(group);
+                *nested = true;
+            }
+            else {
+                // xs:any, xs:group references, annotations
+                skipUnknownElement(reader);
+            }
         }
     }
-    
-    return true;
 }
 
-bool XsdParser::parseChoice(QXmlStreamReader& reader, QSharedPointer<XsdType>& type) {
-    // Similar to sequence but marks it as choice
-    return parseSequence(reader, type);
+void XsdParser::applyGroupOccurs(QList<QSharedPointer<XsdElement>>& elements, bool choice, int minOccurs, int maxOccurs) {
+    // Elements of an optional group or of a choice may be absent; those
+    // of a repeated group may repeat
+    for (const auto& element : elements) {
+        if (choice || minOccurs == 0) {
+            element->minOccurs = 0;
+        }
+        if (maxOccurs != 1 && element->maxOccurs != -1) {
+            element->maxOccurs = maxOccurs == -1 ? -1 : element->maxOccurs * maxOccurs;
+        }
+    }
 }
 
 bool XsdParser::parseAttribute(QXmlStreamReader& reader, QSharedPointer<XsdAttribute>& attribute) {
@@ -295,7 +357,7 @@ bool XsdParser::parseExtension(QXmlStreamReader& reader, QSharedPointer<XsdType>
         if (reader.isStartElement()) {
             QString name = reader.name().toString();
             
-            if (name == "sequence") {
+            if (name == "sequence" || name == "all") {
                 parseSequence(reader, type);
             }
             else if (name == "choice") {
@@ -327,9 +389,12 @@ bool XsdParser::parseRestriction(QXmlStreamReader& reader, QSharedPointer<XsdTyp
         if (reader.isStartElement()) {
             QString name = reader.name().toString();
             
-            if (name == "sequence") {
+            if (name == "sequence" || name == "all") {
                 parseSequence(reader, type);
             }
+            else if (name == "choice") {
+                parseChoice(reader, type);
+            }
             else if (name == "attribute") {
                 QSharedPointer<XsdAttribute> attr(new XsdAttribute);
                 if (parseAttribute(reader, attr)) {
@@ -343,13 +408,68 @@ bool XsdParser::parseRestriction(QXmlStreamReader& reader, QSharedPointer<XsdTyp
 }
 
 void XsdParser::buildSubstitutionGroups() {
-    for (auto it = m_schema->elements.begin(); it != m_schema->elements.end(); ++it) {
+    // Rebuilt from scratch, parseSchema() runs once per included file
+    QMap<QString, QList<QString>> direct;
+    for (auto it = m_schema->elements.constBegin(); it != m_schema->elements.constEnd(); ++it) {
         if (!it.value()->substitutionGroup.isEmpty()) {
-            m_schema->substitutionGroups[it.value()->substitutionGroup].append(it.key());
+            direct[localName(it.value()->substitutionGroup)].append(it.key());
+        }
+    }
+    
+    // An element substituting for a member also substitutes for the head
+    m_schema->substitutionGroups.clear();
+    for (auto it = direct.constBegin(); it != direct.constEnd(); ++it) {
+        QList<QString>& members = m_schema->substitutionGroups[it.key()];
+        QList<QString> pending = it.value();
+        while (!pending.isEmpty()) {
+            const QString member = pending.takeFirst();
+            if (member != it.key() && !members.contains(member)) {
+                members.append(member);
+                pending += direct.value(member);
+            }
+        }
+    }
+}
+
+void XsdParser::resolveReferences() {
+    for (const auto& type : m_schema->types) {
+        resolveReferences(type);
+    }
+    for (const auto& element : m_schema->elements) {
+        if (element->inlineType) {
+            resolveReferences(element->inlineType);
         }
     }
 }
 
+void XsdParser::resolveReferences(const QSharedPointer<XsdType>& type) {
+    for (const auto& element : type->elements) {
+        if (element->refName.isEmpty()) {
+            continue;
+        }
+        
+        // Unresolved refs (global element in a file not parsed yet) are retried later
+        QSharedPointer<XsdElement> target = m_schema->elements.value(localName(element->refName));
+        if (!target) {
+            continue;
+        }
+        
+        // Occurrence constraints stay those of the reference
+        element->name = target->name;
+        element->typeName = target->inlineType ? target->name : target->typeName;
+        element->isAbstract = target->isAbstract;
+        element->isNillable = target->isNillable;
+        element->intern = element->intern || target->intern;
+        if (element->defaultValue.isEmpty()) {
+            element->defaultValue = target->defaultValue;
+        }
+    }
+}
+
+QString XsdParser::localName(const QString& qualifiedName) {
+    return qualifiedName.mid(qualifiedName.indexOf(':') + 1);
+}
+
 bool XsdParser::resolveIncludes(const QString& basePath, QString* errorMsg) {
     QDir baseDir(basePath);
     
@@ -386,6 +506,11 @@ int XsdParser::readIntAttribute(QXmlStreamReader& reader, const QString& name, i
     return value.toInt();
 }
 
+int XsdParser::readMaxOccurs(QXmlStreamReader& reader) {
+    QString value = readAttribute(reader, "maxOccurs", "1");
+    return value == "unbounded" ? -1 : value.toInt();
+}
+
 bool XsdParser::readBoolAttribute(QXmlStreamReader& reader, const QString& name, bool defaultValue) {
     QString value = readAttribute(reader, name).toLower();
     if (value.isEmpty()) {
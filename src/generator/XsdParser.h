@@ -9,6 +9,11 @@
 
 namespace XsdGen {
 
+/**
+ * Namespace of generator annotations in schemas, e.g. xsdqt:intern="true"
+ */
+static const char* const XSDQT_NAMESPACE = "urn:xsdqt";
+
 enum class XsdTypeKind {
     SimpleType,
     ComplexType,
@@ -36,9 +41,13 @@ struct XsdType {
     // For simple types
     QString baseType;
     QList<QString> enumValues;
-    QString pattern;
+    QString pattern;    // alternatives of one restriction joined with '|'
     int minLength = -1;
     int maxLength = -1;
+    QString minInclusive;
+    QString maxInclusive;
+    QString minExclusive;
+    QString maxExclusive;
     
     // For complex types
     QString baseTypeName;  // For extension/restriction
@@ -48,17 +57,22 @@ struct XsdType {
     
     // Sequence, choice, all
     QString compositor; // "sequence", "choice", "all"
+    int compositorMinOccurs = 1;
+    int compositorMaxOccurs = 1;    // -1 for unbounded
+    bool nestedGroups = false;      // groups inside the compositor, flattened into its elements
 };
 
 struct XsdElement {
     QString name;
     QString typeName;
+    QString refName;    // ref="tns:vehicle"; name and type are copied from the global element
     QString substitutionGroup;
     int minOccurs = 1;
     int maxOccurs = 1;  // -1 for unbounded
     QString defaultValue;
     bool isNillable = false;
     bool isAbstract = false;
+    bool intern = false;    // xsdqt:intern: share repeated values through XsdQt::XmlStringPool
     
     // Inline type definition
     QSharedPointer<XsdType> inlineType;
@@ -83,6 +97,7 @@ struct XsdSchema {
     QList<QString> includes;
     
     // Substitution groups map: group head -> list of substitutable elements
+    // (local names, members of members included)
     QMap<QString, QList<QString>> substitutionGroups;
 };
 
@@ -117,14 +132,21 @@ private:
     bool parseSimpleType(QXmlStreamReader& reader, QSharedPointer<XsdType>& type);
     bool parseSequence(QXmlStreamReader& reader, QSharedPointer<XsdType>& type);
     bool parseChoice(QXmlStreamReader& reader, QSharedPointer<XsdType>& type);
+    void parseModelGroup(QXmlStreamReader& reader, QList<QSharedPointer<XsdElement>>& elements, bool* nested);
+    static void applyGroupOccurs(QList<QSharedPointer<XsdElement>>& elements, bool choice, int minOccurs, int maxOccurs);
     bool parseAttribute(QXmlStreamReader& reader, QSharedPointer<XsdAttribute>& attribute);
     bool parseExtension(QXmlStreamReader& reader, QSharedPointer<XsdType>& type);
     bool parseRestriction(QXmlStreamReader& reader, QSharedPointer<XsdType>& type);
     
     void buildSubstitutionGroups();
+    void resolveReferences();
+    void resolveReferences(const QSharedPointer<XsdType>& type);
+    
+    static QString localName(const QString& qualifiedName);
     
     QString readAttribute(QXmlStreamReader& reader, const QString& name, const QString& defaultValue = QString());
     int readIntAttribute(QXmlStreamReader& reader, const QString& name, int defaultValue);
+    int readMaxOccurs(QXmlStreamReader& reader);
     bool readBoolAttribute(QXmlStreamReader& reader, const QString& name, bool defaultValue = false);
     
     void skipUnknownElement(QXmlStreamReader& reader);
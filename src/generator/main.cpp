@@ -3,6 +3,7 @@
 #include <QCoreApplication>
 #include <QCommandLineParser>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QFileInfo>
 
 int main(int argc, char *argv[]) {
@@ -29,6 +30,44 @@ int main(int argc, char *argv[]) {
         "Generated");
     parser.addOption(namespaceOption);
     
+    QCommandLineOption utf8WriterOption("utf8-writer",
+        "Also generate toXml() for the direct UTF-8 writer (XsdQt::XmlUtf8Writer)");
+    parser.addOption(utf8WriterOption);
+    
+    QCommandLineOption fastReaderOption("fast-reader",
+        "Also generate fromXml() for the UTF-8 fast reader (XsdQt::XmlFastReader)");
+    parser.addOption(fastReaderOption);
+    
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs",
+        "Threads used to write the generated files (default: number of cores)",
+        "count",
+        "0");
+    parser.addOption(jobsOption);
+    
+    QCommandLineOption manifestOption("manifest",
+        QString("Track generated files in <output>/%1 and delete the ones no longer generated")
+            .arg(XsdGen::CodeGenerator::MANIFEST_FILE));
+    parser.addOption(manifestOption);
+    
+    QCommandLineOption unityOption("unity",
+        "Amalgamate the implementations into <units> translation units plus an umbrella header",
+        "units",
+        "0");
+    parser.addOption(unityOption);
+    
+    QCommandLineOption internOption("intern",
+        "Read these string fields through XsdQt::XmlStringPool (comma-separated, Type.element or element)",
+        "fields");
+    parser.addOption(internOption);
+    
+    QCommandLineOption validateOption("validate",
+        "Check pattern, length, range and enumeration facets in the generated fromXml()");
+    parser.addOption(validateOption);
+    
+    QCommandLineOption columnsOption("columns",
+        "Also generate <namespace>Columns.h/.cpp: repeated complex elements as per-field arrays");
+    parser.addOption(columnsOption);
+    
     parser.process(app);
     
     const QStringList args = parser.positionalArguments();
@@ -42,8 +81,27 @@ int main(int argc, char *argv[]) {
     QString outputDir = parser.value(outputOption);
     QString ns = parser.value(namespaceOption);
     
+    bool jobsOk = false;
+    int jobs = parser.value(jobsOption).toInt(&jobsOk);
+    if (!jobsOk || jobs < 0) {
+        qCritical() << "Error: --jobs expects a non-negative number";
+        return 1;
+    }
+    
+    bool unityOk = false;
+    int unityUnits = parser.value(unityOption).toInt(&unityOk);
+    if (!unityOk || unityUnits < 0) {
+        qCritical() << "Error: --unity expects a non-negative number";
+        return 1;
+    }
+    
     qInfo() << "Parsing XSD file:" << inputFile;
     
+    QElapsedTimer total;
+    QElapsedTimer phase;
+    total.start();
+    phase.start();
+    
     // Parse XSD
     XsdGen::XsdParser xsdParser;
     QString errorMsg;
@@ -53,6 +111,7 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     
+    qInfo() << "  parse:" << phase.restart() << "ms";
     qInfo() << "Resolving includes and imports...";
     
     QFileInfo fileInfo(inputFile);
@@ -63,17 +122,35 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     
+    qInfo().noquote() << QString("  resolve: %1 ms (%2 types, %3 elements)")
+        .arg(phase.restart())
+        .arg(xsdParser.schema()->types.size())
+        .arg(xsdParser.schema()->elements.size());
     qInfo() << "Generating C++ code...";
     
     // Generate code
     XsdGen::CodeGenerator generator(xsdParser.schema());
     generator.setNamespace(ns);
+    generator.setUtf8Writer(parser.isSet(utf8WriterOption));
+    generator.setFastReader(parser.isSet(fastReaderOption));
+    generator.setThreadCount(jobs);
+    generator.setManifest(parser.isSet(manifestOption));
+    generator.setUnityUnits(unityUnits);
+    generator.setInternedFields(parser.value(internOption).split(',', QString::SkipEmptyParts));
+    generator.setValidation(parser.isSet(validateOption));
+    generator.setColumns(parser.isSet(columnsOption));
     
     if (!generator.generate(outputDir, &errorMsg)) {
         qCritical() << "Failed to generate code:" << errorMsg;
         return 1;
     }
     
+    qInfo().noquote() << QString("  generate: %1 ms (%2 written, %3 unchanged, %4 removed)")
+        .arg(phase.elapsed())
+        .arg(generator.filesWritten())
+        .arg(generator.filesUnchanged())
+        .arg(generator.filesRemoved());
+    qInfo() << "  total:" << total.elapsed() << "ms";
     qInfo() << "Code generation completed successfully!";
     qInfo() << "Output directory:" << outputDir;
     
@@ -0,0 +1,100 @@
+#include "XmlAttributeBinder.h"
+
+namespace XsdQt {
+
+// Missing or empty values give the default; malformed numbers give 0,
+// as XmlHelpers::readIntAttribute does, with ok set to false
+int XmlAttributeBinder<QXmlStreamReader>::toInt(int index, int defaultValue, bool* ok) const {
+    const QStringRef value = m_attributes.at(index).value();
+    if (value.isEmpty()) {
+        if (ok) *ok = true;
+        return defaultValue;
+    }
+    return value.toInt(ok);
+}
+
+qint64 XmlAttributeBinder<QXmlStreamReader>::toInt64(int index, qint64 defaultValue, bool* ok) const {
+    const QStringRef value = m_attributes.at(index).value();
+    if (value.isEmpty()) {
+        if (ok) *ok = true;
+        return defaultValue;
+    }
+    return value.toLongLong(ok);
+}
+
+quint64 XmlAttributeBinder<QXmlStreamReader>::toUInt64(int index, quint64 defaultValue, bool* ok) const {
+    const QStringRef value = m_attributes.at(index).value();
+    if (value.isEmpty()) {
+        if (ok) *ok = true;
+        return defaultValue;
+    }
+    return value.toULongLong(ok);
+}
+
+double XmlAttributeBinder<QXmlStreamReader>::toDouble(int index, double defaultValue, bool* ok) const {
+    const QStringRef value = m_attributes.at(index).value();
+    if (value.isEmpty()) {
+        if (ok) *ok = true;
+        return defaultValue;
+    }
+    return value.toDouble(ok);
+}
+
+bool XmlAttributeBinder<QXmlStreamReader>::toBool(int index, bool defaultValue, bool* ok) const {
+    const QStringRef value = m_attributes.at(index).value();
+    if (ok) *ok = true;
+    if (value == QLatin1String("1") || value.compare(QLatin1String("true"), Qt::CaseInsensitive) == 0) {
+        return true;
+    }
+    if (value == QLatin1String("0") || value.compare(QLatin1String("false"), Qt::CaseInsensitive) == 0) {
+        return false;
+    }
+    if (ok) *ok = value.isEmpty();
+    return defaultValue;
+}
+
+int XmlAttributeBinder<XmlFastReader>::toInt(int index, int defaultValue, bool* ok) const {
+    const XmlUtf8View value = m_reader.attribute(index).value;
+    if (value.isEmpty()) {
+        if (ok) *ok = true;
+        return defaultValue;
+    }
+    return value.toInt(ok);
+}
+
+qint64 XmlAttributeBinder<XmlFastReader>::toInt64(int index, qint64 defaultValue, bool* ok) const {
+    const XmlUtf8View value = m_reader.attribute(index).value;
+    if (value.isEmpty()) {
+        if (ok) *ok = true;
+        return defaultValue;
+    }
+    return value.toInt64(ok);
+}
+
+quint64 XmlAttributeBinder<XmlFastReader>::toUInt64(int index, quint64 defaultValue, bool* ok) const {
+    const XmlUtf8View value = m_reader.attribute(index).value;
+    if (value.isEmpty()) {
+        if (ok) *ok = true;
+        return defaultValue;
+    }
+    return value.toUInt64(ok);
+}
+
+double XmlAttributeBinder<XmlFastReader>::toDouble(int index, double defaultValue, bool* ok) const {
+    const XmlUtf8View value = m_reader.attribute(index).value;
+    if (value.isEmpty()) {
+        if (ok) *ok = true;
+        return defaultValue;
+    }
+    return value.toDouble(ok);
+}
+
+bool XmlAttributeBinder<XmlFastReader>::toBool(int index, bool defaultValue, bool* ok) const {
+    const XmlUtf8View value = m_reader.attribute(index).value;
+    bool converted = false;
+    const bool result = value.toBool(&converted);
+    if (ok) *ok = converted || value.isEmpty();
+    return converted ? result : defaultValue;
+}
+
+} // namespace XsdQt
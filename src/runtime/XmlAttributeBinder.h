@@ -0,0 +1,87 @@
+#ifndef XMLATTRIBUTEBINDER_H
+#define XMLATTRIBUTEBINDER_H
+
+#include "XmlEnum.h"
+#include "XmlFastReader.h"
+#include "XmlNameHash.h"
+#include <QString>
+#include <QStringRef>
+#include <QXmlStreamAttributes>
+#include <QXmlStreamReader>
+
+namespace XsdQt {
+
+/**
+ * Attributes of the current start element, scanned once by generated fromXml
+ *
+ * Generated code loops over count() and switches on nameHash(i), confirming
+ * the match with nameIs(i, ...) before converting the value in place (no
+ * QString unless the member is one). Names are matched as qualified names,
+ * so prefixed attributes such as xsi:type never bind to a member.
+ * Conversions report malformed values through ok, for
+ * XmlErrorCollector::report() with text(i) as the found value.
+ * Valid until the reader advances.
+ */
+template<typename Reader>
+class XmlAttributeBinder;
+
+template<>
+class XmlAttributeBinder<QXmlStreamReader> {
+public:
+    // Shares the reader's attribute vector; one copy per element, not per attribute
+    explicit XmlAttributeBinder(QXmlStreamReader& reader) : m_attributes(reader.attributes()) {}
+
+    int count() const { return m_attributes.size(); }
+    quint32 nameHash(int index) const { return xmlNameHash(m_attributes.at(index).qualifiedName()); }
+    bool nameIs(int index, XmlUtf8View name) const { return xmlNameEquals(m_attributes.at(index).qualifiedName(), name); }
+
+    QString text(int index) const { return m_attributes.at(index).value().toString(); }
+    int toInt(int index, int defaultValue = 0, bool* ok = nullptr) const;
+    qint64 toInt64(int index, qint64 defaultValue = 0, bool* ok = nullptr) const;
+    quint64 toUInt64(int index, quint64 defaultValue = 0, bool* ok = nullptr) const;
+    double toDouble(int index, double defaultValue = 0.0, bool* ok = nullptr) const;
+    bool toBool(int index, bool defaultValue = false, bool* ok = nullptr) const;
+
+    template<typename Enum>
+    Enum toEnum(int index, Enum defaultValue, bool* ok = nullptr) const {
+        Enum value;
+        const bool parsed = parseXmlEnum(m_attributes.at(index).value(), &value);
+        if (ok) *ok = parsed;
+        return parsed ? value : defaultValue;
+    }
+
+private:
+    const QXmlStreamAttributes m_attributes;
+};
+
+template<>
+class XmlAttributeBinder<XmlFastReader> {
+public:
+    explicit XmlAttributeBinder(XmlFastReader& reader) : m_reader(reader) {}
+
+    int count() const { return m_reader.attributeCount(); }
+    quint32 nameHash(int index) const { return xmlNameHash(m_reader.attribute(index).qualifiedName); }
+    bool nameIs(int index, XmlUtf8View name) const { return m_reader.attribute(index).qualifiedName == name; }
+
+    QString text(int index) const { return m_reader.attribute(index).value.toString(); }
+    int toInt(int index, int defaultValue = 0, bool* ok = nullptr) const;
+    qint64 toInt64(int index, qint64 defaultValue = 0, bool* ok = nullptr) const;
+    quint64 toUInt64(int index, quint64 defaultValue = 0, bool* ok = nullptr) const;
+    double toDouble(int index, double defaultValue = 0.0, bool* ok = nullptr) const;
+    bool toBool(int index, bool defaultValue = false, bool* ok = nullptr) const;
+
+    template<typename Enum>
+    Enum toEnum(int index, Enum defaultValue, bool* ok = nullptr) const {
+        Enum value;
+        const bool parsed = parseXmlEnum(m_reader.attribute(index).value, &value);
+        if (ok) *ok = parsed;
+        return parsed ? value : defaultValue;
+    }
+
+private:
+    const XmlFastReader& m_reader;
+};
+
+} // namespace XsdQt
+
+#endif // XMLATTRIBUTEBINDER_H
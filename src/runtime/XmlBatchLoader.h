@@ -0,0 +1,188 @@
+#ifndef XMLBATCHLOADER_H
+#define XMLBATCHLOADER_H
+
+#include "XmlDocument.h"
+#include <QAtomicInt>
+#include <QBuffer>
+#include <QByteArray>
+#include <QFile>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include <QXmlStreamReader>
+
+namespace XsdQt {
+
+/**
+ * Outcome of loading one file of a batch
+ */
+template<typename T>
+struct XmlBatchResult {
+    QString fileName;
+    QSharedPointer<T> root;   // null if loading failed
+    QString errorMsg;
+
+    bool isOk() const { return !root.isNull(); }
+};
+
+/**
+ * Loads many small XML documents with a root element of type T
+ *
+ * Files are handed out dynamically: every worker claims the next unread
+ * index from a shared counter, so idle workers keep pulling files while
+ * slow ones are still busy. Each worker owns one read buffer and one
+ * QXmlStreamReader which are reused for every file it processes.
+ * Results are returned in the order of the input list.
+ *
+ * load() may be called from a thread of the pool it uses, even a
+ * saturated one: the calling thread loads files itself, and workers the
+ * pool has not started once every file is claimed are taken back with
+ * QThreadPool::tryTake(). Before Qt 5.9, which lacks tryTake(), only as
+ * many workers are started as the pool has idle threads.
+ */
+template<typename T>
+class XmlBatchLoader {
+public:
+    XmlBatchLoader() : m_pool(QThreadPool::globalInstance()), m_maxThreads(0), m_interning(false) {}
+
+    /**
+     * Thread pool used for the workers; null selects the global instance
+     */
+    void setThreadPool(QThreadPool* pool) { m_pool = pool ? pool : QThreadPool::globalInstance(); }
+
+    /**
+     * Upper bound on concurrent workers, 0 means the pool's maximum
+     */
+    void setMaxThreads(int maxThreads) { m_maxThreads = maxThreads; }
+
+    /**
+     * Give each worker an XmlStringPool for interned fields, so their
+     * values are shared across all files that worker loads
+     */
+    void setInterning(bool interning) { m_interning = interning; }
+
+    /**
+     * Load all files, one result per input path
+     */
+    QVector<XmlBatchResult<T>> load(const QStringList& fileNames) const {
+        QVector<XmlBatchResult<T>> results(fileNames.size());
+        if (fileNames.isEmpty()) {
+            return results;
+        }
+
+        int workers = m_maxThreads > 0 ? m_maxThreads : m_pool->maxThreadCount();
+#if QT_VERSION < QT_VERSION_CHECK(5, 9, 0)
+        // Without tryTake() queued workers can't be reclaimed, so only
+        // start as many as the pool has idle threads for
+        workers = qMin(workers, m_pool->maxThreadCount() - m_pool->activeThreadCount() + 1);
+#endif
+        workers = qBound(1, workers, fileNames.size());
+
+        QAtomicInt next(0);
+        QSemaphore done;
+
+        // Detach once up front; workers then write disjoint slots
+        XmlBatchResult<T>* out = results.data();
+
+        // The calling thread works too, so a saturated pool cannot stall the batch
+        QVector<Worker*> queued;
+        for (int i = 1; i < workers; ++i) {
+            queued.append(new Worker(fileNames, out, next, &done, m_interning));
+            m_pool->start(queued.last());
+        }
+        Worker(fileNames, out, next, nullptr, m_interning).run();
+
+        // Every file is claimed now; workers the pool has not started yet
+        // would find nothing left, so take them back instead of waiting
+        int pending = queued.size();
+#if QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
+        for (Worker* worker : queued) {
+            if (m_pool->tryTake(worker)) {
+                --pending;
+            }
+        }
+#endif
+        done.acquire(pending);
+        qDeleteAll(queued);
+        return results;
+    }
+
+    /**
+     * Load a single file reusing the caller's buffer and reader
+     */
+    static bool loadFile(const QString& fileName, QByteArray& data, QBuffer& device,
+                         QXmlStreamReader& reader, XmlBatchResult<T>& result) {
+        result.fileName = fileName;
+
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly)) {
+            result.errorMsg = QString("Cannot open file: %1").arg(fileName);
+            return false;
+        }
+
+        // Shrinking keeps the allocation, so the buffer only grows to the largest file
+        device.close();
+        data.resize(int(file.size()));
+        if (file.read(data.data(), data.size()) != data.size()) {
+            result.errorMsg = QString("Cannot read file: %1").arg(fileName);
+            return false;
+        }
+        device.open(QIODevice::ReadOnly);
+        reader.setDevice(&device);
+
+        XmlDocument<T> doc(QSharedPointer<T>(nullptr));
+        if (!doc.loadFromReader(reader, &result.errorMsg)) {
+            return false;
+        }
+
+        result.root = doc.root();
+        return true;
+    }
+
+private:
+    class Worker : public QRunnable {
+    public:
+        Worker(const QStringList& fileNames, XmlBatchResult<T>* results,
+               QAtomicInt& next, QSemaphore* done, bool interning)
+            : m_fileNames(fileNames), m_results(results), m_next(next), m_done(done),
+              m_interning(interning), m_device(&m_data) {
+            // Owned by load(), which may take it back from the queue
+            setAutoDelete(false);
+        }
+
+        void run() override {
+            XmlStringPoolScope scope(m_interning ? &m_strings : XmlStringPool::current());
+
+            int index;
+            while ((index = m_next.fetchAndAddRelaxed(1)) < m_fileNames.size()) {
+                loadFile(m_fileNames.at(index), m_data, m_device, m_reader, m_results[index]);
+            }
+
+            if (m_done) {
+                m_done->release();
+            }
+        }
+
+    private:
+        const QStringList& m_fileNames;
+        XmlBatchResult<T>* m_results;
+        QAtomicInt& m_next;
+        QSemaphore* m_done;
+        bool m_interning;
+
+        XmlStringPool m_strings;
+        QByteArray m_data;
+        QBuffer m_device;
+        QXmlStreamReader m_reader;
+    };
+
+    QThreadPool* m_pool;
+    int m_maxThreads;
+    bool m_interning;
+};
+
+} // namespace XsdQt
+
+#endif // XMLBATCHLOADER_H
@@ -0,0 +1,144 @@
+#ifndef XMLCHOICE_H
+#define XMLCHOICE_H
+
+#include <cstddef>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace XsdQt {
+
+/**
+ * Storage of an xs:choice: at most one alternative, held in place
+ *
+ * Generated classes keep one XmlChoice instead of a member per
+ * alternative, so an object only grows by its largest alternative plus
+ * the index. Alternatives are addressed by position, as types may repeat
+ * (two xs:string alternatives); index() is -1 while none is set.
+ * A C++14 stand-in for std::variant.
+ */
+template<typename... Alternatives>
+class XmlChoice {
+public:
+    template<std::size_t I>
+    using Alternative = typename std::tuple_element<I, std::tuple<Alternatives...>>::type;
+
+    XmlChoice() : m_index(-1) {}
+    XmlChoice(const XmlChoice& other) : m_index(-1) { copyFrom(other); }
+    XmlChoice(XmlChoice&& other) noexcept : m_index(-1) { moveFrom(other); }
+    ~XmlChoice() { clear(); }
+
+    XmlChoice& operator=(const XmlChoice& other) {
+        if (this != &other) {
+            clear();
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    XmlChoice& operator=(XmlChoice&& other) noexcept {
+        if (this != &other) {
+            clear();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    int index() const { return m_index; }
+    bool isEmpty() const { return m_index < 0; }
+
+    /**
+     * Alternative I if it is the active one, else a default constructed value
+     */
+    template<std::size_t I>
+    const Alternative<I>& value() const {
+        static const Alternative<I> none{};
+        return m_index == int(I) ? *reinterpret_cast<const Alternative<I>*>(&m_storage) : none;
+    }
+
+    /**
+     * Make I the active alternative, default constructed unless it already
+     * was, and return it for assignment or appending
+     */
+    template<std::size_t I>
+    Alternative<I>& select() {
+        if (m_index != int(I)) {
+            clear();
+            new (&m_storage) Alternative<I>();
+            m_index = int(I);
+        }
+        return *reinterpret_cast<Alternative<I>*>(&m_storage);
+    }
+
+    void clear() {
+        if (m_index >= 0) {
+            destroyAt(m_index, &m_storage, Indexes());
+            m_index = -1;
+        }
+    }
+
+private:
+    using Indexes = std::index_sequence_for<Alternatives...>;
+    using Storage = typename std::aligned_union<0, Alternatives...>::type;
+
+    // Operations on the active alternative, dispatched on the index
+    template<std::size_t I>
+    static void destroyOne(void* storage) {
+        using T = Alternative<I>;
+        static_cast<T*>(storage)->~T();
+    }
+
+    template<std::size_t I>
+    static void copyOne(void* target, const void* source) {
+        new (target) Alternative<I>(*static_cast<const Alternative<I>*>(source));
+    }
+
+    template<std::size_t I>
+    static void moveOne(void* target, void* source) {
+        new (target) Alternative<I>(std::move(*static_cast<Alternative<I>*>(source)));
+    }
+
+    template<std::size_t... I>
+    static void destroyAt(int index, void* storage, std::index_sequence<I...>) {
+        using Destroy = void (*)(void*);
+        static const Destroy table[] = { &destroyOne<I>... };
+        table[index](storage);
+    }
+
+    template<std::size_t... I>
+    static void copyAt(int index, void* target, const void* source, std::index_sequence<I...>) {
+        using Copy = void (*)(void*, const void*);
+        static const Copy table[] = { &copyOne<I>... };
+        table[index](target, source);
+    }
+
+    template<std::size_t... I>
+    static void moveAt(int index, void* target, void* source, std::index_sequence<I...>) {
+        using Move = void (*)(void*, void*);
+        static const Move table[] = { &moveOne<I>... };
+        table[index](target, source);
+    }
+
+    void copyFrom(const XmlChoice& other) {
+        if (other.m_index >= 0) {
+            copyAt(other.m_index, &m_storage, &other.m_storage, Indexes());
+            m_index = other.m_index;
+        }
+    }
+
+    void moveFrom(XmlChoice& other) {
+        if (other.m_index >= 0) {
+            moveAt(other.m_index, &m_storage, &other.m_storage, Indexes());
+            m_index = other.m_index;
+            other.clear();
+        }
+    }
+
+    Storage m_storage;
+    int m_index;
+};
+
+} // namespace XsdQt
+
+#endif // XMLCHOICE_H
@@ -0,0 +1,74 @@
+#include "XmlCodecContext.h"
+
+namespace XsdQt {
+
+XmlCodecContext::XmlCodecContext(int initialCapacity)
+    : XmlCodecContext(XmlWriterOptions(), initialCapacity)
+{
+}
+
+XmlCodecContext::XmlCodecContext(const XmlWriterOptions& options, int initialCapacity)
+    : m_outputDevice(&m_output), m_utf8Writer(&m_output), m_options(options), m_stringPool(nullptr), m_errorCollector(nullptr)
+{
+    // Reserving marks the capacity as sticky, so resize(0) keeps it
+    m_output.reserve(initialCapacity);
+    m_outputDevice.open(QIODevice::WriteOnly);
+    createWriter();
+}
+
+QXmlStreamReader& XmlCodecContext::beginRead(const QByteArray& data) {
+    m_inputDevice.close();
+    m_inputDevice.setData(data);
+    m_inputDevice.open(QIODevice::ReadOnly);
+
+    // setDevice() clears the reader but keeps its internal buffers
+    m_reader.setDevice(&m_inputDevice);
+    return m_reader;
+}
+
+XmlFastReader& XmlCodecContext::beginFastRead(const QByteArray& data) {
+    m_fastReader.setData(data);
+    return m_fastReader;
+}
+
+QXmlStreamWriter& XmlCodecContext::beginWrite() {
+    // An error sticks to the writer, so start over with a fresh one
+    if (m_writer->hasError()) {
+        createWriter();
+    }
+
+    m_output.resize(0);
+    m_outputDevice.seek(0);
+
+    m_options.writeStartDocument(*m_writer);
+    return *m_writer;
+}
+
+bool XmlCodecContext::endWrite() {
+    m_writer->writeEndDocument();
+    return !m_writer->hasError();
+}
+
+XmlUtf8Writer& XmlCodecContext::beginUtf8Write() {
+    m_output.resize(0);
+    m_utf8Writer.reset();
+    m_options.writeStartDocument(m_utf8Writer);
+    return m_utf8Writer;
+}
+
+bool XmlCodecContext::endUtf8Write() {
+    m_utf8Writer.writeEndDocument();
+    return !m_utf8Writer.hasError();
+}
+
+void XmlCodecContext::setWriterOptions(const XmlWriterOptions& options) {
+    m_options = options;
+    createWriter();
+}
+
+void XmlCodecContext::createWriter() {
+    m_writer.reset(new QXmlStreamWriter(&m_outputDevice));
+    m_options.configure(*m_writer);
+}
+
+} // namespace XsdQt
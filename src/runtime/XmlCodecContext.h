@@ -0,0 +1,106 @@
+#ifndef XMLCODECCONTEXT_H
+#define XMLCODECCONTEXT_H
+
+#include "XmlFastReader.h"
+#include "XmlParseErrors.h"
+#include "XmlStringPool.h"
+#include "XmlWriterOptions.h"
+#include "XmlUtf8Writer.h"
+#include <QBuffer>
+#include <QByteArray>
+#include <QScopedPointer>
+#include <QString>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+namespace XsdQt {
+
+/**
+ * Reader/writer state reused across many small documents
+ *
+ * Keeps one QXmlStreamReader (plus a fast reader), one QXmlStreamWriter, the output buffer
+ * (with its capacity retained between documents) and the namespace
+ * declarations, so per-message cost is the parse/serialize itself.
+ * Not thread-safe: use one context per thread.
+ */
+class XmlCodecContext {
+public:
+    explicit XmlCodecContext(int initialCapacity = 4096);
+    explicit XmlCodecContext(const XmlWriterOptions& options, int initialCapacity = 4096);
+
+    /**
+     * Reset the reader onto data (shared, not copied)
+     * The reader stays valid until the next beginRead()
+     */
+    QXmlStreamReader& beginRead(const QByteArray& data);
+    
+    /**
+     * Same for the UTF-8 fast reader
+     */
+    XmlFastReader& beginFastRead(const QByteArray& data);
+
+    /**
+     * Clear the output buffer and write the document prologue
+     * and namespace declarations for the next root element
+     */
+    QXmlStreamWriter& beginWrite();
+
+    /**
+     * Finish the current document
+     * Returns false if the writer reported an error
+     */
+    bool endWrite();
+
+    /**
+     * Same as beginWrite()/endWrite() for the direct UTF-8 writer,
+     * which appends straight into the output buffer
+     */
+    XmlUtf8Writer& beginUtf8Write();
+    bool endUtf8Write();
+
+    /**
+     * Serialized bytes of the last document
+     * Valid until the next beginWrite()
+     */
+    const QByteArray& output() const { return m_output; }
+
+    /**
+     * Output settings, applied from the next beginWrite()
+     */
+    const XmlWriterOptions& writerOptions() const { return m_options; }
+    void setWriterOptions(const XmlWriterOptions& options);
+
+    /**
+     * Pool for interned fields while loading through this context
+     * (not owned, nullptr by default); keeps values shared across documents
+     */
+    XmlStringPool* stringPool() const { return m_stringPool; }
+    void setStringPool(XmlStringPool* pool) { m_stringPool = pool; }
+
+    /**
+     * Collector for errors reported while loading through this context
+     * (not owned, nullptr by default: fail fast with a reader error)
+     */
+    XmlErrorCollector* errorCollector() const { return m_errorCollector; }
+    void setErrorCollector(XmlErrorCollector* collector) { m_errorCollector = collector; }
+
+private:
+    void createWriter();
+
+    QBuffer m_inputDevice;
+    QXmlStreamReader m_reader;
+    XmlFastReader m_fastReader;
+
+    QByteArray m_output;
+    QBuffer m_outputDevice;
+    QScopedPointer<QXmlStreamWriter> m_writer;
+    XmlUtf8Writer m_utf8Writer;
+
+    XmlWriterOptions m_options;
+    XmlStringPool* m_stringPool;
+    XmlErrorCollector* m_errorCollector;
+};
+
+} // namespace XsdQt
+
+#endif // XMLCODECCONTEXT_H
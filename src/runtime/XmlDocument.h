@@ -2,9 +2,14 @@
 #define XMLDOCUMENT_H
 
 #include "XmlSerializable.h"
+#include "XmlHelpers.h"
+#include "XmlCodecContext.h"
+#include "XmlParseErrors.h"
+#include "XmlWriterOptions.h"
 #include <QString>
 #include <QSharedPointer>
 #include <QFile>
+#include <QBuffer>
 
 namespace XsdQt {
 
@@ -15,8 +20,8 @@ namespace XsdQt {
 template<typename T>
 class XmlDocument {
 public:
-    XmlDocument() : m_root(QSharedPointer<T>::create()) {}
-    explicit XmlDocument(const QSharedPointer<T>& root) : m_root(root) {}
+    XmlDocument() : m_root(QSharedPointer<T>::create()), m_fastReader(false) {}
+    explicit XmlDocument(const QSharedPointer<T>& root) : m_root(root), m_fastReader(false) {}
     
     /**
      * Get the root element
@@ -28,6 +33,20 @@ public:
      */
     void setRoot(const QSharedPointer<T>& root) { m_root = root; }
     
+    /**
+     * Output settings used by the save functions
+     * (contexts passed to saveToData() use their own)
+     */
+    const XmlWriterOptions& writerOptions() const { return m_writerOptions; }
+    void setWriterOptions(const XmlWriterOptions& options) { m_writerOptions = options; }
+    
+    /**
+     * Parse with XmlFastReader where possible (off by default)
+     * Documents it cannot handle are re-read with QXmlStreamReader
+     */
+    bool fastReader() const { return m_fastReader; }
+    void setFastReader(bool enabled) { m_fastReader = enabled; }
+    
     /**
      * Load XML from file
      */
@@ -38,6 +57,9 @@ public:
             return false;
         }
         
+        if (m_fastReader) {
+            return loadFromData(file.readAll(), errorMsg);
+        }
         return loadFromDevice(&file, errorMsg);
     }
     
@@ -46,6 +68,20 @@ public:
      */
     bool loadFromDevice(QIODevice* device, QString* errorMsg = nullptr) {
         QXmlStreamReader reader(device);
+        return loadFromReader(reader, errorMsg);
+    }
+    
+    /**
+     * Load XML from an already positioned reader
+     * Lets callers reuse one reader (and its buffers) across documents
+     * Reader is QXmlStreamReader or XmlFastReader
+     * With an XmlErrorCollector installed, a document for which errors
+     * were collected fails with the first of them
+     */
+    template<typename Reader>
+    bool loadFromReader(Reader& reader, QString* errorMsg = nullptr) {
+        XmlErrorCollector* errors = XmlErrorCollector::current();
+        const int errorsBefore = errors ? errors->count() : 0;
         
         // Find root element
         while (!reader.atEnd() && !reader.hasError()) {
@@ -56,10 +92,25 @@ public:
                     m_root = QSharedPointer<T>::create();
                 }
                 
-                if (m_root->fromXml(reader)) {
+                // Through the base class, generated types may hide the overload
+                XmlSerializable& root = *m_root;
+                if (errors) {
+                    errors->beginDocument(reader.name().toString());
+                }
+                if (root.fromXml(reader)) {
+                    // Truncated input ends the element loop without a parse failure
+                    if (reader.hasError()) {
+                        if (errorMsg) *errorMsg = reader.errorString();
+                        return false;
+                    }
+                    if (errors && errors->count() > errorsBefore) {
+                        if (errorMsg) *errorMsg = errors->errors().at(errorsBefore).toString();
+                        return false;
+                    }
                     return true;
                 } else {
-                    if (errorMsg) *errorMsg = "Failed to parse root element";
+                    // Generated fromXml raises the reader error for invalid values
+                    if (errorMsg) *errorMsg = reader.hasError() ? reader.errorString() : "Failed to parse root element";
                     return false;
                 }
             }
@@ -78,12 +129,49 @@ public:
      * Load XML from string
      */
     bool loadFromString(const QString& xml, QString* errorMsg = nullptr) {
-        QByteArray data = xml.toUtf8();
-        QBuffer buffer(&data);
+        return loadFromData(xml.toUtf8(), errorMsg);
+    }
+    
+    /**
+     * Load XML from a byte array
+     */
+    bool loadFromData(const QByteArray& data, QString* errorMsg = nullptr) {
+        if (m_fastReader && XmlFastReader::canRead(data)) {
+            XmlFastReader reader(data);
+            if (loadFast(reader, errorMsg)) {
+                return true;
+            }
+            if (!reader.isUnsupported()) {
+                return false;
+            }
+        }
+        
+        QBuffer buffer;
+        buffer.setData(data);
         buffer.open(QIODevice::ReadOnly);
         return loadFromDevice(&buffer, errorMsg);
     }
     
+    /**
+     * Load XML from a byte array using a reusable context
+     */
+    bool loadFromData(const QByteArray& data, XmlCodecContext& context, QString* errorMsg = nullptr) {
+        XmlStringPoolScope pool(context.stringPool() ? context.stringPool() : XmlStringPool::current());
+        XmlErrorCollectorScope errors(context.errorCollector() ? context.errorCollector() : XmlErrorCollector::current());
+        
+        if (m_fastReader && XmlFastReader::canRead(data)) {
+            XmlFastReader& reader = context.beginFastRead(data);
+            if (loadFast(reader, errorMsg)) {
+                return true;
+            }
+            if (!reader.isUnsupported()) {
+                return false;
+            }
+        }
+        
+        return loadFromReader(context.beginRead(data), errorMsg);
+    }
+    
     /**
      * Save XML to file
      */
@@ -106,16 +194,27 @@ public:
             return false;
         }
         
-        QXmlStreamWriter writer(device);
-        writer.setAutoFormatting(true);
-        writer.setAutoFormattingIndent(2);
+        if (m_writerOptions.canWriteUtf8Directly()) {
+            QByteArray data;
+            XmlUtf8Writer utf8Writer(&data);
+            m_writerOptions.writeStartDocument(utf8Writer);
+            
+            if (writeRoot(utf8Writer)) {
+                utf8Writer.writeEndDocument();
+                if (utf8Writer.hasError() || device->write(data) != data.size()) {
+                    if (errorMsg) *errorMsg = "Error writing XML";
+                    return false;
+                }
+                return true;
+            }
+            // Some type lacks direct writer support, use QXmlStreamWriter
+        }
         
-        writer.writeStartDocument();
-        XmlHelpers::setupNamespaces(writer);
+        QXmlStreamWriter writer(device);
+        m_writerOptions.configure(writer);
+        m_writerOptions.writeStartDocument(writer);
         
-        writer.writeStartElement(m_root->xmlElementName());
-        m_root->toXml(writer);
-        writer.writeEndElement();
+        writeRoot(writer);
         
         writer.writeEndDocument();
         
@@ -142,8 +241,76 @@ public:
         return QString();
     }
     
+    /**
+     * Save XML into the context's output buffer
+     * The bytes are available from context.output()
+     */
+    bool saveToData(XmlCodecContext& context, QString* errorMsg = nullptr) const {
+        if (!m_root) {
+            if (errorMsg) *errorMsg = "No root element to save";
+            return false;
+        }
+        
+        bool ok;
+        if (context.writerOptions().canWriteUtf8Directly() && writeRoot(context.beginUtf8Write())) {
+            ok = context.endUtf8Write();
+        } else {
+            writeRoot(context.beginWrite());
+            ok = context.endWrite();
+        }
+        
+        if (!ok) {
+            if (errorMsg) *errorMsg = "Error writing XML";
+            return false;
+        }
+        
+        return true;
+    }
+    
 private:
+    /**
+     * On an unsupported document the partly read root is replaced,
+     * so the QXmlStreamReader retry starts from a fresh object
+     */
+    bool loadFast(XmlFastReader& reader, QString* errorMsg) {
+        XmlErrorCollector* errors = XmlErrorCollector::current();
+        const int errorsBefore = errors ? errors->count() : 0;
+        
+        QString fastError;
+        if (loadFromReader(reader, &fastError)) {
+            return true;
+        }
+        if (reader.isUnsupported()) {
+            m_root = QSharedPointer<T>::create();
+            // The retry reports them again
+            if (errors) {
+                errors->truncate(errorsBefore);
+            }
+        } else if (errorMsg) {
+            *errorMsg = fastError;
+        }
+        return false;
+    }
+    
+    void writeRoot(QXmlStreamWriter& writer) const {
+        writer.writeStartElement(m_root->xmlElementName());
+        m_root->toXml(writer);
+        writer.writeEndElement();
+    }
+    
+    bool writeRoot(XmlUtf8Writer& writer) const {
+        const XmlSerializable& root = *m_root;
+        writer.writeStartElement(root.xmlElementName());
+        if (!root.toXml(writer)) {
+            return false;
+        }
+        writer.writeEndElement();
+        return true;
+    }
+    
     QSharedPointer<T> m_root;
+    XmlWriterOptions m_writerOptions;
+    bool m_fastReader;
 };
 
 } // namespace XsdQt
@@ -0,0 +1,69 @@
+#ifndef XMLENUM_H
+#define XMLENUM_H
+
+#include "XmlFastReader.h"
+#include "XmlNameHash.h"
+#include <QString>
+#include <QStringRef>
+
+namespace XsdQt {
+
+/**
+ * Lookup tables of a generated enum class
+ *
+ * names holds the lexical form of each enumerator in declaration order;
+ * slotIndex is an open-addressed table of 2^bits enumerator indexes (-1
+ * for empty slots, at least half of them) keyed by
+ * xmlHashSlot(xmlNameHash(text, seed), bits). The generator picks the seed
+ * that puts the most names in their home slot; for small enums that is a
+ * perfect hash, so a valid value costs one hash, one load and one compare.
+ */
+struct XmlEnumTable {
+    const XmlUtf8View* names;
+    const qint16* slotIndex;
+    quint32 seed;
+    int bits;
+
+    int indexOf(XmlUtf8View text) const {
+        const int mask = (1 << bits) - 1;
+        for (int slot = xmlHashSlot(xmlNameHash(text, seed), bits); ; slot = (slot + 1) & mask) {
+            const int index = slotIndex[slot];
+            if (index < 0 || names[index] == text) {
+                return index;
+            }
+        }
+    }
+
+    int indexOf(const QStringRef& text) const {
+        const int mask = (1 << bits) - 1;
+        for (int slot = xmlHashSlot(xmlNameHash(text, seed), bits); ; slot = (slot + 1) & mask) {
+            const int index = slotIndex[slot];
+            if (index < 0 || xmlNameEquals(text, names[index])) {
+                return index;
+            }
+        }
+    }
+};
+
+/**
+ * Parse the lexical form of a generated enum; the table is found through
+ * the xmlEnumTable(Enum) overload generated next to the enum
+ */
+template<typename Enum, typename Text>
+bool parseXmlEnum(const Text& text, Enum* value) {
+    const int index = xmlEnumTable(Enum()).indexOf(text);
+    if (index < 0) {
+        return false;
+    }
+    *value = Enum(index);
+    return true;
+}
+
+template<typename Enum>
+bool parseXmlEnum(const QString& text, Enum* value) {
+    return parseXmlEnum(QStringRef(&text), value);
+}
+
+} // namespace XsdQt
+
+#endif // XMLENUM_H
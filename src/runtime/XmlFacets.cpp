@@ -0,0 +1,72 @@
+#include "XmlFacets.h"
+#include <QDebug>
+
+namespace XsdQt {
+
+namespace {
+
+// XML name start and name characters (\i and \c), as class contents
+const QLatin1String nameStartChars("\\p{L}_:");
+const QLatin1String nameChars("\\p{L}\\p{Nd}\\p{Mn}\\p{Mc}._:\\-");
+
+QString translatePattern(const QString& pattern) {
+    QString result;
+    result.reserve(pattern.size() + 16);
+    bool inClass = false;
+    for (int i = 0; i < pattern.size(); ++i) {
+        const QChar c = pattern.at(i);
+        if (c == QLatin1Char('\\') && i + 1 < pattern.size()) {
+            const QChar next = pattern.at(++i);
+            const char escape = next.toLatin1();
+            if (escape == 'i' || escape == 'c') {
+                const QLatin1String chars = escape == 'i' ? nameStartChars : nameChars;
+                result += inClass ? QString(chars) : QString("[%1]").arg(chars);
+            } else if ((escape == 'I' || escape == 'C') && !inClass) {
+                result += QString("[^%1]").arg(escape == 'I' ? nameStartChars : nameChars);
+            } else {
+                result += c;
+                result += next;
+            }
+        } else if (c == QLatin1Char('[') && !inClass) {
+            inClass = true;
+            result += c;
+        } else if (c == QLatin1Char(']') && inClass) {
+            inClass = false;
+            result += c;
+        } else if (!inClass && (c == QLatin1Char('^') || c == QLatin1Char('$'))) {
+            // Not anchors in XSD; the whole value is matched anyway
+            result += QLatin1Char('\\');
+            result += c;
+        } else {
+            result += c;
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+QRegularExpression compileXmlPattern(const QString& pattern) {
+    QRegularExpression expression(QString("\\A(?:%1)\\z").arg(translatePattern(pattern)),
+                                  QRegularExpression::UseUnicodePropertiesOption);
+    if (!expression.isValid()) {
+        qWarning().noquote() << QString("Invalid xs:pattern \"%1\": %2").arg(pattern, expression.errorString());
+        return expression;
+    }
+    // Compile (and JIT) now rather than on first use
+    expression.optimize();
+    return expression;
+}
+
+int xmlLength(const QString& value) {
+    // A surrogate pair is one character
+    int length = value.size();
+    for (const QChar c : value) {
+        if (c.isLowSurrogate()) {
+            --length;
+        }
+    }
+    return length;
+}
+
+} // namespace XsdQt
@@ -0,0 +1,28 @@
+#ifndef XMLFACETS_H
+#define XMLFACETS_H
+
+#include <QRegularExpression>
+#include <QString>
+
+namespace XsdQt {
+
+/**
+ * xs:pattern as an anchored, optimised QRegularExpression
+ *
+ * Generated validators (xsd2cpp --validate) hold the result in a function
+ * local static, so each pattern is compiled once per process. The XSD
+ * multi-character escapes \i, \I, \c and \C are rewritten to Unicode
+ * classes and ^ / $ match literally, as in XSD; character class
+ * subtraction and \p{Is...} block escapes are not supported. An invalid
+ * pattern is reported with qWarning() and matches nothing.
+ */
+QRegularExpression compileXmlPattern(const QString& pattern);
+
+/**
+ * Length as the XSD length facets count it, in characters (code points)
+ */
+int xmlLength(const QString& value);
+
+} // namespace XsdQt
+
+#endif // XMLFACETS_H
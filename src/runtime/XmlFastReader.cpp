@@ -0,0 +1,1042 @@
+#include "XmlFastReader.h"
+#include <QtAlgorithms>
+#include <climits>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define XSDQT_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#define XSDQT_HAVE_AVX2
+#include <immintrin.h>
+#endif
+
+namespace XsdQt {
+
+namespace {
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+inline bool startsWith(const char* p, const char* end, const char* literal, int size) {
+    return end - p >= size && std::memcmp(p, literal, size_t(size)) == 0;
+}
+
+/**
+ * First byte in [p, end) equal to one of the six delimiters, or end
+ * (callers needing fewer delimiters repeat one)
+ */
+const char* findAny(const char* p, const char* end, char a, char b, char c, char d, char e, char f) {
+#ifdef XSDQT_HAVE_AVX2
+    {
+        const __m256i va = _mm256_set1_epi8(a);
+        const __m256i vb = _mm256_set1_epi8(b);
+        const __m256i vc = _mm256_set1_epi8(c);
+        const __m256i vd = _mm256_set1_epi8(d);
+        const __m256i ve = _mm256_set1_epi8(e);
+        const __m256i vf = _mm256_set1_epi8(f);
+        while (end - p >= 32) {
+            const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            const __m256i hits = _mm256_or_si256(
+                _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, va), _mm256_cmpeq_epi8(chunk, vb)),
+                                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, vc), _mm256_cmpeq_epi8(chunk, vd))),
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, ve), _mm256_cmpeq_epi8(chunk, vf)));
+            const quint32 mask = quint32(_mm256_movemask_epi8(hits));
+            if (mask) {
+                return p + qCountTrailingZeroBits(mask);
+            }
+            p += 32;
+        }
+    }
+#endif
+#ifdef XSDQT_HAVE_SSE2
+    {
+        const __m128i va = _mm_set1_epi8(a);
+        const __m128i vb = _mm_set1_epi8(b);
+        const __m128i vc = _mm_set1_epi8(c);
+        const __m128i vd = _mm_set1_epi8(d);
+        const __m128i ve = _mm_set1_epi8(e);
+        const __m128i vf = _mm_set1_epi8(f);
+        while (end - p >= 16) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const __m128i hits = _mm_or_si128(
+                _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)),
+                             _mm_or_si128(_mm_cmpeq_epi8(chunk, vc), _mm_cmpeq_epi8(chunk, vd))),
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, ve), _mm_cmpeq_epi8(chunk, vf)));
+            const quint32 mask = quint32(_mm_movemask_epi8(hits));
+            if (mask) {
+                return p + qCountTrailingZeroBits(mask);
+            }
+            p += 16;
+        }
+    }
+#endif
+    for (; p < end; ++p) {
+        const char x = *p;
+        if (x == a || x == b || x == c || x == d || x == e || x == f) {
+            return p;
+        }
+    }
+    return end;
+}
+
+/**
+ * Start of the first occurrence of terminator in [p, end), or null
+ */
+const char* findTerminator(const char* p, const char* end, const char* terminator, int size) {
+    while (end - p >= size) {
+        const char* hit = static_cast<const char*>(std::memchr(p, terminator[0], size_t(end - p)));
+        if (!hit || end - hit < size) {
+            return nullptr;
+        }
+        if (std::memcmp(hit, terminator, size_t(size)) == 0) {
+            return hit;
+        }
+        p = hit + 1;
+    }
+    return nullptr;
+}
+
+void appendUtf8(QByteArray& out, uint ucs4) {
+    if (ucs4 < 0x80) {
+        out.append(char(ucs4));
+    } else if (ucs4 < 0x800) {
+        out.append(char(0xc0 | (ucs4 >> 6)));
+        out.append(char(0x80 | (ucs4 & 0x3f)));
+    } else if (ucs4 < 0x10000) {
+        out.append(char(0xe0 | (ucs4 >> 12)));
+        out.append(char(0x80 | ((ucs4 >> 6) & 0x3f)));
+        out.append(char(0x80 | (ucs4 & 0x3f)));
+    } else {
+        out.append(char(0xf0 | (ucs4 >> 18)));
+        out.append(char(0x80 | ((ucs4 >> 12) & 0x3f)));
+        out.append(char(0x80 | ((ucs4 >> 6) & 0x3f)));
+        out.append(char(0x80 | (ucs4 & 0x3f)));
+    }
+}
+
+/**
+ * Value of "#123" or "#x7B", 0 if malformed or not an XML character
+ */
+uint parseCharacterReference(XmlUtf8View reference) {
+    const char* p = reference.data + 1;
+    const char* const end = reference.data + reference.size;
+    const bool hex = p < end && *p == 'x';
+    if (hex) {
+        ++p;
+    }
+    if (p == end) {
+        return 0;
+    }
+
+    uint value = 0;
+    for (; p < end; ++p) {
+        uint digit;
+        if (*p >= '0' && *p <= '9') {
+            digit = uint(*p - '0');
+        } else if (hex && *p >= 'a' && *p <= 'f') {
+            digit = uint(*p - 'a' + 10);
+        } else if (hex && *p >= 'A' && *p <= 'F') {
+            digit = uint(*p - 'A' + 10);
+        } else {
+            return 0;
+        }
+        value = value * (hex ? 16 : 10) + digit;
+        if (value > 0x10ffff) {
+            return 0;
+        }
+    }
+
+    const bool valid = value == 0x9 || value == 0xa || value == 0xd
+                    || (value >= 0x20 && value <= 0xd7ff)
+                    || (value >= 0xe000 && value <= 0xfffd)
+                    || value >= 0x10000;
+    return valid ? value : 0;
+}
+
+/**
+ * Code point of the UTF-8 sequence at p, and its length; 0 if the sequence
+ * is truncated, overlong, a surrogate or beyond U+10FFFF
+ */
+int decodeUtf8(const char* p, const char* end, uint* ucs4) {
+    const uchar lead = uchar(*p);
+    int length;
+    uint value;
+    uint minimum;
+    if (lead < 0x80) {
+        *ucs4 = lead;
+        return 1;
+    } else if (lead >= 0xc2 && lead <= 0xdf) {
+        length = 2;
+        value = lead & 0x1f;
+        minimum = 0x80;
+    } else if (lead >= 0xe0 && lead <= 0xef) {
+        length = 3;
+        value = lead & 0x0f;
+        minimum = 0x800;
+    } else if (lead >= 0xf0 && lead <= 0xf4) {
+        length = 4;
+        value = lead & 0x07;
+        minimum = 0x10000;
+    } else {
+        return 0;
+    }
+    if (end - p < length) {
+        return 0;
+    }
+    for (int i = 1; i < length; ++i) {
+        const uchar next = uchar(p[i]);
+        if ((next & 0xc0) != 0x80) {
+            return 0;
+        }
+        value = (value << 6) | (next & 0x3f);
+    }
+    if (value < minimum || value > 0x10ffff || (value >= 0xd800 && value <= 0xdfff)) {
+        return 0;
+    }
+    *ucs4 = value;
+    return length;
+}
+
+inline bool isXmlChar(uint ucs4) {
+    return ucs4 >= 0x20 ? ucs4 != 0xfffe && ucs4 != 0xffff
+                        : ucs4 == 0x9 || ucs4 == 0xa || ucs4 == 0xd;
+}
+
+/**
+ * First byte in [p, end) that starts malformed UTF-8 or a character XML
+ * does not allow, or null; ASCII text is checked 16 bytes at a time
+ */
+const char* findInvalidCharacter(const char* p, const char* end) {
+    for (;;) {
+#ifdef XSDQT_HAVE_SSE2
+        // Bytes below 0x20 in a signed compare: controls and all non-ASCII
+        const __m128i space = _mm_set1_epi8(0x20);
+        const __m128i tab = _mm_set1_epi8('\t');
+        const __m128i lf = _mm_set1_epi8('\n');
+        const __m128i cr = _mm_set1_epi8('\r');
+        while (end - p >= 16) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const __m128i allowed = _mm_or_si128(_mm_cmpeq_epi8(chunk, tab),
+                                                 _mm_or_si128(_mm_cmpeq_epi8(chunk, lf), _mm_cmpeq_epi8(chunk, cr)));
+            const quint32 mask = quint32(_mm_movemask_epi8(_mm_andnot_si128(allowed, _mm_cmplt_epi8(chunk, space))));
+            if (mask) {
+                p += qCountTrailingZeroBits(mask);
+                break;
+            }
+            p += 16;
+        }
+#endif
+        if (p >= end) {
+            return nullptr;
+        }
+        uint ucs4;
+        const int length = decodeUtf8(p, end, &ucs4);
+        if (!length || !isXmlChar(ucs4)) {
+            return p;
+        }
+        p += length;
+    }
+}
+
+/**
+ * Bytes ending a name, as in QXmlStreamReader: whitespace and the
+ * delimiters of the XML grammar
+ */
+inline bool isNameDelimiter(uchar c) {
+    switch (c) {
+    case ' ': case '\t': case '\n': case '\r':
+    case '&': case '#': case '\'': case '"': case '<': case '>': case '[': case ']': case '=':
+    case '%': case '/': case ';': case '?': case '!': case '^': case '|': case ',':
+    case '(': case ')': case '+': case '*':
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * Sign and magnitude of a decimal integer, surrounding whitespace ignored;
+ * false if it is not one or the magnitude exceeds limit
+ */
+bool parseInteger(XmlUtf8View text, quint64 limit, bool* negative, quint64* magnitude) {
+    const char* p = text.data;
+    const char* e = text.data + text.size;
+    while (p < e && isSpace(*p)) ++p;
+    while (e > p && isSpace(e[-1])) --e;
+
+    *negative = false;
+    if (p < e && (*p == '-' || *p == '+')) {
+        *negative = *p == '-';
+        ++p;
+    }
+    if (p == e) {
+        return false;
+    }
+
+    quint64 value = 0;
+    for (; p < e; ++p) {
+        if (*p < '0' || *p > '9') {
+            return false;
+        }
+        const quint64 digit = quint64(*p - '0');
+        if (value > (limit - digit) / 10) {
+            return false;
+        }
+        value = value * 10 + digit;
+    }
+    *magnitude = value;
+    return true;
+}
+
+} // namespace
+
+int XmlUtf8View::toInt(bool* ok) const {
+    bool negative = false;
+    quint64 magnitude = 0;
+    const bool parsed = parseInteger(*this, quint64(INT_MAX) + 1, &negative, &magnitude)
+                     && (negative || magnitude <= quint64(INT_MAX));
+    if (ok) *ok = parsed;
+    if (!parsed) {
+        return 0;
+    }
+    return negative ? int(-qint64(magnitude)) : int(magnitude);
+}
+
+qint64 XmlUtf8View::toInt64(bool* ok) const {
+    bool negative = false;
+    quint64 magnitude = 0;
+    const bool parsed = parseInteger(*this, quint64(LLONG_MAX) + 1, &negative, &magnitude)
+                     && (negative || magnitude <= quint64(LLONG_MAX));
+    if (ok) *ok = parsed;
+    if (!parsed) {
+        return 0;
+    }
+    // -2^63 has no positive counterpart, so negate in unsigned arithmetic
+    return negative ? qint64(0 - magnitude) : qint64(magnitude);
+}
+
+quint64 XmlUtf8View::toUInt64(bool* ok) const {
+    bool negative = false;
+    quint64 magnitude = 0;
+    // No sign of negative values, as QString::toULongLong()
+    const bool parsed = parseInteger(*this, ULLONG_MAX, &negative, &magnitude) && !negative;
+    if (ok) *ok = parsed;
+    return parsed ? magnitude : 0;
+}
+
+double XmlUtf8View::toDouble(bool* ok) const {
+    return QByteArray::fromRawData(data, size).toDouble(ok);
+}
+
+// Same spellings the QString overloads in XmlHelpers accept after toLower()
+bool XmlUtf8View::toBool(bool* ok) const {
+    const bool isTrue = *this == "1" || (size == 4 && qstrnicmp(data, "true", 4) == 0);
+    const bool isFalse = *this == "0" || (size == 5 && qstrnicmp(data, "false", 5) == 0);
+    if (ok) *ok = isTrue || isFalse;
+    return isTrue;
+}
+
+XmlFastReader::XmlFastReader() {
+    // Reserving marks the capacity as sticky, so resize(0) keeps it
+    m_attributeBuffer.reserve(256);
+    m_textBuffer.reserve(256);
+    m_elementText.reserve(256);
+    setData(QByteArray());
+}
+
+XmlFastReader::XmlFastReader(const QByteArray& data)
+    : XmlFastReader()
+{
+    setData(data);
+}
+
+void XmlFastReader::setData(const QByteArray& data) {
+    m_data = data;
+    m_begin = m_data.constData();
+    m_pos = m_begin;
+    m_end = m_begin + m_data.size();
+    m_invalidCharacter = findInvalidCharacter(m_begin, m_end);
+
+    m_token = NoToken;
+    m_pendingEnd = false;
+    m_isCData = false;
+    m_rootClosed = false;
+    m_unsupported = false;
+    m_errorString.clear();
+
+    m_qualifiedName = XmlUtf8View();
+    m_prefix = XmlUtf8View();
+    m_localName = XmlUtf8View();
+    m_text = XmlUtf8View();
+
+    m_openElements.resize(0);
+    m_attributes.resize(0);
+    m_decodedValues.resize(0);
+    m_namespaces.resize(0);
+    m_decodedUris.clear();
+}
+
+bool XmlFastReader::canRead(const QByteArray& data) {
+    const char* p = data.constData();
+    const char* const end = p + data.size();
+
+    if (end - p >= 2) {
+        const uchar b0 = uchar(p[0]);
+        const uchar b1 = uchar(p[1]);
+        // UTF-16/32 byte order marks, or UTF-16 without one
+        if ((b0 == 0xfe && b1 == 0xff) || (b0 == 0xff && b1 == 0xfe) || b0 == 0 || b1 == 0) {
+            return false;
+        }
+    }
+    if (startsWith(p, end, "\xef\xbb\xbf", 3)) {
+        p += 3;
+    }
+    if (!startsWith(p, end, "<?xml", 5)) {
+        return true;
+    }
+
+    const char* close = findTerminator(p, end, "?>", 2);
+    if (!close) {
+        return true; // let the parser report it
+    }
+    const char* encoding = findTerminator(p, close, "encoding", 8);
+    if (!encoding) {
+        return true;
+    }
+    p = encoding + 8;
+    while (p < close && (isSpace(*p) || *p == '=')) ++p;
+    if (p == close || (*p != '"' && *p != '\'')) {
+        return true;
+    }
+    const char quote = *p++;
+    const char* valueEnd = static_cast<const char*>(std::memchr(p, quote, size_t(close - p)));
+    if (!valueEnd) {
+        return true;
+    }
+
+    const QByteArray name = QByteArray(p, int(valueEnd - p)).toLower();
+    return name == "utf-8" || name == "utf8" || name == "us-ascii" || name == "ascii";
+}
+
+bool XmlFastReader::isWhitespace() const {
+    if (m_token != Characters || m_isCData) {
+        return false;
+    }
+    for (int i = 0; i < m_text.size; ++i) {
+        if (!isSpace(m_text.data[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+XmlFastReader::TokenType XmlFastReader::readNext() {
+    if (m_token == Invalid || m_token == EndDocument) {
+        return m_token;
+    }
+
+    // Declarations of the element just closed stay visible on its EndElement
+    popNamespaces();
+
+    if (m_pendingEnd) {
+        // Second half of <name/>; the name views are still current
+        m_pendingEnd = false;
+        m_attributes.resize(0);
+        m_openElements.removeLast();
+        m_rootClosed = m_openElements.isEmpty();
+        m_token = EndElement;
+        return m_token;
+    }
+
+    if (m_token == NoToken && readStartDocument()) {
+        return checkCharacters();
+    }
+    if (m_token == Invalid) {
+        return m_token;
+    }
+    readToken();
+    return checkCharacters();
+}
+
+XmlFastReader::TokenType XmlFastReader::checkCharacters() {
+    // The input was scanned once by setData(); fail at the character once a token reaches it
+    if (!m_invalidCharacter || m_pos <= m_invalidCharacter || m_token == Invalid) {
+        return m_token;
+    }
+    m_pos = m_invalidCharacter;
+    uint ucs4;
+    if (decodeUtf8(m_invalidCharacter, m_end, &ucs4)) {
+        return fail(QStringLiteral("Invalid XML character."));
+    }
+    return fail(QStringLiteral("Encountered incorrectly encoded content."));
+}
+
+bool XmlFastReader::readStartDocument() {
+    if (startsWith(m_pos, m_end, "\xef\xbb\xbf", 3)) {
+        m_pos += 3;
+    }
+    if (!startsWith(m_pos, m_end, "<?xml", 5) || m_end - m_pos < 6 || !isSpace(m_pos[5])) {
+        return false;
+    }
+
+    const char* close = findTerminator(m_pos, m_end, "?>", 2);
+    if (!close) {
+        fail(QStringLiteral("Premature end of document."));
+        return false;
+    }
+    m_pos = close + 2;
+    m_token = StartDocument;
+    return true;
+}
+
+XmlFastReader::TokenType XmlFastReader::readToken() {
+    m_isCData = false;
+
+    if (m_pos >= m_end) {
+        if (!m_openElements.isEmpty() || !m_rootClosed) {
+            return fail(QStringLiteral("Premature end of document."));
+        }
+        m_token = EndDocument;
+        return m_token;
+    }
+    if (*m_pos == '<') {
+        return readMarkup();
+    }
+    return readText();
+}
+
+XmlFastReader::TokenType XmlFastReader::readMarkup() {
+    const char* p = m_pos + 1;
+    if (p >= m_end) {
+        return fail(QStringLiteral("Premature end of document."));
+    }
+
+    switch (*p) {
+    case '/':
+        return readEndElement();
+    case '?':
+        return readDelimited("?>", 2, 2, ProcessingInstruction);
+    case '!':
+        if (startsWith(p, m_end, "!--", 3)) {
+            return readDelimited("-->", 3, 4, Comment);
+        }
+        if (startsWith(p, m_end, "![CDATA[", 8)) {
+            if (m_openElements.isEmpty()) {
+                return fail(QStringLiteral("Start tag expected."));
+            }
+            return readDelimited("]]>", 3, 9, Characters);
+        }
+        if (startsWith(p, m_end, "!DOCTYPE", 8)) {
+            raiseUnsupported(QStringLiteral("DTDs are not supported by the fast reader."));
+            return m_token;
+        }
+        return fail(QStringLiteral("Unexpected markup."));
+    default:
+        return readStartElement();
+    }
+}
+
+XmlFastReader::TokenType XmlFastReader::readStartElement() {
+    ++m_pos;
+
+    XmlUtf8View qualifiedName;
+    if (!readName(&qualifiedName)) {
+        return fail(QStringLiteral("Invalid element name."));
+    }
+    if (m_openElements.isEmpty() && m_rootClosed) {
+        return fail(QStringLiteral("Extra content at end of document."));
+    }
+
+    bool empty = false;
+    if (!readAttributes(&empty)) {
+        return m_token;
+    }
+
+    // Prefixes may be declared by the element's own attributes, read above
+    m_qualifiedName = qualifiedName;
+    splitName(qualifiedName, &m_prefix, &m_localName);
+    if (!m_prefix.isEmpty() && !isDeclared(m_prefix)) {
+        return fail(QStringLiteral("Namespace prefix '%1' not declared").arg(m_prefix.toString()));
+    }
+    for (int i = 0; i < m_attributes.size(); ++i) {
+        const XmlUtf8View prefix = m_attributes.at(i).prefix;
+        if (!prefix.isEmpty() && prefix != "xmlns" && !isDeclared(prefix)) {
+            return fail(QStringLiteral("Namespace prefix '%1' not declared").arg(prefix.toString()));
+        }
+    }
+    m_openElements.append(qualifiedName);
+    m_pendingEnd = empty;
+    m_token = StartElement;
+    return m_token;
+}
+
+XmlFastReader::TokenType XmlFastReader::readEndElement() {
+    m_pos += 2;
+
+    XmlUtf8View qualifiedName;
+    if (!readName(&qualifiedName)) {
+        return fail(QStringLiteral("Invalid element name."));
+    }
+    while (m_pos < m_end && isSpace(*m_pos)) ++m_pos;
+    if (m_pos >= m_end) {
+        return fail(QStringLiteral("Premature end of document."));
+    }
+    if (*m_pos != '>') {
+        return fail(QStringLiteral("Expected '>'."));
+    }
+    ++m_pos;
+
+    if (m_openElements.isEmpty() || m_openElements.last() != qualifiedName) {
+        return fail(QStringLiteral("Opening and ending tag mismatch."));
+    }
+
+    m_qualifiedName = qualifiedName;
+    splitName(qualifiedName, &m_prefix, &m_localName);
+    m_attributes.resize(0);
+    m_openElements.removeLast();
+    m_rootClosed = m_openElements.isEmpty();
+    m_token = EndElement;
+    return m_token;
+}
+
+XmlFastReader::TokenType XmlFastReader::readText() {
+    const char* start = m_pos;
+    const char* stop = findAny(m_pos, m_end, '<', '&', '\r', '<', '<', '<');
+    const char* close = stop == m_end || *stop == '<'
+        ? stop : static_cast<const char*>(std::memchr(stop, '<', size_t(m_end - stop)));
+    if (!close) {
+        close = m_end;
+    }
+    if (findTerminator(start, close, "]]>", 3)) {
+        return fail(QStringLiteral("Sequence ']]>' not allowed in content."));
+    }
+
+    if (stop == m_end || *stop == '<') {
+        // Common case: the text is a view into the input
+        m_text = XmlUtf8View(start, int(stop - start));
+        m_pos = stop;
+    } else {
+        m_textBuffer.resize(0);
+        m_textBuffer.append(start, int(stop - start));
+        if (!decode(stop, close, m_textBuffer, false)) {
+            return m_token;
+        }
+        m_text = XmlUtf8View(m_textBuffer.constData(), m_textBuffer.size());
+        m_pos = close;
+    }
+
+    if (m_openElements.isEmpty()) {
+        // Only whitespace may surround the root element, and it is not reported
+        for (int i = 0; i < m_text.size; ++i) {
+            if (!isSpace(m_text.data[i])) {
+                return fail(m_rootClosed ? QStringLiteral("Extra content at end of document.")
+                                         : QStringLiteral("Start tag expected."));
+            }
+        }
+        return readToken();
+    }
+
+    m_token = Characters;
+    return m_token;
+}
+
+XmlFastReader::TokenType XmlFastReader::readDelimited(const char* terminator, int terminatorSize,
+                                                      int skip, TokenType token) {
+    const char* start = m_pos + skip;
+    const char* stop = findTerminator(start, m_end, terminator, terminatorSize);
+    if (!stop) {
+        return fail(QStringLiteral("Premature end of document."));
+    }
+
+    if (token == Characters && std::memchr(start, '\r', size_t(stop - start))) {
+        // CDATA keeps entities literal but line ends are still normalized
+        m_textBuffer.resize(0);
+        for (const char* p = start; p < stop; ++p) {
+            if (*p == '\r') {
+                if (p + 1 < stop && p[1] == '\n') {
+                    ++p;
+                }
+                m_textBuffer.append('\n');
+            } else {
+                m_textBuffer.append(*p);
+            }
+        }
+        m_text = XmlUtf8View(m_textBuffer.constData(), m_textBuffer.size());
+    } else {
+        m_text = XmlUtf8View(start, int(stop - start));
+    }
+
+    m_pos = stop + terminatorSize;
+    m_isCData = token == Characters;
+    m_token = token;
+    return m_token;
+}
+
+XmlFastReader::TokenType XmlFastReader::fail(const QString& message) {
+    m_errorString = message;
+    m_token = Invalid;
+    return m_token;
+}
+
+void XmlFastReader::raiseError(const QString& message) {
+    if (m_token != Invalid) {
+        fail(message);
+    }
+}
+
+void XmlFastReader::raiseUnsupported(const QString& message) {
+    m_unsupported = true;
+    raiseError(message);
+}
+
+bool XmlFastReader::readName(XmlUtf8View* qualifiedName) {
+    // QXmlStreamReader's rules: a letter, '_' or non-ASCII character, then
+    // anything up to a delimiter, with at most one colon between two parts
+    const char* start = m_pos;
+    const char* colon = nullptr;
+    while (m_pos < m_end) {
+        const uchar c = uchar(*m_pos);
+        const bool first = m_pos == start || m_pos - 1 == colon;
+        if (c == ':') {
+            if (colon || first) {
+                return false;
+            }
+            colon = m_pos++;
+        } else if (c < 0x80) {
+            if (isNameDelimiter(c)) {
+                break;
+            }
+            if (first && !((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_')) {
+                return false;
+            }
+            ++m_pos;
+        } else {
+            uint ucs4;
+            const int length = decodeUtf8(m_pos, m_end, &ucs4);
+            if (!length) {
+                return false;
+            }
+            m_pos += length;
+        }
+    }
+    *qualifiedName = XmlUtf8View(start, int(m_pos - start));
+    return m_pos > start && m_pos - 1 != colon;
+}
+
+bool XmlFastReader::readAttributes(bool* emptyElement) {
+    m_attributes.resize(0);
+    m_decodedValues.resize(0);
+    m_attributeBuffer.resize(0);
+    *emptyElement = false;
+
+    for (;;) {
+        const char* before = m_pos;
+        while (m_pos < m_end && isSpace(*m_pos)) ++m_pos;
+        if (m_pos >= m_end) {
+            fail(QStringLiteral("Premature end of document."));
+            return false;
+        }
+        if (*m_pos == '>') {
+            ++m_pos;
+            break;
+        }
+        if (*m_pos == '/') {
+            if (m_pos + 1 < m_end && m_pos[1] == '>') {
+                m_pos += 2;
+                *emptyElement = true;
+                break;
+            }
+            fail(QStringLiteral("Expected '>'."));
+            return false;
+        }
+        if (m_pos == before) {
+            fail(QStringLiteral("Expected whitespace before attribute."));
+            return false;
+        }
+
+        XmlFastAttribute attribute;
+        if (!readName(&attribute.qualifiedName)) {
+            fail(QStringLiteral("Invalid attribute name."));
+            return false;
+        }
+        while (m_pos < m_end && isSpace(*m_pos)) ++m_pos;
+        if (m_pos >= m_end || *m_pos != '=') {
+            fail(QStringLiteral("Expected '=' after attribute name."));
+            return false;
+        }
+        ++m_pos;
+        while (m_pos < m_end && isSpace(*m_pos)) ++m_pos;
+        if (m_pos >= m_end || (*m_pos != '"' && *m_pos != '\'')) {
+            fail(QStringLiteral("Expected quoted attribute value."));
+            return false;
+        }
+
+        const char quote = *m_pos++;
+        const char* start = m_pos;
+        const char* stop = findAny(m_pos, m_end, quote, '&', '<', '\t', '\n', '\r');
+        if (stop == m_end) {
+            fail(QStringLiteral("Premature end of document."));
+            return false;
+        }
+        if (*stop == '<') {
+            fail(QStringLiteral("'<' not allowed in attribute value."));
+            return false;
+        }
+
+        int decodedOffset = -1;
+        if (*stop == quote) {
+            attribute.value = XmlUtf8View(start, int(stop - start));
+            m_pos = stop + 1;
+        } else {
+            const char* close = static_cast<const char*>(std::memchr(stop, quote, size_t(m_end - stop)));
+            if (!close) {
+                fail(QStringLiteral("Premature end of document."));
+                return false;
+            }
+            // Pointer fixed up below, the buffer may still reallocate
+            decodedOffset = m_attributeBuffer.size();
+            m_attributeBuffer.append(start, int(stop - start));
+            if (!decode(stop, close, m_attributeBuffer, true)) {
+                return false;
+            }
+            attribute.value = XmlUtf8View(nullptr, m_attributeBuffer.size() - decodedOffset);
+            m_pos = close + 1;
+        }
+
+        for (int i = 0; i < m_attributes.size(); ++i) {
+            if (m_attributes.at(i).qualifiedName == attribute.qualifiedName) {
+                fail(QStringLiteral("Attribute '%1' redefined.").arg(attribute.qualifiedName.toString()));
+                return false;
+            }
+        }
+
+        splitName(attribute.qualifiedName, &attribute.prefix, &attribute.name);
+        m_attributes.append(attribute);
+        m_decodedValues.append(decodedOffset);
+    }
+
+    const int depth = m_openElements.size() + 1;
+    for (int i = 0; i < m_attributes.size(); ++i) {
+        XmlFastAttribute& attribute = m_attributes[i];
+        if (m_decodedValues.at(i) >= 0) {
+            attribute.value.data = m_attributeBuffer.constData() + m_decodedValues.at(i);
+        }
+
+        NamespaceDeclaration declaration;
+        if (attribute.qualifiedName == "xmlns") {
+            declaration.prefix = XmlUtf8View();
+        } else if (attribute.prefix == "xmlns") {
+            declaration.prefix = attribute.name;
+        } else {
+            continue;
+        }
+        if (m_decodedValues.at(i) >= 0) {
+            // The attribute buffer is reused by the next element
+            m_decodedUris.append(attribute.value.toByteArray());
+            declaration.uri = XmlUtf8View(m_decodedUris.last().constData(), m_decodedUris.last().size());
+        } else {
+            declaration.uri = attribute.value;
+        }
+        declaration.depth = depth;
+        m_namespaces.append(declaration);
+    }
+    return true;
+}
+
+bool XmlFastReader::decode(const char* from, const char* to, QByteArray& out, bool attributeValue) {
+    const char* p = from;
+    while (p < to) {
+        const char c = *p;
+        if (c == '&') {
+            const char* semicolon = static_cast<const char*>(std::memchr(p, ';', size_t(to - p)));
+            if (!semicolon) {
+                fail(QStringLiteral("Unterminated entity reference."));
+                return false;
+            }
+            const XmlUtf8View entity(p + 1, int(semicolon - p - 1));
+            if (entity == "lt") {
+                out.append('<');
+            } else if (entity == "gt") {
+                out.append('>');
+            } else if (entity == "amp") {
+                out.append('&');
+            } else if (entity == "quot") {
+                out.append('"');
+            } else if (entity == "apos") {
+                out.append('\'');
+            } else if (entity.size > 1 && entity.data[0] == '#') {
+                const uint ucs4 = parseCharacterReference(entity);
+                if (!ucs4) {
+                    fail(QStringLiteral("Invalid character reference."));
+                    return false;
+                }
+                appendUtf8(out, ucs4);
+            } else {
+                fail(QStringLiteral("Entity '%1' not declared.").arg(entity.toString()));
+                return false;
+            }
+            p = semicolon + 1;
+        } else if (c == '\r') {
+            if (p + 1 < to && p[1] == '\n') {
+                ++p;
+            }
+            out.append(attributeValue ? ' ' : '\n');
+            ++p;
+        } else if (attributeValue && (c == '\t' || c == '\n')) {
+            out.append(' ');
+            ++p;
+        } else if (attributeValue && c == '<') {
+            fail(QStringLiteral("'<' not allowed in attribute value."));
+            return false;
+        } else {
+            const char* next = attributeValue ? findAny(p, to, '&', '\r', '\t', '\n', '<', '&')
+                                              : findAny(p, to, '&', '\r', '&', '&', '&', '&');
+            out.append(p, int(next - p));
+            p = next;
+        }
+    }
+    return true;
+}
+
+void XmlFastReader::popNamespaces() {
+    while (!m_namespaces.isEmpty() && m_namespaces.last().depth > m_openElements.size()) {
+        m_namespaces.removeLast();
+    }
+}
+
+XmlUtf8View XmlFastReader::resolvePrefix(XmlUtf8View prefix, bool useDefault) const {
+    if (prefix.isEmpty() && !useDefault) {
+        return XmlUtf8View();
+    }
+    if (prefix == "xml") {
+        static const char xmlUri[] = "http://www.w3.org/XML/1998/namespace";
+        return XmlUtf8View(xmlUri, int(sizeof(xmlUri) - 1));
+    }
+    for (int i = m_namespaces.size() - 1; i >= 0; --i) {
+        if (m_namespaces.at(i).prefix == prefix) {
+            return m_namespaces.at(i).uri;
+        }
+    }
+    return XmlUtf8View();
+}
+
+bool XmlFastReader::isDeclared(XmlUtf8View prefix) const {
+    if (prefix == "xml") {
+        return true;
+    }
+    for (int i = m_namespaces.size() - 1; i >= 0; --i) {
+        if (m_namespaces.at(i).prefix == prefix) {
+            return true;
+        }
+    }
+    return false;
+}
+
+XmlUtf8View XmlFastReader::attributeNamespaceUri(int index) const {
+    return resolvePrefix(m_attributes.at(index).prefix, false);
+}
+
+int XmlFastReader::indexOfAttribute(XmlUtf8View qualifiedName) const {
+    for (int i = 0; i < m_attributes.size(); ++i) {
+        if (m_attributes.at(i).qualifiedName == qualifiedName) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+XmlUtf8View XmlFastReader::attributeValue(XmlUtf8View qualifiedName) const {
+    const int index = indexOfAttribute(qualifiedName);
+    return index >= 0 ? m_attributes.at(index).value : XmlUtf8View();
+}
+
+XmlUtf8View XmlFastReader::readElementTextView() {
+    if (m_token != StartElement) {
+        raiseError(QStringLiteral("Expected a start element."));
+        return XmlUtf8View();
+    }
+
+    XmlUtf8View result;
+    bool concatenated = false;
+    for (;;) {
+        switch (readNext()) {
+        case Characters:
+            if (concatenated) {
+                m_elementText.append(m_text.data, m_text.size);
+                result = XmlUtf8View(m_elementText.constData(), m_elementText.size());
+            } else if (result.isEmpty() && m_text.data != m_textBuffer.constData()) {
+                // Single run of plain text: no copy
+                result = m_text;
+            } else {
+                // Decoded text is overwritten by the next token, so collect from here on
+                m_elementText.resize(0);
+                m_elementText.append(result.data, result.size);
+                m_elementText.append(m_text.data, m_text.size);
+                result = XmlUtf8View(m_elementText.constData(), m_elementText.size());
+                concatenated = true;
+            }
+            break;
+        case Comment:
+        case ProcessingInstruction:
+            break;
+        case EndElement:
+            return result;
+        case StartElement:
+            raiseError(QStringLiteral("Expected character data."));
+            return XmlUtf8View();
+        default:
+            return XmlUtf8View();
+        }
+    }
+}
+
+void XmlFastReader::skipCurrentElement() {
+    int depth = 1;
+    while (depth && readNext() != Invalid && m_token != EndDocument) {
+        if (m_token == StartElement) {
+            ++depth;
+        } else if (m_token == EndElement) {
+            --depth;
+        }
+    }
+}
+
+qint64 XmlFastReader::lineNumber() const {
+    qint64 line = 1;
+    for (const char* p = m_begin; p < m_pos; ++p) {
+        if (*p == '\n') {
+            ++line;
+        }
+    }
+    return line;
+}
+
+qint64 XmlFastReader::columnNumber() const {
+    // Of the read position, in UTF-16 code units like QXmlStreamReader:
+    // one per lead byte, two for the four-byte sequences beyond the BMP
+    qint64 column = 0;
+    for (const char* p = m_pos; p > m_begin && p[-1] != '\n'; --p) {
+        const uchar c = uchar(p[-1]);
+        if ((c & 0xc0) != 0x80) {
+            column += c >= 0xf0 ? 2 : 1;
+        }
+    }
+    return column;
+}
+
+void XmlFastReader::splitName(XmlUtf8View qualifiedName, XmlUtf8View* prefix, XmlUtf8View* localName) {
+    const char* colon = static_cast<const char*>(std::memchr(qualifiedName.data, ':', size_t(qualifiedName.size)));
+    if (colon) {
+        const int prefixSize = int(colon - qualifiedName.data);
+        *prefix = XmlUtf8View(qualifiedName.data, prefixSize);
+        *localName = XmlUtf8View(colon + 1, qualifiedName.size - prefixSize - 1);
+    } else {
+        *prefix = XmlUtf8View();
+        *localName = qualifiedName;
+    }
+}
+
+} // namespace XsdQt
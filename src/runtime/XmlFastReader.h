@@ -0,0 +1,226 @@
+#ifndef XMLFASTREADER_H
+#define XMLFASTREADER_H
+
+#include <QByteArray>
+#include <QLatin1String>
+#include <QString>
+#include <QVector>
+#include <cstddef>
+#include <cstring>
+
+namespace XsdQt {
+
+/**
+ * Non-owning view of UTF-8 bytes inside the reader's input or buffers
+ * Valid until the reader advances past the token it came from
+ */
+struct XmlUtf8View {
+    constexpr XmlUtf8View() : data(nullptr), size(0) {}
+    constexpr XmlUtf8View(const char* data, int size) : data(data), size(size) {}
+    template<std::size_t N>
+    constexpr XmlUtf8View(const char (&literal)[N]) : data(literal), size(int(N - 1)) {}
+
+    bool isEmpty() const { return size == 0; }
+    QString toString() const { return QString::fromUtf8(data, size); }
+    QByteArray toByteArray() const { return QByteArray(data, size); }
+
+    /**
+     * Number conversions without an intermediate QString
+     * (surrounding whitespace is ignored, like QString::toInt())
+     */
+    int toInt(bool* ok = nullptr) const;
+    qint64 toInt64(bool* ok = nullptr) const;
+    quint64 toUInt64(bool* ok = nullptr) const;
+    double toDouble(bool* ok = nullptr) const;
+    bool toBool(bool* ok = nullptr) const;   // true/false (any case), 1/0
+
+    bool operator==(XmlUtf8View other) const {
+        return size == other.size && (size == 0 || std::memcmp(data, other.data, size_t(size)) == 0);
+    }
+    bool operator!=(XmlUtf8View other) const { return !(*this == other); }
+
+    bool operator==(QLatin1String other) const {
+        return size == other.size() && (size == 0 || std::memcmp(data, other.data(), size_t(size)) == 0);
+    }
+    bool operator!=(QLatin1String other) const { return !(*this == other); }
+
+    template<std::size_t N>
+    bool operator==(const char (&literal)[N]) const { return *this == XmlUtf8View(literal); }
+    template<std::size_t N>
+    bool operator!=(const char (&literal)[N]) const { return !(*this == literal); }
+
+    const char* data;
+    int size;
+};
+
+/**
+ * Attribute of the current start element
+ */
+struct XmlFastAttribute {
+    XmlUtf8View qualifiedName;
+    XmlUtf8View prefix;
+    XmlUtf8View name;   // local name
+    XmlUtf8View value;  // entities and whitespace already normalized
+};
+
+/**
+ * Pull parser over UTF-8 input for generated fromXml code
+ *
+ * Offers the subset of the QXmlStreamReader interface the generated code
+ * and XmlHelpers use, but scans the raw bytes instead of decoding to
+ * UTF-16 first: markup and entity delimiters are located 16 (SSE2) or
+ * 32 (AVX2) bytes at a time, and names, attribute values and text are
+ * returned as views into the input. Only text containing entity or
+ * character references or carriage returns is copied.
+ *
+ * Documents with a DTD or an encoding other than UTF-8/ASCII are not
+ * supported: canRead() rejects them up front, and a DOCTYPE met while
+ * parsing sets isUnsupported() so callers can retry with QXmlStreamReader.
+ *
+ * Otherwise it rejects what QXmlStreamReader rejects, with its messages
+ * where it has one: malformed UTF-8 and characters XML does not allow
+ * (found by one pass over the input in setData()), names that don't start
+ * with a letter or hold more than one colon, undeclared namespace prefixes
+ * and "]]>" in text. Like QXmlStreamReader, it does not check the later
+ * characters of a name against the XML name classes.
+ */
+class XmlFastReader {
+public:
+    enum TokenType {
+        NoToken = 0,
+        Invalid,
+        StartDocument,
+        EndDocument,
+        StartElement,
+        EndElement,
+        Characters,
+        Comment,
+        ProcessingInstruction
+    };
+
+    XmlFastReader();
+    explicit XmlFastReader(const QByteArray& data);
+
+    /**
+     * Restart on new input (shared, not copied); buffers are kept
+     */
+    void setData(const QByteArray& data);
+
+    /**
+     * Cheap check of BOM and XML declaration
+     * False if the input needs QXmlStreamReader (non UTF-8 encoding)
+     */
+    static bool canRead(const QByteArray& data);
+
+    TokenType readNext();
+    TokenType tokenType() const { return m_token; }
+
+    bool atEnd() const { return m_token == EndDocument || m_token == Invalid; }
+    bool isStartElement() const { return m_token == StartElement; }
+    bool isEndElement() const { return m_token == EndElement; }
+    bool isCharacters() const { return m_token == Characters; }
+    bool isWhitespace() const;
+    bool isCDATA() const { return m_token == Characters && m_isCData; }
+
+    XmlUtf8View name() const { return m_localName; }
+    XmlUtf8View qualifiedName() const { return m_qualifiedName; }
+    XmlUtf8View prefix() const { return m_prefix; }
+    XmlUtf8View namespaceUri() const { return resolvePrefix(m_prefix, true); }
+    XmlUtf8View text() const { return m_text; }
+
+    int attributeCount() const { return m_attributes.size(); }
+    const XmlFastAttribute& attribute(int index) const { return m_attributes.at(index); }
+    XmlUtf8View attributeNamespaceUri(int index) const;
+
+    /**
+     * Attribute by qualified name, index or -1
+     */
+    int indexOfAttribute(XmlUtf8View qualifiedName) const;
+    bool hasAttribute(XmlUtf8View qualifiedName) const { return indexOfAttribute(qualifiedName) >= 0; }
+    XmlUtf8View attributeValue(XmlUtf8View qualifiedName) const;
+
+    /**
+     * Text up to the end of the current element; an error is raised
+     * if a child element is found (QXmlStreamReader::ErrorOnUnexpectedElement)
+     */
+    XmlUtf8View readElementTextView();
+    QString readElementText() { return readElementTextView().toString(); }
+
+    /**
+     * Skip to the end of the current element
+     */
+    void skipCurrentElement();
+
+    bool hasError() const { return m_token == Invalid; }
+    QString errorString() const { return m_errorString; }
+    void raiseError(const QString& message);
+
+    /**
+     * Set by types without a fast reader implementation and for DTDs;
+     * the document should be re-read with QXmlStreamReader
+     */
+    bool isUnsupported() const { return m_unsupported; }
+    void raiseUnsupported(const QString& message);
+
+    qint64 lineNumber() const;
+    qint64 columnNumber() const;
+    qint64 characterOffset() const { return qint64(m_pos - m_begin); }
+
+private:
+    struct NamespaceDeclaration {
+        XmlUtf8View prefix;
+        XmlUtf8View uri;
+        int depth;
+    };
+
+    bool readStartDocument();
+    TokenType readToken();
+    TokenType readMarkup();
+    TokenType readStartElement();
+    TokenType readEndElement();
+    TokenType readText();
+    TokenType readDelimited(const char* terminator, int terminatorSize, int skip, TokenType token);
+    TokenType fail(const QString& message);
+    TokenType checkCharacters();
+
+    bool readName(XmlUtf8View* qualifiedName);
+    bool readAttributes(bool* emptyElement);
+    bool decode(const char* from, const char* to, QByteArray& out, bool attributeValue);
+    void popNamespaces();
+    XmlUtf8View resolvePrefix(XmlUtf8View prefix, bool useDefault) const;
+    bool isDeclared(XmlUtf8View prefix) const;
+
+    static void splitName(XmlUtf8View qualifiedName, XmlUtf8View* prefix, XmlUtf8View* localName);
+
+    QByteArray m_data;
+    const char* m_begin;
+    const char* m_pos;
+    const char* m_end;
+    const char* m_invalidCharacter;   // first malformed byte or disallowed character, or null
+
+    TokenType m_token;
+    bool m_pendingEnd;
+    bool m_isCData;
+    bool m_rootClosed;
+    bool m_unsupported;
+    QString m_errorString;
+
+    XmlUtf8View m_qualifiedName;
+    XmlUtf8View m_prefix;
+    XmlUtf8View m_localName;
+    XmlUtf8View m_text;
+
+    QVector<XmlUtf8View> m_openElements;
+    QVector<XmlFastAttribute> m_attributes;
+    QVector<int> m_decodedValues;   // offsets into m_attributeBuffer, -1 if raw
+    QVector<NamespaceDeclaration> m_namespaces;
+    QVector<QByteArray> m_decodedUris;
+
+    QByteArray m_attributeBuffer;   // decoded attribute values of the current element
+    QByteArray m_textBuffer;        // decoded text of the current token
+    QByteArray m_elementText;       // readElementTextView() concatenation
+};
+
+} // namespace XsdQt
+
+#endif // XMLFASTREADER_H
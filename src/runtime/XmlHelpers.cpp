@@ -6,51 +6,165 @@ QString XmlHelpers::readElementText(QXmlStreamReader& reader) {
     return reader.readElementText();
 }
 
-int XmlHelpers::readInt(QXmlStreamReader& reader, bool* ok) {
+int XmlHelpers::readInt(QXmlStreamReader& reader, bool* ok, QString* invalidText) {
     QString text = reader.readElementText();
-    return text.toInt(ok);
+    bool converted = false;
+    const int value = text.toInt(&converted);
+    if (ok) *ok = converted;
+    if (!converted && invalidText) *invalidText = text;
+    return value;
 }
 
-double XmlHelpers::readDouble(QXmlStreamReader& reader, bool* ok) {
+qint64 XmlHelpers::readInt64(QXmlStreamReader& reader, bool* ok, QString* invalidText) {
     QString text = reader.readElementText();
-    return text.toDouble(ok);
+    bool converted = false;
+    const qint64 value = text.toLongLong(&converted);
+    if (ok) *ok = converted;
+    if (!converted && invalidText) *invalidText = text;
+    return value;
 }
 
-bool XmlHelpers::readBool(QXmlStreamReader& reader, bool* ok) {
-    QString text = reader.readElementText().toLower();
+quint64 XmlHelpers::readUInt64(QXmlStreamReader& reader, bool* ok, QString* invalidText) {
+    QString text = reader.readElementText();
+    bool converted = false;
+    const quint64 value = text.toULongLong(&converted);
+    if (ok) *ok = converted;
+    if (!converted && invalidText) *invalidText = text;
+    return value;
+}
+
+double XmlHelpers::readDouble(QXmlStreamReader& reader, bool* ok, QString* invalidText) {
+    QString text = reader.readElementText();
+    bool converted = false;
+    const double value = text.toDouble(&converted);
+    if (ok) *ok = converted;
+    if (!converted && invalidText) *invalidText = text;
+    return value;
+}
+
+bool XmlHelpers::readBool(QXmlStreamReader& reader, bool* ok, QString* invalidText) {
+    QString text = reader.readElementText();
+    const QString lower = text.toLower();
     if (ok) *ok = true;
     
-    if (text == "true" || text == "1") {
+    if (lower == "true" || lower == "1") {
         return true;
-    } else if (text == "false" || text == "0") {
+    } else if (lower == "false" || lower == "0") {
         return false;
     }
     
     if (ok) *ok = false;
+    if (invalidText) *invalidText = text;
     return false;
 }
 
-QDateTime XmlHelpers::readDateTime(QXmlStreamReader& reader, bool* ok) {
+QDateTime XmlHelpers::readDateTime(QXmlStreamReader& reader, bool* ok, QString* invalidText) {
     QString text = reader.readElementText();
     QDateTime dt = QDateTime::fromString(text, Qt::ISODate);
     if (ok) *ok = dt.isValid();
+    if (!dt.isValid() && invalidText) *invalidText = text;
     return dt;
 }
 
-QDate XmlHelpers::readDate(QXmlStreamReader& reader, bool* ok) {
+QDate XmlHelpers::readDate(QXmlStreamReader& reader, bool* ok, QString* invalidText) {
     QString text = reader.readElementText();
     QDate date = QDate::fromString(text, Qt::ISODate);
     if (ok) *ok = date.isValid();
+    if (!date.isValid() && invalidText) *invalidText = text;
     return date;
 }
 
-QTime XmlHelpers::readTime(QXmlStreamReader& reader, bool* ok) {
+QTime XmlHelpers::readTime(QXmlStreamReader& reader, bool* ok, QString* invalidText) {
     QString text = reader.readElementText();
     QTime time = QTime::fromString(text, Qt::ISODate);
     if (ok) *ok = time.isValid();
+    if (!time.isValid() && invalidText) *invalidText = text;
     return time;
 }
 
+QString XmlHelpers::readElementText(XmlFastReader& reader) {
+    return reader.readElementText();
+}
+
+int XmlHelpers::readInt(XmlFastReader& reader, bool* ok, QString* invalidText) {
+    const XmlUtf8View text = reader.readElementTextView();
+    bool converted = false;
+    const int value = text.toInt(&converted);
+    if (ok) *ok = converted;
+    if (!converted && invalidText) *invalidText = text.toString();
+    return value;
+}
+
+qint64 XmlHelpers::readInt64(XmlFastReader& reader, bool* ok, QString* invalidText) {
+    const XmlUtf8View text = reader.readElementTextView();
+    bool converted = false;
+    const qint64 value = text.toInt64(&converted);
+    if (ok) *ok = converted;
+    if (!converted && invalidText) *invalidText = text.toString();
+    return value;
+}
+
+quint64 XmlHelpers::readUInt64(XmlFastReader& reader, bool* ok, QString* invalidText) {
+    const XmlUtf8View text = reader.readElementTextView();
+    bool converted = false;
+    const quint64 value = text.toUInt64(&converted);
+    if (ok) *ok = converted;
+    if (!converted && invalidText) *invalidText = text.toString();
+    return value;
+}
+
+double XmlHelpers::readDouble(XmlFastReader& reader, bool* ok, QString* invalidText) {
+    const XmlUtf8View text = reader.readElementTextView();
+    bool converted = false;
+    const double value = text.toDouble(&converted);
+    if (ok) *ok = converted;
+    if (!converted && invalidText) *invalidText = text.toString();
+    return value;
+}
+
+bool XmlHelpers::readBool(XmlFastReader& reader, bool* ok, QString* invalidText) {
+    const XmlUtf8View text = reader.readElementTextView();
+    bool converted = false;
+    const bool value = text.toBool(&converted);
+    if (ok) *ok = converted;
+    if (!converted && invalidText) *invalidText = text.toString();
+    return value;
+}
+
+QDateTime XmlHelpers::readDateTime(XmlFastReader& reader, bool* ok, QString* invalidText) {
+    const QString text = reader.readElementText();
+    QDateTime dt = QDateTime::fromString(text, Qt::ISODate);
+    if (ok) *ok = dt.isValid();
+    if (!dt.isValid() && invalidText) *invalidText = text;
+    return dt;
+}
+
+QDate XmlHelpers::readDate(XmlFastReader& reader, bool* ok, QString* invalidText) {
+    const QString text = reader.readElementText();
+    QDate date = QDate::fromString(text, Qt::ISODate);
+    if (ok) *ok = date.isValid();
+    if (!date.isValid() && invalidText) *invalidText = text;
+    return date;
+}
+
+QTime XmlHelpers::readTime(XmlFastReader& reader, bool* ok, QString* invalidText) {
+    const QString text = reader.readElementText();
+    QTime time = QTime::fromString(text, Qt::ISODate);
+    if (ok) *ok = time.isValid();
+    if (!time.isValid() && invalidText) *invalidText = text;
+    return time;
+}
+
+QString XmlHelpers::readInternedText(QXmlStreamReader& reader) {
+    XmlStringPool* pool = XmlStringPool::current();
+    return pool ? pool->intern(reader.readElementText()) : reader.readElementText();
+}
+
+QString XmlHelpers::readInternedText(XmlFastReader& reader) {
+    XmlStringPool* pool = XmlStringPool::current();
+    return pool ? pool->intern(reader.readElementTextView()) : reader.readElementText();
+}
+
 void XmlHelpers::writeElement(QXmlStreamWriter& writer, const QString& name, const QString& value) {
     writer.writeTextElement(name, value);
 }
@@ -59,6 +173,18 @@ void XmlHelpers::writeElement(QXmlStreamWriter& writer, const QString& name, int
     writer.writeTextElement(name, QString::number(value));
 }
 
+void XmlHelpers::writeElement(QXmlStreamWriter& writer, const QString& name, qint64 value) {
+    writer.writeTextElement(name, QString::number(value));
+}
+
+void XmlHelpers::writeElement(QXmlStreamWriter& writer, const QString& name, quint32 value) {
+    writeElement(writer, name, quint64(value));
+}
+
+void XmlHelpers::writeElement(QXmlStreamWriter& writer, const QString& name, quint64 value) {
+    writer.writeTextElement(name, QString::number(value));
+}
+
 void XmlHelpers::writeElement(QXmlStreamWriter& writer, const QString& name, double value) {
     writer.writeTextElement(name, QString::number(value, 'g', 15));
 }
@@ -114,6 +240,31 @@ bool XmlHelpers::readBoolAttribute(QXmlStreamReader& reader, const QString& name
     return defaultValue;
 }
 
+QString XmlHelpers::readAttribute(XmlFastReader& reader, XmlUtf8View name, const QString& defaultValue) {
+    const int index = reader.indexOfAttribute(name);
+    if (index >= 0) {
+        return reader.attribute(index).value.toString();
+    }
+    return defaultValue;
+}
+
+int XmlHelpers::readIntAttribute(XmlFastReader& reader, XmlUtf8View name, int defaultValue, bool* ok) {
+    XmlUtf8View value = reader.attributeValue(name);
+    if (value.isEmpty()) {
+        if (ok) *ok = false;
+        return defaultValue;
+    }
+    return value.toInt(ok);
+}
+
+bool XmlHelpers::readBoolAttribute(XmlFastReader& reader, XmlUtf8View name, bool defaultValue, bool* ok) {
+    XmlUtf8View value = reader.attributeValue(name);
+    bool parsed = false;
+    const bool result = value.toBool(&parsed);
+    if (ok) *ok = parsed;
+    return parsed ? result : defaultValue;
+}
+
 void XmlHelpers::writeAttribute(QXmlStreamWriter& writer, const QString& name, const QString& value) {
     writer.writeAttribute(name, value);
 }
@@ -122,6 +273,22 @@ void XmlHelpers::writeAttribute(QXmlStreamWriter& writer, const QString& name, i
     writer.writeAttribute(name, QString::number(value));
 }
 
+void XmlHelpers::writeAttribute(QXmlStreamWriter& writer, const QString& name, qint64 value) {
+    writer.writeAttribute(name, QString::number(value));
+}
+
+void XmlHelpers::writeAttribute(QXmlStreamWriter& writer, const QString& name, quint32 value) {
+    writeAttribute(writer, name, quint64(value));
+}
+
+void XmlHelpers::writeAttribute(QXmlStreamWriter& writer, const QString& name, quint64 value) {
+    writer.writeAttribute(name, QString::number(value));
+}
+
+void XmlHelpers::writeAttribute(QXmlStreamWriter& writer, const QString& name, double value) {
+    writer.writeAttribute(name, QString::number(value, 'g', 15));
+}
+
 void XmlHelpers::writeAttribute(QXmlStreamWriter& writer, const QString& name, bool value) {
     writer.writeAttribute(name, value ? "true" : "false");
 }
@@ -130,23 +297,63 @@ QSharedPointer<XmlSerializable> XmlHelpers::readPolymorphicElement(
     QXmlStreamReader& reader,
     const QString& expectedElement
 ) {
+    Q_UNUSED(expectedElement);
     if (!reader.isStartElement()) {
         return nullptr;
     }
     
-    QString elementName = reader.name().toString();
-    QString xsiType = getXsiType(reader);
-    
     QSharedPointer<XmlSerializable> obj;
     
-    // Try to create by xsi:type first
+    // Try to create by xsi:type first; only then is a QString key built
+    const QStringRef xsiType = xsiTypeView(reader);
     if (!xsiType.isEmpty()) {
-        obj = XmlTypeFactory::instance().createByType(xsiType);
+        obj = XmlTypeFactory::instance().createByType(xsiType.toString());
     }
     
     // Fall back to element name
     if (!obj) {
-        obj = XmlTypeFactory::instance().createByElement(elementName);
+        obj = XmlTypeFactory::instance().createByElement(reader.name().toString());
+    }
+    
+    // Generated types register only through registerAllTypes()
+    if (!obj && XmlTypeFactory::instance().isEmpty()) {
+        reader.raiseError(QString("<%1>: type not registered; call registerAllTypes() before loading")
+                          .arg(reader.qualifiedName().toString()));
+        return nullptr;
+    }
+    
+    if (obj && obj->fromXml(reader)) {
+        return obj;
+    }
+    
+    return nullptr;
+}
+
+QSharedPointer<XmlSerializable> XmlHelpers::readPolymorphicElement(
+    XmlFastReader& reader,
+    const QString& expectedElement
+) {
+    Q_UNUSED(expectedElement);
+    if (!reader.isStartElement()) {
+        return nullptr;
+    }
+    
+    QSharedPointer<XmlSerializable> obj;
+    
+    const XmlUtf8View xsiType = xsiTypeView(reader);
+    if (!xsiType.isEmpty()) {
+        obj = XmlTypeFactory::instance().createByType(xsiType.toString());
+    }
+    
+    if (!obj) {
+        obj = XmlTypeFactory::instance().createByElement(reader.name().toString());
+    }
+    
+    // Generated types register only through registerAllTypes()
+    if (!obj && XmlTypeFactory::instance().isEmpty()) {
+        reader.raiseError(QString("<%1>: type not registered; call registerAllTypes() before loading")
+                          .arg(reader.qualifiedName().toString()));
+        return nullptr;
     }
     
     if (obj && obj->fromXml(reader)) {
@@ -175,6 +382,28 @@ void XmlHelpers::writePolymorphicElement(
     writer.writeEndElement();
 }
 
+bool XmlHelpers::writePolymorphicElement(
+    XmlUtf8Writer& writer,
+    const QSharedPointer<XmlSerializable>& obj,
+    bool writeXsiType
+) {
+    if (!obj) {
+        return true;
+    }
+    
+    writer.writeStartElement(obj->xmlElementName());
+    
+    if (writeXsiType) {
+        writer.writeAttribute("xsi:type", obj->xsdTypeName());
+    }
+    
+    if (!obj->toXml(writer)) {
+        return false;
+    }
+    writer.writeEndElement();
+    return true;
+}
+
 void XmlHelpers::skipCurrentElement(QXmlStreamReader& reader) {
     int depth = 1;
     while (depth > 0 && !reader.atEnd()) {
@@ -187,27 +416,54 @@ void XmlHelpers::skipCurrentElement(QXmlStreamReader& reader) {
     }
 }
 
+void XmlHelpers::skipCurrentElement(XmlFastReader& reader) {
+    reader.skipCurrentElement();
+}
+
 QString XmlHelpers::getXsiType(QXmlStreamReader& reader) {
-    QXmlStreamAttributes attrs = reader.attributes();
+    return xsiTypeView(reader).toString();
+}
+
+QString XmlHelpers::getXsiType(XmlFastReader& reader) {
+    return xsiTypeView(reader).toString();
+}
+
+QStringRef XmlHelpers::xsiTypeView(QXmlStreamReader& reader) {
+    // Shares the reader's attribute vector; the refs point into its strings
+    const QXmlStreamAttributes attrs = reader.attributes();
     
-    // Check for xsi:type with namespace
     for (const QXmlStreamAttribute& attr : attrs) {
-        if (attr.name().toString() == "type" && 
-            attr.namespaceUri().toString().contains("XMLSchema-instance")) {
-            return attr.value().toString();
+        // Undeclared xsi prefix accepted as well
+        if (attr.name() == QLatin1String("type")
+            && (attr.namespaceUri() == xsiNamespaceUri() || attr.qualifiedName() == QLatin1String("xsi:type"))) {
+            return attr.value();
         }
     }
     
-    // Check without namespace prefix
-    if (attrs.hasAttribute("xsi:type")) {
-        return attrs.value("xsi:type").toString();
+    return QStringRef();
+}
+
+XmlUtf8View XmlHelpers::xsiTypeView(XmlFastReader& reader) {
+    for (int i = 0; i < reader.attributeCount(); ++i) {
+        const XmlFastAttribute& attr = reader.attribute(i);
+        if (attr.name == "type"
+            && (reader.attributeNamespaceUri(i) == "http://www.w3.org/2001/XMLSchema-instance"
+                || attr.qualifiedName == "xsi:type")) {
+            return attr.value;
+        }
     }
     
-    return QString();
+    return XmlUtf8View();
 }
 
 void XmlHelpers::setupNamespaces(QXmlStreamWriter& writer) {
-    writer.writeNamespace("http://www.w3.org/2001/XMLSchema-instance", "xsi");
+    static const QString prefix = QStringLiteral("xsi");
+    writer.writeNamespace(xsiNamespaceUri(), prefix);
+}
+
+const QString& XmlHelpers::xsiNamespaceUri() {
+    static const QString uri = QStringLiteral("http://www.w3.org/2001/XMLSchema-instance");
+    return uri;
 }
 
 } // namespace XsdQt
@@ -2,6 +2,10 @@
 #define XMLHELPERS_H
 
 #include "XmlSerializable.h"
+#include "XmlUtf8Writer.h"
+#include "XmlEnum.h"
+#include "XmlParseErrors.h"
+#include "XmlStringPool.h"
 #include <QString>
 #include <QDateTime>
 #include <QDate>
@@ -10,23 +14,86 @@
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 #include <QSharedPointer>
+#include <limits>
 
 namespace XsdQt {
 
 class XmlHelpers {
 public:
-    // Read simple types
+    // Read simple types; when the text does not convert, ok is false and
+    // invalidText receives it, for XmlErrorCollector::report()
     static QString readElementText(QXmlStreamReader& reader);
-    static int readInt(QXmlStreamReader& reader, bool* ok = nullptr);
-    static double readDouble(QXmlStreamReader& reader, bool* ok = nullptr);
-    static bool readBool(QXmlStreamReader& reader, bool* ok = nullptr);
-    static QDateTime readDateTime(QXmlStreamReader& reader, bool* ok = nullptr);
-    static QDate readDate(QXmlStreamReader& reader, bool* ok = nullptr);
-    static QTime readTime(QXmlStreamReader& reader, bool* ok = nullptr);
+    static int readInt(QXmlStreamReader& reader, bool* ok = nullptr, QString* invalidText = nullptr);
+    static qint64 readInt64(QXmlStreamReader& reader, bool* ok = nullptr, QString* invalidText = nullptr);
+    static quint64 readUInt64(QXmlStreamReader& reader, bool* ok = nullptr, QString* invalidText = nullptr);
+    static double readDouble(QXmlStreamReader& reader, bool* ok = nullptr, QString* invalidText = nullptr);
+    static bool readBool(QXmlStreamReader& reader, bool* ok = nullptr, QString* invalidText = nullptr);
+    static QDateTime readDateTime(QXmlStreamReader& reader, bool* ok = nullptr, QString* invalidText = nullptr);
+    static QDate readDate(QXmlStreamReader& reader, bool* ok = nullptr, QString* invalidText = nullptr);
+    static QTime readTime(QXmlStreamReader& reader, bool* ok = nullptr, QString* invalidText = nullptr);
+    
+    // Read simple types from the fast reader (numbers parsed from the UTF-8 view)
+    static QString readElementText(XmlFastReader& reader);
+    static int readInt(XmlFastReader& reader, bool* ok = nullptr, QString* invalidText = nullptr);
+    static qint64 readInt64(XmlFastReader& reader, bool* ok = nullptr, QString* invalidText = nullptr);
+    static quint64 readUInt64(XmlFastReader& reader, bool* ok = nullptr, QString* invalidText = nullptr);
+    static double readDouble(XmlFastReader& reader, bool* ok = nullptr, QString* invalidText = nullptr);
+    static bool readBool(XmlFastReader& reader, bool* ok = nullptr, QString* invalidText = nullptr);
+    static QDateTime readDateTime(XmlFastReader& reader, bool* ok = nullptr, QString* invalidText = nullptr);
+    static QDate readDate(XmlFastReader& reader, bool* ok = nullptr, QString* invalidText = nullptr);
+    static QTime readTime(XmlFastReader& reader, bool* ok = nullptr, QString* invalidText = nullptr);
+    
+    /**
+     * An integer read at a wider type, narrowed to the member's type;
+     * out of its range, ok is false, invalidText receives the value and
+     * defaultValue is returned
+     */
+    template<typename T, typename Wide>
+    static T narrowed(Wide value, T defaultValue, bool* ok, QString* invalidText = nullptr) {
+        if (value < Wide(std::numeric_limits<T>::min()) || value > Wide(std::numeric_limits<T>::max())) {
+            if (ok) *ok = false;
+            if (invalidText) *invalidText = QString::number(value);
+            return defaultValue;
+        }
+        return T(value);
+    }
+    
+    /**
+     * Element text shared through the thread's current XmlStringPool,
+     * read like readElementText() when no pool is installed
+     */
+    static QString readInternedText(QXmlStreamReader& reader);
+    static QString readInternedText(XmlFastReader& reader);
+    
+    /**
+     * Element text as a generated enum, defaultValue if it is not one of its values
+     */
+    template<typename Enum>
+    static Enum readEnum(QXmlStreamReader& reader, Enum defaultValue, bool* ok = nullptr, QString* invalidText = nullptr) {
+        const QString text = reader.readElementText();
+        Enum value;
+        const bool parsed = parseXmlEnum(text, &value);
+        if (ok) *ok = parsed;
+        if (!parsed && invalidText) *invalidText = text;
+        return parsed ? value : defaultValue;
+    }
+    
+    template<typename Enum>
+    static Enum readEnum(XmlFastReader& reader, Enum defaultValue, bool* ok = nullptr, QString* invalidText = nullptr) {
+        const XmlUtf8View text = reader.readElementTextView();
+        Enum value;
+        const bool parsed = parseXmlEnum(text, &value);
+        if (ok) *ok = parsed;
+        if (!parsed && invalidText) *invalidText = text.toString();
+        return parsed ? value : defaultValue;
+    }
     
     // Write simple types
     static void writeElement(QXmlStreamWriter& writer, const QString& name, const QString& value);
     static void writeElement(QXmlStreamWriter& writer, const QString& name, int value);
+    static void writeElement(QXmlStreamWriter& writer, const QString& name, qint64 value);
+    static void writeElement(QXmlStreamWriter& writer, const QString& name, quint32 value);
+    static void writeElement(QXmlStreamWriter& writer, const QString& name, quint64 value);
     static void writeElement(QXmlStreamWriter& writer, const QString& name, double value);
     static void writeElement(QXmlStreamWriter& writer, const QString& name, bool value);
     static void writeElement(QXmlStreamWriter& writer, const QString& name, const QDateTime& value);
@@ -37,10 +104,17 @@ public:
     static QString readAttribute(QXmlStreamReader& reader, const QString& name, const QString& defaultValue = QString());
     static int readIntAttribute(QXmlStreamReader& reader, const QString& name, int defaultValue = 0, bool* ok = nullptr);
     static bool readBoolAttribute(QXmlStreamReader& reader, const QString& name, bool defaultValue = false, bool* ok = nullptr);
+    static QString readAttribute(XmlFastReader& reader, XmlUtf8View name, const QString& defaultValue = QString());
+    static int readIntAttribute(XmlFastReader& reader, XmlUtf8View name, int defaultValue = 0, bool* ok = nullptr);
+    static bool readBoolAttribute(XmlFastReader& reader, XmlUtf8View name, bool defaultValue = false, bool* ok = nullptr);
     
     // Write attributes
     static void writeAttribute(QXmlStreamWriter& writer, const QString& name, const QString& value);
     static void writeAttribute(QXmlStreamWriter& writer, const QString& name, int value);
+    static void writeAttribute(QXmlStreamWriter& writer, const QString& name, qint64 value);
+    static void writeAttribute(QXmlStreamWriter& writer, const QString& name, quint32 value);
+    static void writeAttribute(QXmlStreamWriter& writer, const QString& name, quint64 value);
+    static void writeAttribute(QXmlStreamWriter& writer, const QString& name, double value);
     static void writeAttribute(QXmlStreamWriter& writer, const QString& name, bool value);
     
     // Handle polymorphic types
@@ -49,20 +123,60 @@ public:
         const QString& expectedElement = QString()
     );
     
+    static QSharedPointer<XmlSerializable> readPolymorphicElement(
+        XmlFastReader& reader,
+        const QString& expectedElement = QString()
+    );
+    
+    /**
+     * Read an element whose concrete type is known from its name (generated
+     * per-field dispatch over a substitution group); only an xsi:type goes
+     * through XmlTypeFactory, since it may name an unknown extension
+     */
+    template<typename Field, typename Concrete, typename Reader>
+    static QSharedPointer<Field> readSubstitutedElement(Reader& reader) {
+        if (!xsiTypeView(reader).isEmpty()) {
+            return readPolymorphicElement(reader).template dynamicCast<Field>();
+        }
+        
+        QSharedPointer<Concrete> obj = QSharedPointer<Concrete>::create();
+        if (!obj->fromXml(reader)) {
+            return QSharedPointer<Field>();
+        }
+        return obj;
+    }
+    
     static void writePolymorphicElement(
         QXmlStreamWriter& writer,
         const QSharedPointer<XmlSerializable>& obj,
         bool writeXsiType = false
     );
     
+    // Returns false if obj has no direct UTF-8 writer support
+    static bool writePolymorphicElement(
+        XmlUtf8Writer& writer,
+        const QSharedPointer<XmlSerializable>& obj,
+        bool writeXsiType = false
+    );
+    
     // Skip unknown elements
     static void skipCurrentElement(QXmlStreamReader& reader);
+    static void skipCurrentElement(XmlFastReader& reader);
     
     // Get xsi:type attribute
     static QString getXsiType(QXmlStreamReader& reader);
+    static QString getXsiType(XmlFastReader& reader);
+    
+    /**
+     * xsi:type of the current start element without allocating, empty if absent
+     * The view is valid until the reader advances
+     */
+    static QStringRef xsiTypeView(QXmlStreamReader& reader);
+    static XmlUtf8View xsiTypeView(XmlFastReader& reader);
     
     // Namespace handling
     static void setupNamespaces(QXmlStreamWriter& writer);
+    static const QString& xsiNamespaceUri();
 };
 
 } // namespace XsdQt
@@ -0,0 +1,65 @@
+#include "XmlNameHash.h"
+
+namespace XsdQt {
+
+namespace {
+
+/**
+ * Feeds the UTF-8 encoding of UTF-16 text to sink byte by byte, so
+ * QXmlStreamReader names hash and compare like the literals in generated code
+ * Stops early when sink returns false
+ */
+template<typename Sink>
+bool forEachUtf8Byte(const QStringRef& name, Sink sink) {
+    const QChar* p = name.unicode();
+    const QChar* e = p + name.size();
+    for (; p < e; ++p) {
+        uint c = p->unicode();
+        if (p->isHighSurrogate() && p + 1 < e && p[1].isLowSurrogate()) {
+            c = QChar::surrogateToUcs4(*p, p[1]);
+            ++p;
+        }
+
+        if (c < 0x80) {
+            if (!sink(quint8(c))) return false;
+        } else if (c < 0x800) {
+            if (!sink(quint8(0xC0 | (c >> 6))) || !sink(quint8(0x80 | (c & 0x3F)))) return false;
+        } else if (c < 0x10000) {
+            if (!sink(quint8(0xE0 | (c >> 12))) || !sink(quint8(0x80 | ((c >> 6) & 0x3F)))
+                || !sink(quint8(0x80 | (c & 0x3F)))) return false;
+        } else {
+            if (!sink(quint8(0xF0 | (c >> 18))) || !sink(quint8(0x80 | ((c >> 12) & 0x3F)))
+                || !sink(quint8(0x80 | ((c >> 6) & 0x3F))) || !sink(quint8(0x80 | (c & 0x3F)))) return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+quint32 xmlNameHash(XmlUtf8View name, quint32 seed) {
+    quint32 hash = 2166136261u ^ seed;
+    for (int i = 0; i < name.size; ++i) {
+        hash = (hash ^ quint8(name.data[i])) * 16777619u;
+    }
+    return hash;
+}
+
+quint32 xmlNameHash(const QStringRef& name, quint32 seed) {
+    quint32 hash = 2166136261u ^ seed;
+    forEachUtf8Byte(name, [&hash](quint8 byte) {
+        hash = (hash ^ byte) * 16777619u;
+        return true;
+    });
+    return hash;
+}
+
+bool xmlNameEquals(const QStringRef& name, XmlUtf8View utf8) {
+    int pos = 0;
+    const bool matched = forEachUtf8Byte(name, [&](quint8 byte) {
+        return pos < utf8.size && quint8(utf8.data[pos++]) == byte;
+    });
+    return matched && pos == utf8.size;
+}
+
+} // namespace XsdQt
@@ -0,0 +1,39 @@
+#ifndef XMLNAMEHASH_H
+#define XMLNAMEHASH_H
+
+#include "XmlFastReader.h"
+#include <QStringRef>
+
+namespace XsdQt {
+
+/**
+ * FNV-1a over the UTF-8 bytes of a name or value, with an optional seed
+ * constexpr so generated case labels are folded at compile time
+ */
+constexpr quint32 xmlNameHash(const char* name, quint32 seed = 0) {
+    quint32 hash = 2166136261u ^ seed;
+    while (*name) {
+        hash = (hash ^ quint8(*name++)) * 16777619u;
+    }
+    return hash;
+}
+
+quint32 xmlNameHash(XmlUtf8View name, quint32 seed = 0);
+quint32 xmlNameHash(const QStringRef& name, quint32 seed = 0);
+
+/**
+ * Compares UTF-16 text with UTF-8 bytes without converting either
+ */
+bool xmlNameEquals(const QStringRef& name, XmlUtf8View utf8);
+
+/**
+ * Slot of a hash in a table of 2^bits entries
+ * Mixed first: names differing only in their last byte differ in few bits
+ */
+constexpr int xmlHashSlot(quint32 hash, int bits) {
+    return bits > 0 ? int(((hash ^ (hash >> 16)) * 0x45d9f3bu) >> (32 - bits)) : 0;
+}
+
+} // namespace XsdQt
+
+#endif // XMLNAMEHASH_H
@@ -0,0 +1,78 @@
+#include "XmlParseErrors.h"
+
+namespace XsdQt {
+
+namespace {
+
+thread_local XmlErrorCollector* currentCollector = nullptr;
+
+} // namespace
+
+QString XmlParseError::toString() const {
+    const QString position = QString("%1:%2: %3: ").arg(line).arg(column).arg(path);
+    if (kind == UnexpectedElement) {
+        return position + QString("unexpected element <%1>, expected %2").arg(found, expected);
+    }
+    if (kind == Occurrences) {
+        return position + QString("found %1 %2, expected %3")
+            .arg(found, found == QLatin1String("1") ? "occurrence" : "occurrences", expected);
+    }
+    return position + QString("expected %1, found \"%2\"").arg(expected, found);
+}
+
+XmlErrorCollector::XmlErrorCollector(Mode mode, int maxErrors)
+    : m_mode(mode), m_maxErrors(maxErrors)
+{
+    m_path.reserve(32);
+}
+
+void XmlErrorCollector::clear() {
+    m_errors.clear();
+    m_path.clear();
+}
+
+void XmlErrorCollector::truncate(int count) {
+    if (count < m_errors.size()) {
+        m_errors.resize(count);
+    }
+}
+
+void XmlErrorCollector::beginDocument(const QString& rootElement) {
+    m_rootElement = rootElement.toUtf8();
+    m_path.clear();
+    m_path.append(m_rootElement.constData());
+}
+
+QString XmlErrorCollector::path(const char* field) const {
+    QString result;
+    for (const char* name : m_path) {
+        result += '/';
+        result += QString::fromUtf8(name);
+    }
+    if (field) {
+        result += '/';
+        result += QString::fromUtf8(field);
+    }
+    return result;
+}
+
+bool XmlErrorCollector::record(const XmlParseError& error) {
+    m_errors.append(error);
+    return m_mode == CollectAll && m_errors.size() < m_maxErrors;
+}
+
+XmlErrorCollector* XmlErrorCollector::current() {
+    return currentCollector;
+}
+
+XmlErrorCollectorScope::XmlErrorCollectorScope(XmlErrorCollector* collector)
+    : m_previous(currentCollector)
+{
+    currentCollector = collector;
+}
+
+XmlErrorCollectorScope::~XmlErrorCollectorScope() {
+    currentCollector = m_previous;
+}
+
+} // namespace XsdQt
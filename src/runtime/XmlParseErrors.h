@@ -0,0 +1,178 @@
+#ifndef XMLPARSEERRORS_H
+#define XMLPARSEERRORS_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+namespace XsdQt {
+
+/**
+ * One problem found by generated fromXml
+ */
+struct XmlParseError {
+    enum Kind {
+        InvalidValue,       // text not of the field type, or outside its facets
+        UnexpectedElement,  // child the type does not declare (xsd2cpp --validate)
+        Occurrences         // required content missing or repeated too often (--validate)
+    };
+
+    Kind kind = InvalidValue;
+    qint64 line = 0;
+    qint64 column = 0;
+    qint64 offset = 0;      // bytes for XmlFastReader, characters for QXmlStreamReader
+    QString path;           // e.g. "/fleet/car/year" or "/fleet/car/@id"
+    QString expected;       // e.g. "xs:int", "at most 10 characters", "at least 1"
+    QString found;          // offending text, element name or number of occurrences
+
+    /**
+     * "line:column: path: expected ..., found ..."
+     */
+    QString toString() const;
+};
+
+/**
+ * Collects the errors generated fromXml reports while reading a document
+ *
+ * Install one on the calling thread with XmlErrorCollectorScope, or on an
+ * XmlCodecContext. Generated code only keeps a path of element name
+ * literals on the happy path; positions and strings are produced when an
+ * error is reported. FailFast stops the parse at the first error through
+ * the reader's raiseError(); CollectAll records up to maxErrors() and
+ * keeps reading, so every problem of a document is found in one pass.
+ * Without a collector, errors are reported fail-fast as reader errors,
+ * except values that do not convert in code generated without --validate.
+ * Not thread-safe: use one collector per thread.
+ */
+class XmlErrorCollector {
+public:
+    enum Mode {
+        FailFast,
+        CollectAll
+    };
+
+    explicit XmlErrorCollector(Mode mode = FailFast, int maxErrors = 100);
+
+    Mode mode() const { return m_mode; }
+    void setMode(Mode mode) { m_mode = mode; }
+
+    /**
+     * CollectAll stops the parse once this many errors are recorded
+     */
+    int maxErrors() const { return m_maxErrors; }
+    void setMaxErrors(int count) { m_maxErrors = count; }
+
+    const QVector<XmlParseError>& errors() const { return m_errors; }
+    bool hasErrors() const { return !m_errors.isEmpty(); }
+    int count() const { return m_errors.size(); }
+    void clear();
+
+    /**
+     * Drop the errors after the first count, e.g. before re-reading a document
+     */
+    void truncate(int count);
+
+    /**
+     * Start the element path of a new document at its root element
+     */
+    void beginDocument(const QString& rootElement);
+
+    /**
+     * Element path, maintained by XmlErrorPath in generated code
+     * Names must outlive the parse (string literals)
+     */
+    void pushElement(const char* name) { m_path.append(name); }
+    void popElement() { m_path.removeLast(); }
+    QString path(const char* field = nullptr) const;
+
+    /**
+     * Called by generated code when a value or element is invalid
+     * Returns true if parsing should go on (CollectAll below the limit);
+     * otherwise the reader error is raised and the caller returns false
+     */
+    template<typename Reader>
+    static bool report(Reader& reader, XmlParseError::Kind kind, const char* field, const char* expected,
+                       const QString& found = QString()) {
+        XmlParseError error;
+        error.kind = kind;
+        error.line = reader.lineNumber();
+        error.column = reader.columnNumber();
+        error.offset = reader.characterOffset();
+        error.expected = QString::fromUtf8(expected);
+        error.found = found;
+
+        XmlErrorCollector* collector = current();
+        error.path = collector ? collector->path(field) : QString::fromUtf8(field);
+        if (collector && collector->record(error)) {
+            return true;
+        }
+        reader.raiseError(error.toString());
+        return false;
+    }
+
+    /**
+     * report() for text that does not convert to its field type in code
+     * generated without --validate: with no collector installed the field
+     * keeps the conversion's fallback and parsing goes on, as it always did
+     */
+    template<typename Reader>
+    static bool reportIfCollecting(Reader& reader, XmlParseError::Kind kind, const char* field, const char* expected,
+                                   const QString& found = QString()) {
+        return !current() || report(reader, kind, field, expected, found);
+    }
+
+    /**
+     * Collector installed on this thread, or nullptr
+     */
+    static XmlErrorCollector* current();
+
+private:
+    bool record(const XmlParseError& error);
+
+    Mode m_mode;
+    int m_maxErrors;
+    QVector<XmlParseError> m_errors;
+    QByteArray m_rootElement;
+    QVector<const char*> m_path;
+};
+
+/**
+ * Installs a collector for the calling thread for the lifetime of the scope
+ * Scopes nest; a null collector restores fail-fast reader errors
+ */
+class XmlErrorCollectorScope {
+public:
+    explicit XmlErrorCollectorScope(XmlErrorCollector* collector);
+    ~XmlErrorCollectorScope();
+
+private:
+    Q_DISABLE_COPY(XmlErrorCollectorScope)
+
+    XmlErrorCollector* m_previous;
+};
+
+/**
+ * Adds a child element to the current collector's path while it is read
+ */
+class XmlErrorPath {
+public:
+    explicit XmlErrorPath(const char* name) : m_collector(XmlErrorCollector::current()) {
+        if (m_collector) {
+            m_collector->pushElement(name);
+        }
+    }
+    ~XmlErrorPath() {
+        if (m_collector) {
+            m_collector->popElement();
+        }
+    }
+
+private:
+    Q_DISABLE_COPY(XmlErrorPath)
+
+    XmlErrorCollector* m_collector;
+};
+
+} // namespace XsdQt
+
+#endif // XMLPARSEERRORS_H
@@ -1,15 +1,19 @@
 #ifndef XMLSERIALIZABLE_H
 #define XMLSERIALIZABLE_H
 
+#include "XmlFastReader.h"
 #include <QString>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 #include <QSharedPointer>
-#include <QMap>
+#include <QHash>
+#include <cstddef>
 #include <functional>
 
 namespace XsdQt {
 
+class XmlUtf8Writer;
+
 /**
  * Base class for all generated XML serializable types
  */
@@ -22,12 +26,31 @@ public:
      */
     virtual void toXml(QXmlStreamWriter& writer) const = 0;
     
+    /**
+     * Serialize this object with the direct UTF-8 writer
+     * Returns false if the type was generated without support for it
+     */
+    virtual bool toXml(XmlUtf8Writer& writer) const {
+        Q_UNUSED(writer);
+        return false;
+    }
+    
     /**
      * Deserialize this object from XML
      * Returns true if successful
      */
     virtual bool fromXml(QXmlStreamReader& reader) = 0;
     
+    /**
+     * Deserialize this object with the UTF-8 fast reader
+     * Types generated without support for it mark the reader unsupported,
+     * so the document is re-read with QXmlStreamReader
+     */
+    virtual bool fromXml(XmlFastReader& reader) {
+        reader.raiseUnsupported(QString("%1 has no fast reader support").arg(xsdTypeName()));
+        return false;
+    }
+    
     /**
      * Get the XML element name for this type
      */
@@ -39,6 +62,20 @@ public:
     virtual QString xsdTypeName() const = 0;
 };
 
+/**
+ * Row of a generated registration table (see registerAllTypes())
+ */
+struct XmlTypeEntry {
+    const char* elementName;   // UTF-8
+    const char* typeName;      // UTF-8, may be empty
+    QSharedPointer<XmlSerializable> (*create)();
+};
+
+template<typename T>
+QSharedPointer<XmlSerializable> createXmlType() {
+    return QSharedPointer<T>::create();
+}
+
 /**
  * Factory for creating polymorphic types based on element name or xsi:type
  */
@@ -63,6 +100,33 @@ public:
         m_elementToType[elementName] = typeName;
     }
     
+    /**
+     * Register a whole table at once, reserving the lookup tables up front
+     * Entries with an empty type name are only found by element name
+     */
+    void registerTypes(const XmlTypeEntry* entries, int count) {
+        m_elementCreators.reserve(m_elementCreators.size() + count);
+        m_typeCreators.reserve(m_typeCreators.size() + count);
+        m_elementToType.reserve(m_elementToType.size() + count);
+        
+        for (int i = 0; i < count; ++i) {
+            const XmlTypeEntry& entry = entries[i];
+            const QString elementName = QString::fromUtf8(entry.elementName);
+            const QString typeName = QString::fromUtf8(entry.typeName);
+            
+            m_elementCreators.insert(elementName, entry.create);
+            m_elementToType.insert(elementName, typeName);
+            if (!typeName.isEmpty()) {
+                m_typeCreators.insert(typeName, entry.create);
+            }
+        }
+    }
+    
+    template<std::size_t N>
+    void registerTypes(const XmlTypeEntry (&entries)[N]) {
+        registerTypes(entries, int(N));
+    }
+    
     /**
      * Create instance by element name (for substitution groups)
      */
@@ -85,6 +149,11 @@ public:
         return nullptr;
     }
     
+    /**
+     * True until registerAllTypes() or a registrar has added a type
+     */
+    bool isEmpty() const { return m_elementCreators.isEmpty(); }
+    
     /**
      * Get type name for element name
      */
@@ -95,13 +164,15 @@ public:
 private:
     XmlTypeFactory() = default;
     
-    QMap<QString, Creator> m_elementCreators;
-    QMap<QString, Creator> m_typeCreators;
-    QMap<QString, QString> m_elementToType;
+    QHash<QString, Creator> m_elementCreators;
+    QHash<QString, Creator> m_typeCreators;
+    QHash<QString, QString> m_elementToType;
 };
 
 /**
- * Helper for automatic type registration
+ * Registration from a static initializer, for hand-written types
+ * Generated code uses the table in registerAllTypes() instead, which
+ * does not depend on the object file being linked in
  */
 template<typename T>
 class XmlTypeRegistrar {
@@ -0,0 +1,50 @@
+#include "XmlStringPool.h"
+
+namespace XsdQt {
+
+namespace {
+
+thread_local XmlStringPool* currentPool = nullptr;
+
+} // namespace
+
+QString XmlStringPool::intern(const QString& value) {
+    QSet<QString>::const_iterator it = m_strings.constFind(value);
+    if (it != m_strings.constEnd()) {
+        return *it;
+    }
+    m_strings.insert(value);
+    return value;
+}
+
+QString XmlStringPool::intern(XmlUtf8View value) {
+    // Lookup key borrows the reader's bytes; only a new value is copied
+    QHash<QByteArray, QString>::const_iterator it = m_utf8.constFind(QByteArray::fromRawData(value.data, value.size));
+    if (it != m_utf8.constEnd()) {
+        return it.value();
+    }
+    const QString string = intern(value.toString());
+    m_utf8.insert(value.toByteArray(), string);
+    return string;
+}
+
+void XmlStringPool::clear() {
+    m_strings.clear();
+    m_utf8.clear();
+}
+
+XmlStringPool* XmlStringPool::current() {
+    return currentPool;
+}
+
+XmlStringPoolScope::XmlStringPoolScope(XmlStringPool* pool)
+    : m_previous(currentPool)
+{
+    currentPool = pool;
+}
+
+XmlStringPoolScope::~XmlStringPoolScope() {
+    currentPool = m_previous;
+}
+
+} // namespace XsdQt
@@ -0,0 +1,57 @@
+#ifndef XMLSTRINGPOOL_H
+#define XMLSTRINGPOOL_H
+
+#include "XmlFastReader.h"
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QString>
+
+namespace XsdQt {
+
+/**
+ * Shares one implicitly-shared QString per distinct value of interned fields
+ *
+ * Generated fromXml reads fields marked for interning (xsdqt:intern="true"
+ * in the schema or xsd2cpp --intern) through XmlHelpers::readInternedText,
+ * which uses the pool installed on the current thread by XmlStringPoolScope
+ * and reads plainly when there is none. Fast-reader text is looked up by its
+ * UTF-8 bytes, so a repeated value costs no allocation at all.
+ * Not thread-safe: use one pool per thread, or one per XmlCodecContext.
+ */
+class XmlStringPool {
+public:
+    QString intern(const QString& value);
+    QString intern(XmlUtf8View value);
+
+    int size() const { return m_strings.size(); }
+    void clear();
+
+    /**
+     * Pool installed on this thread, or nullptr
+     */
+    static XmlStringPool* current();
+
+private:
+    QSet<QString> m_strings;
+    QHash<QByteArray, QString> m_utf8;      // keys own their bytes
+};
+
+/**
+ * Installs a pool for the calling thread for the lifetime of the scope
+ * Scopes nest; a null pool turns interning off inside the scope
+ */
+class XmlStringPoolScope {
+public:
+    explicit XmlStringPoolScope(XmlStringPool* pool);
+    ~XmlStringPoolScope();
+
+private:
+    Q_DISABLE_COPY(XmlStringPoolScope)
+
+    XmlStringPool* m_previous;
+};
+
+} // namespace XsdQt
+
+#endif // XMLSTRINGPOOL_H
@@ -0,0 +1,365 @@
+#include "XmlUtf8Writer.h"
+#include <QtAlgorithms>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define XSDQT_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace XsdQt {
+
+namespace {
+
+inline char* appendLiteral(char* dst, const char* literal, int size) {
+    std::memcpy(dst, literal, size);
+    return dst + size;
+}
+
+} // namespace
+
+XmlUtf8Writer::XmlUtf8Writer(QByteArray* buffer)
+    : m_out(buffer), m_inStartElement(false), m_hasError(false)
+{
+    // Reserved capacity survives truncation back to zero
+    m_names.reserve(256);
+}
+
+void XmlUtf8Writer::reset() {
+    m_names.resize(0);
+    m_nameOffsets.resize(0);
+    m_pendingNamespaces.clear();
+    m_inStartElement = false;
+    m_hasError = false;
+}
+
+void XmlUtf8Writer::writeStartDocument() {
+    finishStartElement();
+    m_out->append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>");
+}
+
+void XmlUtf8Writer::writeEndDocument() {
+    while (!m_nameOffsets.isEmpty()) {
+        writeEndElement();
+    }
+    m_out->append('\n');
+}
+
+void XmlUtf8Writer::writeNamespace(const QString& namespaceUri, const QString& prefix) {
+    m_pendingNamespaces.append(" xmlns");
+    if (!prefix.isEmpty()) {
+        m_pendingNamespaces.append(':');
+        m_pendingNamespaces.append(prefix.toUtf8());
+    }
+    m_pendingNamespaces.append("=\"");
+    m_hasError |= !appendEscaped(m_pendingNamespaces, namespaceUri.constData(), namespaceUri.size(), true);
+    m_pendingNamespaces.append('"');
+}
+
+void XmlUtf8Writer::writeStartElement(XmlUtf8Name name) {
+    finishStartElement();
+
+    m_nameOffsets.append(m_names.size());
+    m_names.append(name.data, name.size);
+
+    m_out->append('<');
+    m_out->append(name.data, name.size);
+    if (!m_pendingNamespaces.isEmpty()) {
+        m_out->append(m_pendingNamespaces);
+        m_pendingNamespaces.clear();
+    }
+    m_inStartElement = true;
+}
+
+void XmlUtf8Writer::writeStartElement(const QString& name) {
+    const QByteArray utf8 = name.toUtf8();
+    writeStartElement(XmlUtf8Name(utf8.constData(), utf8.size()));
+}
+
+void XmlUtf8Writer::writeEndElement() {
+    if (m_nameOffsets.isEmpty()) {
+        return;
+    }
+
+    const int offset = m_nameOffsets.takeLast();
+    if (m_inStartElement) {
+        m_out->append("/>");
+        m_inStartElement = false;
+    } else {
+        m_out->append("</");
+        m_out->append(m_names.constData() + offset, m_names.size() - offset);
+        m_out->append('>');
+    }
+    m_names.resize(offset);
+}
+
+void XmlUtf8Writer::writeAttribute(XmlUtf8Name name, const QString& value) {
+    if (!m_inStartElement) {
+        m_hasError = true;
+        return;
+    }
+    m_out->append(' ');
+    m_out->append(name.data, name.size);
+    m_out->append("=\"");
+    m_hasError |= !appendEscaped(*m_out, value.constData(), value.size(), true);
+    m_out->append('"');
+}
+
+void XmlUtf8Writer::writeAttribute(XmlUtf8Name name, int value) {
+    if (!m_inStartElement) {
+        m_hasError = true;
+        return;
+    }
+    m_out->append(' ');
+    m_out->append(name.data, name.size);
+    m_out->append("=\"");
+    appendInt(value);
+    m_out->append('"');
+}
+
+void XmlUtf8Writer::writeAttribute(XmlUtf8Name name, qint64 value) {
+    if (!m_inStartElement) {
+        m_hasError = true;
+        return;
+    }
+    m_out->append(' ');
+    m_out->append(name.data, name.size);
+    m_out->append("=\"");
+    appendInt(value);
+    m_out->append('"');
+}
+
+void XmlUtf8Writer::writeAttribute(XmlUtf8Name name, quint64 value) {
+    if (!m_inStartElement) {
+        m_hasError = true;
+        return;
+    }
+    m_out->append(' ');
+    m_out->append(name.data, name.size);
+    m_out->append("=\"");
+    appendUInt(value);
+    m_out->append('"');
+}
+
+void XmlUtf8Writer::writeAttribute(XmlUtf8Name name, double value) {
+    if (!m_inStartElement) {
+        m_hasError = true;
+        return;
+    }
+    m_out->append(' ');
+    m_out->append(name.data, name.size);
+    m_out->append("=\"");
+    m_out->append(QByteArray::number(value, 'g', 15));
+    m_out->append('"');
+}
+
+void XmlUtf8Writer::writeAttribute(XmlUtf8Name name, bool value) {
+    if (!m_inStartElement) {
+        m_hasError = true;
+        return;
+    }
+    m_out->append(' ');
+    m_out->append(name.data, name.size);
+    m_out->append(value ? "=\"true\"" : "=\"false\"");
+}
+
+void XmlUtf8Writer::writeCharacters(const QString& text) {
+    finishStartElement();
+    m_hasError |= !appendEscaped(*m_out, text.constData(), text.size(), false);
+}
+
+void XmlUtf8Writer::writeTextElement(XmlUtf8Name name, const QString& value) {
+    beginTextElement(name);
+    m_hasError |= !appendEscaped(*m_out, value.constData(), value.size(), false);
+    endTextElement(name);
+}
+
+void XmlUtf8Writer::writeTextElement(XmlUtf8Name name, int value) {
+    beginTextElement(name);
+    appendInt(value);
+    endTextElement(name);
+}
+
+void XmlUtf8Writer::writeTextElement(XmlUtf8Name name, qint64 value) {
+    beginTextElement(name);
+    appendInt(value);
+    endTextElement(name);
+}
+
+void XmlUtf8Writer::writeTextElement(XmlUtf8Name name, quint64 value) {
+    beginTextElement(name);
+    appendUInt(value);
+    endTextElement(name);
+}
+
+void XmlUtf8Writer::writeTextElement(XmlUtf8Name name, double value) {
+    beginTextElement(name);
+    m_out->append(QByteArray::number(value, 'g', 15));
+    endTextElement(name);
+}
+
+void XmlUtf8Writer::writeTextElement(XmlUtf8Name name, bool value) {
+    beginTextElement(name);
+    m_out->append(value ? "true" : "false");
+    endTextElement(name);
+}
+
+void XmlUtf8Writer::writeTextElement(XmlUtf8Name name, const QDateTime& value) {
+    writeTextElement(name, value.toString(Qt::ISODate));
+}
+
+void XmlUtf8Writer::writeTextElement(XmlUtf8Name name, const QDate& value) {
+    writeTextElement(name, value.toString(Qt::ISODate));
+}
+
+void XmlUtf8Writer::writeTextElement(XmlUtf8Name name, const QTime& value) {
+    writeTextElement(name, value.toString(Qt::ISODate));
+}
+
+void XmlUtf8Writer::finishStartElement() {
+    if (m_inStartElement) {
+        m_out->append('>');
+        m_inStartElement = false;
+    }
+}
+
+void XmlUtf8Writer::beginTextElement(XmlUtf8Name name) {
+    finishStartElement();
+    m_out->append('<');
+    m_out->append(name.data, name.size);
+    if (!m_pendingNamespaces.isEmpty()) {
+        m_out->append(m_pendingNamespaces);
+        m_pendingNamespaces.clear();
+    }
+    m_out->append('>');
+}
+
+void XmlUtf8Writer::endTextElement(XmlUtf8Name name) {
+    m_out->append("</");
+    m_out->append(name.data, name.size);
+    m_out->append('>');
+}
+
+void XmlUtf8Writer::appendInt(qint64 value) {
+    // Unsigned arithmetic keeps the minimum representable
+    appendUInt(value < 0 ? 0u - quint64(value) : quint64(value), value < 0);
+}
+
+void XmlUtf8Writer::appendUInt(quint64 value, bool negative) {
+    char digits[21];
+    char* end = digits + sizeof(digits);
+    char* p = end;
+
+    do {
+        *--p = char('0' + value % 10);
+        value /= 10;
+    } while (value);
+    if (negative) {
+        *--p = '-';
+    }
+
+    m_out->append(p, int(end - p));
+}
+
+bool XmlUtf8Writer::appendEscaped(QByteArray& out, const QChar* text, int length, bool escapeWhitespace) {
+    const ushort* src = reinterpret_cast<const ushort*>(text);
+    const ushort* const end = src + length;
+
+    // Worst case is "&quot;" for every UTF-16 unit; trimmed afterwards
+    const int start = out.size();
+    out.resize(start + 6 * length);
+    char* dst = out.data() + start;
+    bool ok = true;
+
+#ifdef XSDQT_HAVE_SSE2
+    const __m128i lt = _mm_set1_epi16('<');
+    const __m128i gt = _mm_set1_epi16('>');
+    const __m128i amp = _mm_set1_epi16('&');
+    const __m128i quot = _mm_set1_epi16('"');
+    const __m128i firstPrintable = _mm_set1_epi16(0x20);
+    const __m128i lastAscii = _mm_set1_epi16(0x7f);
+    const __m128i zero = _mm_setzero_si128();
+#endif
+
+    while (src < end) {
+#ifdef XSDQT_HAVE_SSE2
+        // Copy runs of plain ASCII eight units at a time
+        while (end - src >= 8) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+            const __m128i markup = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi16(chunk, lt), _mm_cmpeq_epi16(chunk, gt)),
+                _mm_or_si128(_mm_cmpeq_epi16(chunk, amp), _mm_cmpeq_epi16(chunk, quot)));
+            // Non-zero where the unit is a control character or beyond ASCII
+            const __m128i outside = _mm_or_si128(_mm_subs_epu16(firstPrintable, chunk),
+                                                 _mm_subs_epu16(chunk, lastAscii));
+            const int plainMask = _mm_movemask_epi8(_mm_cmpeq_epi16(outside, zero))
+                                & ~_mm_movemask_epi8(markup);
+
+            if (plainMask == 0xffff) {
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(chunk, chunk));
+                src += 8;
+                dst += 8;
+                continue;
+            }
+
+            const int plain = int(qCountTrailingZeroBits(quint32(~plainMask))) / 2;
+            for (int i = 0; i < plain; ++i) {
+                *dst++ = char(src[i]);
+            }
+            src += plain;
+            break;
+        }
+        if (src == end) {
+            break;
+        }
+#endif
+        const ushort c = *src++;
+        switch (c) {
+        case '<': dst = appendLiteral(dst, "&lt;", 4); break;
+        case '>': dst = appendLiteral(dst, "&gt;", 4); break;
+        case '&': dst = appendLiteral(dst, "&amp;", 5); break;
+        case '"': dst = appendLiteral(dst, "&quot;", 6); break;
+        case '\t':
+            if (escapeWhitespace) dst = appendLiteral(dst, "&#9;", 4);
+            else *dst++ = '\t';
+            break;
+        case '\n':
+            if (escapeWhitespace) dst = appendLiteral(dst, "&#10;", 5);
+            else *dst++ = '\n';
+            break;
+        case '\r':
+            if (escapeWhitespace) dst = appendLiteral(dst, "&#13;", 5);
+            else *dst++ = '\r';
+            break;
+        default:
+            if (c < 0x20 || c >= 0xfffe) {
+                // Not representable in XML 1.0
+                ok = false;
+            } else if (c < 0x80) {
+                *dst++ = char(c);
+            } else if (c < 0x800) {
+                *dst++ = char(0xc0 | (c >> 6));
+                *dst++ = char(0x80 | (c & 0x3f));
+            } else if (QChar::isHighSurrogate(c) && src < end && QChar::isLowSurrogate(*src)) {
+                const uint ucs4 = QChar::surrogateToUcs4(c, *src++);
+                *dst++ = char(0xf0 | (ucs4 >> 18));
+                *dst++ = char(0x80 | ((ucs4 >> 12) & 0x3f));
+                *dst++ = char(0x80 | ((ucs4 >> 6) & 0x3f));
+                *dst++ = char(0x80 | (ucs4 & 0x3f));
+            } else if (QChar::isSurrogate(c)) {
+                // Unpaired surrogate, replaced like Qt's UTF-8 codec does
+                *dst++ = '?';
+            } else {
+                *dst++ = char(0xe0 | (c >> 12));
+                *dst++ = char(0x80 | ((c >> 6) & 0x3f));
+                *dst++ = char(0x80 | (c & 0x3f));
+            }
+            break;
+        }
+    }
+
+    out.resize(int(dst - out.constData()));
+    return ok;
+}
+
+} // namespace XsdQt
@@ -0,0 +1,115 @@
+#ifndef XMLUTF8WRITER_H
+#define XMLUTF8WRITER_H
+
+#include <QByteArray>
+#include <QDate>
+#include <QDateTime>
+#include <QString>
+#include <QTime>
+#include <QVector>
+#include <cstddef>
+
+namespace XsdQt {
+
+/**
+ * Pre-encoded UTF-8 element or attribute name
+ * Built from string literals at compile time, so no conversion at runtime
+ */
+struct XmlUtf8Name {
+    template<std::size_t N>
+    constexpr XmlUtf8Name(const char (&name)[N]) : data(name), size(int(N - 1)) {}
+    constexpr XmlUtf8Name(const char* name, int size) : data(name), size(size) {}
+
+    const char* data;
+    int size;
+};
+
+/**
+ * Direct UTF-8 XML writer for generated toXml code
+ *
+ * Appends to a caller-owned QByteArray instead of going through
+ * QXmlStreamWriter's codec. Tag names are pre-encoded constants and text
+ * is escaped in 8-character SSE2 blocks where available. The output is
+ * byte-identical to QXmlStreamWriter with auto-formatting disabled.
+ */
+class XmlUtf8Writer {
+public:
+    explicit XmlUtf8Writer(QByteArray* buffer = nullptr);
+
+    /**
+     * Target buffer, appended to (not cleared)
+     */
+    void setBuffer(QByteArray* buffer) { m_out = buffer; }
+    QByteArray* buffer() const { return m_out; }
+
+    /**
+     * Forget open elements, pending namespaces and errors
+     */
+    void reset();
+
+    void writeStartDocument();
+    void writeEndDocument();
+
+    /**
+     * Declare a namespace on the next start element
+     */
+    void writeNamespace(const QString& namespaceUri, const QString& prefix);
+
+    template<std::size_t N>
+    void writeStartElement(const char (&name)[N]) { writeStartElement(XmlUtf8Name(name)); }
+    void writeStartElement(XmlUtf8Name name);
+    void writeStartElement(const QString& name);
+    void writeEndElement();
+
+    void writeAttribute(XmlUtf8Name name, const QString& value);
+    void writeAttribute(XmlUtf8Name name, int value);
+    void writeAttribute(XmlUtf8Name name, qint64 value);
+    void writeAttribute(XmlUtf8Name name, quint32 value) { writeAttribute(name, quint64(value)); }
+    void writeAttribute(XmlUtf8Name name, quint64 value);
+    void writeAttribute(XmlUtf8Name name, double value);
+    void writeAttribute(XmlUtf8Name name, bool value);
+
+    void writeCharacters(const QString& text);
+
+    void writeTextElement(XmlUtf8Name name, const QString& value);
+    void writeTextElement(XmlUtf8Name name, int value);
+    void writeTextElement(XmlUtf8Name name, qint64 value);
+    void writeTextElement(XmlUtf8Name name, quint32 value) { writeTextElement(name, quint64(value)); }
+    void writeTextElement(XmlUtf8Name name, quint64 value);
+    void writeTextElement(XmlUtf8Name name, double value);
+    void writeTextElement(XmlUtf8Name name, bool value);
+    void writeTextElement(XmlUtf8Name name, const QDateTime& value);
+    void writeTextElement(XmlUtf8Name name, const QDate& value);
+    void writeTextElement(XmlUtf8Name name, const QTime& value);
+
+    /**
+     * Set when text contained characters XML cannot represent
+     * (they are dropped, as QXmlStreamWriter does)
+     */
+    bool hasError() const { return m_hasError; }
+
+    /**
+     * Append text escaped for element content (escapeWhitespace = false)
+     * or attribute values (tab, newline and carriage return as references)
+     * Returns false if characters had to be dropped
+     */
+    static bool appendEscaped(QByteArray& out, const QChar* text, int length, bool escapeWhitespace);
+
+private:
+    void finishStartElement();
+    void beginTextElement(XmlUtf8Name name);
+    void endTextElement(XmlUtf8Name name);
+    void appendInt(qint64 value);
+    void appendUInt(quint64 value, bool negative = false);
+
+    QByteArray* m_out;
+    QByteArray m_names;          // names of open elements, back to back
+    QVector<int> m_nameOffsets;  // start of each open name in m_names
+    QByteArray m_pendingNamespaces;
+    bool m_inStartElement;
+    bool m_hasError;
+};
+
+} // namespace XsdQt
+
+#endif // XMLUTF8WRITER_H
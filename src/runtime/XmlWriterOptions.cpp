@@ -0,0 +1,58 @@
+#include "XmlWriterOptions.h"
+#include "XmlHelpers.h"
+#include "XmlUtf8Writer.h"
+
+namespace XsdQt {
+
+XmlWriterOptions::XmlWriterOptions()
+    : autoFormatting(true), indent(2), codec("UTF-8"), writeDeclaration(true), directUtf8(false)
+{
+    namespaces.append(qMakePair(XmlHelpers::xsiNamespaceUri(), QString("xsi")));
+}
+
+XmlWriterOptions XmlWriterOptions::compact() {
+    XmlWriterOptions options;
+    options.autoFormatting = false;
+    return options;
+}
+
+XmlWriterOptions XmlWriterOptions::pretty(int indent) {
+    XmlWriterOptions options;
+    options.indent = indent;
+    return options;
+}
+
+void XmlWriterOptions::configure(QXmlStreamWriter& writer) const {
+    writer.setAutoFormatting(autoFormatting);
+    if (autoFormatting) {
+        writer.setAutoFormattingIndent(indent);
+    }
+    if (!codec.isEmpty()) {
+        writer.setCodec(codec.constData());
+    }
+}
+
+void XmlWriterOptions::writeStartDocument(QXmlStreamWriter& writer) const {
+    if (writeDeclaration) {
+        writer.writeStartDocument();
+    }
+    for (const auto& ns : namespaces) {
+        writer.writeNamespace(ns.first, ns.second);
+    }
+}
+
+void XmlWriterOptions::writeStartDocument(XmlUtf8Writer& writer) const {
+    if (writeDeclaration) {
+        writer.writeStartDocument();
+    }
+    for (const auto& ns : namespaces) {
+        writer.writeNamespace(ns.first, ns.second);
+    }
+}
+
+bool XmlWriterOptions::canWriteUtf8Directly() const {
+    return directUtf8 && !autoFormatting
+        && (codec.isEmpty() || codec.compare("UTF-8", Qt::CaseInsensitive) == 0);
+}
+
+} // namespace XsdQt
@@ -0,0 +1,55 @@
+#ifndef XMLWRITEROPTIONS_H
+#define XMLWRITEROPTIONS_H
+
+#include <QByteArray>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QXmlStreamWriter>
+
+namespace XsdQt {
+
+class XmlUtf8Writer;
+
+/**
+ * Output settings for XmlDocument and XmlCodecContext
+ *
+ * The defaults reproduce the historical output (indented by two spaces,
+ * UTF-8, XML declaration, xsi namespace on the root). compact() drops all
+ * formatting whitespace, which keeps QXmlStreamWriter on its cheapest path.
+ */
+struct XmlWriterOptions {
+    XmlWriterOptions();
+
+    static XmlWriterOptions compact();
+    static XmlWriterOptions pretty(int indent = 2);
+
+    bool autoFormatting;
+    int indent;                 // spaces per level, negative for tabs
+    QByteArray codec;           // name passed to QXmlStreamWriter::setCodec()
+    bool writeDeclaration;      // emit <?xml ...?>
+    QList<QPair<QString, QString>> namespaces; // namespace URI, prefix
+    bool directUtf8;            // use XmlUtf8Writer where the types support it
+
+    /**
+     * True if the direct UTF-8 writer can produce this output
+     * (compact layout and UTF-8 encoding only)
+     */
+    bool canWriteUtf8Directly() const;
+
+    /**
+     * Apply formatting and codec settings to a writer
+     */
+    void configure(QXmlStreamWriter& writer) const;
+
+    /**
+     * Write the declaration (if enabled) and the namespace declarations
+     * that go on the next start element
+     */
+    void writeStartDocument(QXmlStreamWriter& writer) const;
+    void writeStartDocument(XmlUtf8Writer& writer) const;
+};
+
+} // namespace XsdQt
+
+#endif // XMLWRITEROPTIONS_H
@@ -8,12 +8,33 @@ CONFIG += staticlib c++14
 DEFINES += QT_DEPRECATED_WARNINGS
 
 SOURCES += \
-    runtime/XmlHelpers.cpp
+    runtime/XmlHelpers.cpp \
+    runtime/XmlCodecContext.cpp \
+    runtime/XmlWriterOptions.cpp \
+    runtime/XmlUtf8Writer.cpp \
+    runtime/XmlFastReader.cpp \
+    runtime/XmlAttributeBinder.cpp \
+    runtime/XmlStringPool.cpp \
+    runtime/XmlNameHash.cpp \
+    runtime/XmlFacets.cpp \
+    runtime/XmlParseErrors.cpp
 
 HEADERS += \
     runtime/XmlSerializable.h \
     runtime/XmlHelpers.h \
-    runtime/XmlDocument.h
+    runtime/XmlDocument.h \
+    runtime/XmlBatchLoader.h \
+    runtime/XmlCodecContext.h \
+    runtime/XmlWriterOptions.h \
+    runtime/XmlUtf8Writer.h \
+    runtime/XmlFastReader.h \
+    runtime/XmlAttributeBinder.h \
+    runtime/XmlStringPool.h \
+    runtime/XmlNameHash.h \
+    runtime/XmlEnum.h \
+    runtime/XmlFacets.h \
+    runtime/XmlParseErrors.h \
+    runtime/XmlChoice.h
 
 # Installation
 unix {
@@ -1,187 +1,15 @@
 #include <QtTest>
 #include <QDebug>
 #include "XmlDocument.h"
+#include "XmlBatchLoader.h"
 #include "XmlHelpers.h"
-
-// Mock generated classes for testing
-class Vehicle : public XsdQt::XmlSerializable {
-public:
-    Vehicle() : m_year(0) {}
-    virtual ~Vehicle() = default;
-    
-    QString getLicensePlate() const { return m_licensePlate; }
-    void setLicensePlate(const QString& value) { m_licensePlate = value; }
-    
-    int getYear() const { return m_year; }
-    void setYear(int value) { m_year = value; }
-    
-    QString getManufacturer() const { return m_manufacturer; }
-    void setManufacturer(const QString& value) { m_manufacturer = value; }
-    
-    QString getId() const { return m_id; }
-    void setId(const QString& value) { m_id = value; }
-    
-    void toXml(QXmlStreamWriter& writer) const override {
-        XsdQt::XmlHelpers::writeAttribute(writer, "id", m_id);
-        XsdQt::XmlHelpers::writeElement(writer, "licensePlate", m_licensePlate);
-        XsdQt::XmlHelpers::writeElement(writer, "year", m_year);
-        XsdQt::XmlHelpers::writeElement(writer, "manufacturer", m_manufacturer);
-    }
-    
-    bool fromXml(QXmlStreamReader& reader) override {
-        m_id = XsdQt::XmlHelpers::readAttribute(reader, "id");
-        
-        while (!reader.atEnd()) {
-            reader.readNext();
-            
-            if (reader.isEndElement()) {
-                break;
-            }
-            
-            if (reader.isStartElement()) {
-                QString name = reader.name().toString();
-                
-                if (name == "licensePlate") {
-                    m_licensePlate = XsdQt::XmlHelpers::readElementText(reader);
-                }
-                else if (name == "year") {
-                    m_year = XsdQt::XmlHelpers::readInt(reader);
-                }
-                else if (name == "manufacturer") {
-                    m_manufacturer = XsdQt::XmlHelpers::readElementText(reader);
-                }
-            }
-        }
-        
-        return true;
-    }
-    
-    QString xmlElementName() const override { return "vehicle"; }
-    QString xsdTypeName() const override { return "VehicleType"; }
-    
-protected:
-    QString m_licensePlate;
-    int m_year;
-    QString m_manufacturer;
-    QString m_id;
-};
-
-class Car : public Vehicle {
-public:
-    Car() : m_numDoors(0), m_trunkCapacity(0.0) {}
-    
-    int getNumDoors() const { return m_numDoors; }
-    void setNumDoors(int value) { m_numDoors = value; }
-    
-    double getTrunkCapacity() const { return m_trunkCapacity; }
-    void setTrunkCapacity(double value) { m_trunkCapacity = value; }
-    
-    void toXml(QXmlStreamWriter& writer) const override {
-        Vehicle::toXml(writer);
-        XsdQt::XmlHelpers::writeElement(writer, "numDoors", m_numDoors);
-        XsdQt::XmlHelpers::writeElement(writer, "trunkCapacity", m_trunkCapacity);
-    }
-    
-    bool fromXml(QXmlStreamReader& reader) override {
-        m_id = XsdQt::XmlHelpers::readAttribute(reader, "id");
-        
-        while (!reader.atEnd()) {
-            reader.readNext();
-            
-            if (reader.isEndElement()) {
-                break;
-            }
-            
-            if (reader.isStartElement()) {
-                QString name = reader.name().toString();
-                
-                if (name == "licensePlate") {
-                    m_licensePlate = XsdQt::XmlHelpers::readElementText(reader);
-                }
-                else if (name == "year") {
-                    m_year = XsdQt::XmlHelpers::readInt(reader);
-                }
-                else if (name == "manufacturer") {
-                    m_manufacturer = XsdQt::XmlHelpers::readElementText(reader);
-                }
-                else if (name == "numDoors") {
-                    m_numDoors = XsdQt::XmlHelpers::readInt(reader);
-                }
-                else if (name == "trunkCapacity") {
-                    m_trunkCapacity = XsdQt::XmlHelpers::readDouble(reader);
-                }
-            }
-        }
-        
-        return true;
-    }
-    
-    QString xmlElementName() const override { return "car"; }
-    QString xsdTypeName() const override { return "CarType"; }
-    
-private:
-    int m_numDoors;
-    double m_trunkCapacity;
-};
-
-class Fleet : public XsdQt::XmlSerializable {
-public:
-    Fleet() {}
-    
-    QString getName() const { return m_name; }
-    void setName(const QString& value) { m_name = value; }
-    
-    const QList<QSharedPointer<Vehicle>>& getVehicles() const { return m_vehicles; }
-    void addVehicle(const QSharedPointer<Vehicle>& vehicle) { m_vehicles.append(vehicle); }
-    
-    void toXml(QXmlStreamWriter& writer) const override {
-        XsdQt::XmlHelpers::writeElement(writer, "name", m_name);
-        
-        for (const auto& vehicle : m_vehicles) {
-            if (vehicle) {
-                XsdQt::XmlHelpers::writePolymorphicElement(writer, vehicle);
-            }
-        }
-    }
-    
-    bool fromXml(QXmlStreamReader& reader) override {
-        while (!reader.atEnd()) {
-            reader.readNext();
-            
-            if (reader.isEndElement()) {
-                break;
-            }
-            
-            if (reader.isStartElement()) {
-                QString name = reader.name().toString();
-                
-                if (name == "name") {
-                    m_name = XsdQt::XmlHelpers::readElementText(reader);
-                }
-                else if (name == "vehicle" || name == "car" || name == "truck") {
-                    auto vehicle = XsdQt::XmlHelpers::readPolymorphicElement(reader);
-                    if (vehicle) {
-                        m_vehicles.append(vehicle.dynamicCast<Vehicle>());
-                    }
-                }
-            }
-        }
-        
-        return true;
-    }
-    
-    QString xmlElementName() const override { return "fleet"; }
-    QString xsdTypeName() const override { return "FleetType"; }
-    
-private:
-    QString m_name;
-    QList<QSharedPointer<Vehicle>> m_vehicles;
-};
-
-// Register types
-static XsdQt::XmlTypeRegistrar<Vehicle> vehicleReg("vehicle", "VehicleType");
-static XsdQt::XmlTypeRegistrar<Car> carReg("car", "CarType");
-static XsdQt::XmlTypeRegistrar<Fleet> fleetReg("fleet", "FleetType");
+#include "XmlAttributeBinder.h"
+#include "XmlChoice.h"
+#include "VehicleTypes.h"
+#include "XsdParser.h"
+#include "CodeGenerator.h"
+#include "InspectionsAll.h"
+#include <limits>
 
 class TestXmlSerialization : public QObject {
     Q_OBJECT
@@ -191,9 +19,31 @@ private slots:
     void testCarInheritance();
     void testFleetWithMultipleVehicles();
     void testPolymorphicDeserialization();
+    void testRegistrationTable();
     void testXmlDocumentSaveLoad();
     void testAttributes();
     void testTypeConversions();
+    void testWideIntegers();
+    void testNarrowIntegers();
+    void testGeneratedEnum();
+    void testFacetValidation();
+    void testParseErrors();
+    void testOccurrenceChecks();
+    void testPredictedSequence();
+    void testGeneratorOutput();
+    void testGeneratedTypes();
+    void testChoiceStorage();
+    void testOptionalPresence();
+    void testColumns();
+    void testListMoves();
+    void testBuilders();
+    void testBatchLoader();
+    void testCodecContextReuse();
+    void testStringPool();
+    void testCompactWriterOptions();
+    void testDirectUtf8Writer();
+    void testFastReader();
+    void testFastReaderRejects();
 };
 
 void TestXmlSerialization::testSimpleVehicle() {
@@ -328,6 +178,56 @@ void TestXmlSerialization::testPolymorphicDeserialization() {
     QVERIFY(car);
     QCOMPARE(car->getLicensePlate(), QString("CCC-222"));
     QCOMPARE(car->getNumDoors(), 4);
+    
+    // xsi:type on the head element still goes through the factory
+    QString xsiXml = R"(<?xml version="1.0"?>
+<fleet xmlns:xsi="http://www.w3.org/2001/XMLSchema-instance">
+    <vehicle xsi:type="CarType" id="C002">
+        <licensePlate>CCC-333</licensePlate>
+        <numDoors>2</numDoors>
+    </vehicle>
+</fleet>)";
+    
+    XsdQt::XmlDocument<Fleet> xsiDoc;
+    QVERIFY2(xsiDoc.loadFromString(xsiXml, &errorMsg), qPrintable(errorMsg));
+    QCOMPARE(xsiDoc.root()->getVehicles().size(), 1);
+    auto xsiCar = xsiDoc.root()->getVehicles()[0].dynamicCast<Car>();
+    QVERIFY(xsiCar);
+    QCOMPARE(xsiCar->getNumDoors(), 2);
+
+    // Both readers report the same xsi:type view
+    QXmlStreamReader streamReader(xsiXml);
+    while (!streamReader.isStartElement() || streamReader.name() != QLatin1String("vehicle")) {
+        streamReader.readNext();
+    }
+    QCOMPARE(XsdQt::XmlHelpers::xsiTypeView(streamReader).toString(), QString("CarType"));
+
+    XsdQt::XmlFastReader fastReader(xsiXml.toUtf8());
+    while (!fastReader.isStartElement() || fastReader.name() != "vehicle") {
+        fastReader.readNext();
+    }
+    QCOMPARE(XsdQt::XmlHelpers::xsiTypeView(fastReader).toString(), QString("CarType"));
+}
+
+void TestXmlSerialization::testRegistrationTable() {
+    // Shape of a generated registerAllTypes() table, under names the
+    // static registrars don't use
+    static constexpr XsdQt::XmlTypeEntry types[] = {
+        { "tableCar", "TableCarType", &XsdQt::createXmlType<Car> },
+        { "tableVehicle", "", &XsdQt::createXmlType<Vehicle> },
+    };
+    
+    XsdQt::XmlTypeFactory& factory = XsdQt::XmlTypeFactory::instance();
+    factory.registerTypes(types);
+    
+    QVERIFY(factory.createByElement("tableCar").dynamicCast<Car>());
+    QVERIFY(factory.createByType("TableCarType").dynamicCast<Car>());
+    QCOMPARE(factory.getTypeForElement("tableCar"), QString("TableCarType"));
+    QVERIFY(factory.createByElement("tableVehicle"));
+    QVERIFY(!factory.createByType(""));
+    
+    // Static registrations are still there
+    QVERIFY(factory.createByElement("car").dynamicCast<Car>());
 }
 
 void TestXmlSerialization::testXmlDocumentSaveLoad() {
@@ -373,6 +273,38 @@ void TestXmlSerialization::testAttributes() {
     QVERIFY2(success, qPrintable(errorMsg));
     QCOMPARE(doc.root()->getId(), QString("ATTR-001"));
     QCOMPARE(doc.root()->getLicensePlate(), QString("ATTR-123"));
+    
+    // Prefixed attributes don't bind to a member of the same local name
+    QString prefixedXml = R"(<vehicle xmlns:x="urn:x" x:id="X" id="ATTR-002"/>)";
+    XsdQt::XmlDocument<Vehicle> prefixedDoc;
+    QVERIFY2(prefixedDoc.loadFromString(prefixedXml, &errorMsg), qPrintable(errorMsg));
+    QCOMPARE(prefixedDoc.root()->getId(), QString("ATTR-002"));
+    
+    // Both binders hash and convert alike, non-ASCII names included
+    QString bindXml = R"(<vehicle id="ATTR-003" größe="1" flag="TRUE" count=" 7"/>)";
+    QXmlStreamReader streamReader(bindXml);
+    streamReader.readNextStartElement();
+    const XsdQt::XmlAttributeBinder<QXmlStreamReader> streamAttributes(streamReader);
+    
+    XsdQt::XmlFastReader fastReader(bindXml.toUtf8());
+    while (!fastReader.isStartElement()) {
+        fastReader.readNext();
+    }
+    const XsdQt::XmlAttributeBinder<XsdQt::XmlFastReader> fastAttributes(fastReader);
+    
+    QCOMPARE(streamAttributes.count(), 4);
+    QCOMPARE(fastAttributes.count(), 4);
+    for (int i = 0; i < 4; ++i) {
+        QCOMPARE(streamAttributes.nameHash(i), fastAttributes.nameHash(i));
+    }
+    QCOMPARE(streamAttributes.nameHash(1), XsdQt::xmlNameHash("größe"));
+    QVERIFY(streamAttributes.nameIs(1, "größe"));
+    QVERIFY(!streamAttributes.nameIs(1, "größ"));
+    QVERIFY(fastAttributes.nameIs(1, "größe"));
+    QCOMPARE(streamAttributes.toBool(2), true);
+    QCOMPARE(fastAttributes.toBool(2), true);
+    QCOMPARE(streamAttributes.toInt(3), 7);
+    QCOMPARE(fastAttributes.toInt(3), 7);
 }
 
 void TestXmlSerialization::testTypeConversions() {
@@ -403,5 +335,1207 @@ void TestXmlSerialization::testTypeConversions() {
     QCOMPARE(doc.root()->getManufacturer(), QString("TypeTest"));
 }
 
+void TestXmlSerialization::testWideIntegers() {
+    // xs:long, xs:unsignedInt and xs:unsignedLong values outside int range,
+    // read as generated code reads them through both readers
+    const QString xml = R"(<record total="-9223372036854775808" count="4294967295">)"
+                        R"(<long>3000000000</long><unsignedInt>4294967295</unsignedInt>)"
+                        R"(<unsignedLong>18446744073709551615</unsignedLong><tooLong>9223372036854775808</tooLong>)"
+                        R"(<negative>-1</negative></record>)";
+    
+    QXmlStreamReader streamReader(xml);
+    XsdQt::XmlFastReader fastReader(xml.toUtf8());
+    QVERIFY(streamReader.readNextStartElement());
+    while (!fastReader.isStartElement()) {
+        fastReader.readNext();
+    }
+    
+    const XsdQt::XmlAttributeBinder<QXmlStreamReader> streamAttributes(streamReader);
+    const XsdQt::XmlAttributeBinder<XsdQt::XmlFastReader> fastAttributes(fastReader);
+    bool ok = false;
+    QCOMPARE(streamAttributes.toInt64(0, 0, &ok), std::numeric_limits<qint64>::min());
+    QVERIFY(ok);
+    QCOMPARE(fastAttributes.toInt64(0, 0, &ok), std::numeric_limits<qint64>::min());
+    QVERIFY(ok);
+    QCOMPARE(streamAttributes.toUInt64(1, 0, &ok), quint64(4294967295u));
+    QVERIFY(ok);
+    QCOMPARE(fastAttributes.toUInt64(1, 0, &ok), quint64(4294967295u));
+    QVERIFY(ok);
+    fastAttributes.toInt(1, 0, &ok);
+    QVERIFY(!ok);
+    
+    auto next = [](auto& reader) {
+        do {
+            reader.readNext();
+        } while (!reader.isStartElement() && !reader.atEnd());
+    };
+    
+    next(streamReader);
+    next(fastReader);
+    QCOMPARE(XsdQt::XmlHelpers::readInt64(streamReader, &ok), qint64(3000000000LL));
+    QVERIFY(ok);
+    QCOMPARE(XsdQt::XmlHelpers::readInt64(fastReader, &ok), qint64(3000000000LL));
+    QVERIFY(ok);
+    
+    next(streamReader);
+    next(fastReader);
+    QCOMPARE(XsdQt::XmlHelpers::readUInt64(streamReader, &ok), quint64(4294967295u));
+    QVERIFY(ok);
+    QCOMPARE(XsdQt::XmlHelpers::readUInt64(fastReader, &ok), quint64(4294967295u));
+    QVERIFY(ok);
+    
+    next(streamReader);
+    next(fastReader);
+    QCOMPARE(XsdQt::XmlHelpers::readUInt64(streamReader, &ok), std::numeric_limits<quint64>::max());
+    QVERIFY(ok);
+    QCOMPARE(XsdQt::XmlHelpers::readUInt64(fastReader, &ok), std::numeric_limits<quint64>::max());
+    QVERIFY(ok);
+    
+    // Overflow and negative unsigned values don't convert
+    QString text;
+    next(streamReader);
+    next(fastReader);
+    XsdQt::XmlHelpers::readInt64(streamReader, &ok, &text);
+    QVERIFY(!ok);
+    QCOMPARE(text, QString("9223372036854775808"));
+    XsdQt::XmlHelpers::readInt64(fastReader, &ok);
+    QVERIFY(!ok);
+    
+    next(streamReader);
+    next(fastReader);
+    XsdQt::XmlHelpers::readUInt64(streamReader, &ok);
+    QVERIFY(!ok);
+    XsdQt::XmlHelpers::readUInt64(fastReader, &ok);
+    QVERIFY(!ok);
+    
+    // Written as generated toXml() writes them, and read back at full width
+    QString written;
+    QXmlStreamWriter writer(&written);
+    writer.writeStartElement("record");
+    XsdQt::XmlHelpers::writeAttribute(writer, "total", std::numeric_limits<qint64>::min());
+    XsdQt::XmlHelpers::writeAttribute(writer, "count", std::numeric_limits<quint32>::max());
+    XsdQt::XmlHelpers::writeAttribute(writer, "big", std::numeric_limits<quint64>::max());
+    XsdQt::XmlHelpers::writeAttribute(writer, "ratio", 2.5);
+    XsdQt::XmlHelpers::writeElement(writer, "long", qint64(3000000000LL));
+    XsdQt::XmlHelpers::writeElement(writer, "unsignedInt", std::numeric_limits<quint32>::max());
+    XsdQt::XmlHelpers::writeElement(writer, "unsignedLong", std::numeric_limits<quint64>::max());
+    writer.writeEndElement();
+    
+    auto readBack = [](auto& reader) {
+        while (!reader.isStartElement()) {
+            reader.readNext();
+        }
+        using Reader = typename std::remove_reference<decltype(reader)>::type;
+        const XsdQt::XmlAttributeBinder<Reader> attributes(reader);
+        bool ok = false;
+        QCOMPARE(attributes.toInt64(0, 0, &ok), std::numeric_limits<qint64>::min());
+        QVERIFY(ok);
+        QCOMPARE(attributes.toUInt64(1, 0, &ok), quint64(std::numeric_limits<quint32>::max()));
+        QVERIFY(ok);
+        QCOMPARE(attributes.toUInt64(2, 0, &ok), std::numeric_limits<quint64>::max());
+        QVERIFY(ok);
+        QCOMPARE(attributes.toDouble(3, 0, &ok), 2.5);
+        QVERIFY(ok);
+        
+        reader.readNext();
+        QCOMPARE(XsdQt::XmlHelpers::readInt64(reader, &ok), qint64(3000000000LL));
+        QVERIFY(ok);
+        reader.readNext();
+        QCOMPARE(XsdQt::XmlHelpers::readUInt64(reader, &ok), quint64(std::numeric_limits<quint32>::max()));
+        QVERIFY(ok);
+        reader.readNext();
+        QCOMPARE(XsdQt::XmlHelpers::readUInt64(reader, &ok), std::numeric_limits<quint64>::max());
+        QVERIFY(ok);
+    };
+    QXmlStreamReader writtenStream(written);
+    readBack(writtenStream);
+    XsdQt::XmlFastReader writtenFast(written.toUtf8());
+    readBack(writtenFast);
+}
+
+void TestXmlSerialization::testNarrowIntegers() {
+    // xs:byte, xs:unsignedShort, xs:unsignedInt and xs:unsignedByte values
+    // outside their type, read as generated code reads them
+    const QString xml = R"(<record small="-128" count="-1" total="65535">)"
+                        R"(<byte>300</byte><unsignedInt>4294967296</unsignedInt>)"
+                        R"(<unsignedByte>255</unsignedByte></record>)";
+    
+    auto check = [](auto& reader) {
+        while (!reader.isStartElement()) {
+            reader.readNext();
+        }
+        auto next = [&reader]() {
+            do {
+                reader.readNext();
+            } while (!reader.isStartElement() && !reader.atEnd());
+        };
+        
+        using Reader = typename std::remove_reference<decltype(reader)>::type;
+        const XsdQt::XmlAttributeBinder<Reader> attributes(reader);
+        bool ok = false;
+        qint8 small = 1;
+        small = XsdQt::XmlHelpers::narrowed<qint8>(attributes.toInt(0, small, &ok), small, &ok);
+        QVERIFY(ok);
+        QCOMPARE(small, qint8(-128));
+        quint16 count = 7;
+        count = XsdQt::XmlHelpers::narrowed<quint16>(attributes.toUInt64(1, count, &ok), count, &ok);
+        QVERIFY(!ok);
+        QCOMPARE(count, quint16(7));
+        quint16 total = 0;
+        total = XsdQt::XmlHelpers::narrowed<quint16>(attributes.toUInt64(2, total, &ok), total, &ok);
+        QVERIFY(ok);
+        QCOMPARE(total, quint16(65535));
+        
+        // Out of range fails like text that doesn't convert, reporting the value
+        QString text;
+        next();
+        const qint8 byte = XsdQt::XmlHelpers::narrowed<qint8>(XsdQt::XmlHelpers::readInt(reader, &ok, &text), qint8(), &ok, &text);
+        QVERIFY(!ok);
+        QCOMPARE(byte, qint8(0));
+        QCOMPARE(text, QString("300"));
+        
+        next();
+        XsdQt::XmlHelpers::narrowed<quint32>(XsdQt::XmlHelpers::readUInt64(reader, &ok, &text), quint32(), &ok, &text);
+        QVERIFY(!ok);
+        QCOMPARE(text, QString("4294967296"));
+        
+        next();
+        const quint8 unsignedByte = XsdQt::XmlHelpers::narrowed<quint8>(XsdQt::XmlHelpers::readUInt64(reader, &ok, &text), quint8(), &ok, &text);
+        QVERIFY(ok);
+        QCOMPARE(unsignedByte, quint8(255));
+    };
+    
+    QXmlStreamReader streamReader(xml);
+    check(streamReader);
+    XsdQt::XmlFastReader fastReader(xml.toUtf8());
+    check(fastReader);
+}
+
+void TestXmlSerialization::testGeneratedEnum() {
+    const QString xml = R"(<fuels kind="hybrid"><fuel>diesel</fuel><fuel>electric</fuel><fuel>kerosene</fuel><fuel>Petrol</fuel></fuels>)";
+    const FuelType expected[] = { FuelType::Diesel, FuelType::Electric, FuelType::Petrol, FuelType::Petrol };
+    
+    // Same results from both readers; unknown or wrongly cased values keep the default
+    QXmlStreamReader streamReader(xml);
+    streamReader.readNextStartElement();
+    QCOMPARE(XsdQt::XmlAttributeBinder<QXmlStreamReader>(streamReader).toEnum(0, FuelType::Petrol), FuelType::Hybrid);
+    for (FuelType fuel : expected) {
+        QVERIFY(streamReader.readNextStartElement());
+        QCOMPARE(XsdQt::XmlHelpers::readEnum(streamReader, FuelType::Petrol), fuel);
+    }
+    
+    XsdQt::XmlFastReader fastReader(xml.toUtf8());
+    while (!fastReader.isStartElement()) {
+        fastReader.readNext();
+    }
+    QCOMPARE(XsdQt::XmlAttributeBinder<XsdQt::XmlFastReader>(fastReader).toEnum(0, FuelType::Petrol), FuelType::Hybrid);
+    for (FuelType fuel : expected) {
+        do {
+            fastReader.readNext();
+        } while (!fastReader.isStartElement());
+        QCOMPARE(XsdQt::XmlHelpers::readEnum(fastReader, FuelType::Petrol), fuel);
+    }
+    
+    // Every value round-trips through the table
+    for (int i = 0; i < 4; ++i) {
+        FuelType parsed = FuelType::Petrol;
+        QVERIFY(XsdQt::parseXmlEnum(toXmlString(FuelType(i)), &parsed));
+        QCOMPARE(int(parsed), i);
+    }
+    FuelType unchanged = FuelType::Diesel;
+    QVERIFY(!XsdQt::parseXmlEnum(QString("electri"), &unchanged));
+    QVERIFY(!XsdQt::parseXmlEnum(XsdQt::XmlUtf8View(), &unchanged));
+    QCOMPARE(unchanged, FuelType::Diesel);
+}
+
+void TestXmlSerialization::testFacetValidation() {
+    const char* expected = nullptr;
+    QVERIFY(validateLicensePlateType("AB-123"));
+    QVERIFY(validateLicensePlateType("B-12-XY"));
+    QVERIFY(!validateLicensePlateType("A", &expected));
+    QCOMPARE(QString(expected), QString("at least 2 characters"));
+    QVERIFY(!validateLicensePlateType("ab-123", &expected));
+    QCOMPARE(QString(expected), QString("pattern [A-Z0-9]+(-[A-Z0-9]+)*"));
+    
+    // Patterns are anchored, a matching prefix is not enough
+    QVERIFY(!validateLicensePlateType("AB-123 "));
+    QVERIFY(!validateLicensePlateType("AB--12"));
+    
+    // Lengths count characters, a surrogate pair is one
+    QCOMPARE(XsdQt::xmlLength(QString::fromUtf8("a\xF0\x9F\x9A\x97" "b")), 3);
+    
+    // XSD name escapes, also inside classes; ^ and $ are ordinary characters
+    const QRegularExpression name = XsdQt::compileXmlPattern("\\i\\c*");
+    QVERIFY(name.match("_x-1.y").hasMatch());
+    QVERIFY(!name.match("1x").hasMatch());
+    QVERIFY(XsdQt::compileXmlPattern("[\\i-]+").match("a-b").hasMatch());
+    QVERIFY(XsdQt::compileXmlPattern("^a$").match("^a$").hasMatch());
+    QVERIFY(!XsdQt::compileXmlPattern("^a$").match("a").hasMatch());
+    
+    // Values outside an enumeration are reported when asked for
+    bool ok = true;
+    QXmlStreamReader reader(QString("<fuel>kerosene</fuel>"));
+    reader.readNextStartElement();
+    QCOMPARE(XsdQt::XmlHelpers::readEnum(reader, FuelType::Diesel, &ok), FuelType::Diesel);
+    QVERIFY(!ok);
+}
+
+void TestXmlSerialization::testParseErrors() {
+    const QString xml =
+        "<fleet>\n"
+        "  <name>Errors</name>\n"
+        "  <car id=\"C1\"><year>19x9</year></car>\n"
+        "  <vehicle id=\"V1\"><year>2001</year></vehicle>\n"
+        "  <car id=\"C2\"><year></year></car>\n"
+        "</fleet>";
+    
+    // Without a collector, values that don't convert are read leniently
+    XsdQt::XmlDocument<Fleet> lenient;
+    QString errorMsg;
+    QVERIFY2(lenient.loadFromString(xml, &errorMsg), qPrintable(errorMsg));
+    QCOMPARE(lenient.root()->getVehicles().size(), 3);
+    QCOMPARE(lenient.root()->getVehicles().at(0)->getYear(), 0);
+    QCOMPARE(lenient.root()->getVehicles().at(1)->getYear(), 2001);
+    
+    // Code generated with --validate fails the document at the first one
+    XsdQt::XmlDocument<ServiceRecord> failFast;
+    QVERIFY(!failFast.loadFromString("<serviceRecord vehicleId=\"V1\">\n<date>2024-05-01</date>\n<mileage>12k</mileage>\n</serviceRecord>",
+                                     &errorMsg));
+    QVERIFY2(errorMsg.startsWith("3:"), qPrintable(errorMsg));
+    QVERIFY2(errorMsg.contains("mileage: expected xs:int, found \"12k\""), qPrintable(errorMsg));
+    
+    // CollectAll reads on and reports every error with its path
+    XsdQt::XmlErrorCollector collector(XsdQt::XmlErrorCollector::CollectAll);
+    {
+        XsdQt::XmlErrorCollectorScope scope(&collector);
+        XsdQt::XmlDocument<Fleet> doc;
+        QVERIFY(!doc.loadFromString(xml, &errorMsg));
+        QCOMPARE(doc.root()->getVehicles().size(), 3);
+        QCOMPARE(doc.root()->getVehicles().at(1)->getYear(), 2001);
+    }
+    QCOMPARE(collector.count(), 2);
+    const XsdQt::XmlParseError& first = collector.errors().at(0);
+    QCOMPARE(first.kind, XsdQt::XmlParseError::InvalidValue);
+    QCOMPARE(first.path, QString("/fleet/car/year"));
+    QCOMPARE(first.expected, QString("xs:int"));
+    QCOMPARE(first.found, QString("19x9"));
+    QCOMPARE(first.line, qint64(3));
+    QCOMPARE(errorMsg, first.toString());
+    QCOMPARE(collector.errors().at(1).found, QString());
+    QCOMPARE(collector.errors().at(1).line, qint64(5));
+    
+    // A collector in FailFast mode keeps the first error
+    collector.clear();
+    collector.setMode(XsdQt::XmlErrorCollector::FailFast);
+    {
+        XsdQt::XmlErrorCollectorScope scope(&collector);
+        XsdQt::XmlDocument<Fleet> doc;
+        QVERIFY(!doc.loadFromString(xml, &errorMsg));
+    }
+    QCOMPARE(collector.count(), 1);
+    QCOMPARE(errorMsg, collector.errors().at(0).toString());
+    
+    // Same report from XmlFastReader, installed through a codec context
+    XsdQt::XmlErrorCollector fastCollector(XsdQt::XmlErrorCollector::CollectAll);
+    XsdQt::XmlCodecContext context;
+    context.setErrorCollector(&fastCollector);
+    XsdQt::XmlDocument<Fleet> viaFastReader;
+    viaFastReader.setFastReader(true);
+    QVERIFY(!viaFastReader.loadFromData(xml.toUtf8(), context, &errorMsg));
+    QCOMPARE(fastCollector.count(), 2);
+    QCOMPARE(fastCollector.errors().at(0).path, QString("/fleet/car/year"));
+    QCOMPARE(fastCollector.errors().at(0).found, QString("19x9"));
+    QCOMPARE(XsdQt::XmlErrorCollector::current(), static_cast<XsdQt::XmlErrorCollector*>(nullptr));
+}
+
+void TestXmlSerialization::testOccurrenceChecks() {
+    XsdQt::XmlDocument<ServiceRecord> valid;
+    QString errorMsg;
+    QVERIFY2(valid.loadFromString("<serviceRecord vehicleId=\"V1\"><date>2024-05-01</date><part>filter</part></serviceRecord>",
+                                  &errorMsg), qPrintable(errorMsg));
+    QCOMPARE(valid.root()->getParts().size(), 1);
+    
+    // Missing attribute and element, a repeated single element, too many parts
+    const QString xml =
+        "<serviceRecord>\n"
+        "  <mileage>10</mileage><mileage>12</mileage>\n"
+        "  <part>a</part><part>b</part><part>c</part><part>d</part>\n"
+        "</serviceRecord>";
+    XsdQt::XmlDocument<ServiceRecord> failFast;
+    QVERIFY(!failFast.loadFromString(xml, &errorMsg));
+    QVERIFY2(errorMsg.endsWith("mileage: found 2 occurrences, expected at most 1"), qPrintable(errorMsg));
+    
+    XsdQt::XmlErrorCollector collector(XsdQt::XmlErrorCollector::CollectAll);
+    {
+        XsdQt::XmlErrorCollectorScope scope(&collector);
+        XsdQt::XmlDocument<ServiceRecord> doc;
+        QVERIFY(!doc.loadFromString(xml, &errorMsg));
+        QCOMPARE(doc.root()->getMileage(), 12);
+    }
+    QCOMPARE(collector.count(), 4);
+    const QVector<XsdQt::XmlParseError>& errors = collector.errors();
+    QCOMPARE(errors.at(0).kind, XsdQt::XmlParseError::Occurrences);
+    QCOMPARE(errors.at(0).path, QString("/serviceRecord/mileage"));
+    QCOMPARE(errors.at(0).line, qint64(2));
+    QCOMPARE(errors.at(1).path, QString("/serviceRecord/@vehicleId"));
+    QCOMPARE(errors.at(1).found, QString("0"));
+    QCOMPARE(errors.at(1).line, qint64(4));
+    QCOMPARE(errors.at(2).path, QString("/serviceRecord/date"));
+    QCOMPARE(errors.at(3).path, QString("/serviceRecord/part"));
+    QCOMPARE(errors.at(3).expected, QString("at most 3"));
+    QCOMPARE(errors.at(3).found, QString("4"));
+    
+    // A truncated document fails with the reader error alone
+    collector.clear();
+    {
+        XsdQt::XmlErrorCollectorScope scope(&collector);
+        XsdQt::XmlDocument<ServiceRecord> truncated;
+        QVERIFY(!truncated.loadFromString("<serviceRecord><mileage>1</mileage>", &errorMsg));
+    }
+    QVERIFY(!collector.hasErrors());
+}
+
+void TestXmlSerialization::testPredictedSequence() {
+    struct Case {
+        const char* xml;
+        const char* date;
+        int findings;
+        const char* remark;
+    };
+    const Case cases[] = {
+        // Declaration order: every prediction hits
+        { "<inspection><inspector>Ann</inspector><date>2024-05-01</date><finding>a</finding><finding>b</finding>"
+          "<mileage>1200</mileage><remark>ok</remark></inspection>", "2024-05-01", 2, "ok" },
+        // Optional date and remark left out, so is the list
+        { "<inspection><inspector>Ann</inspector><mileage>1200</mileage></inspection>", "", 0, "" },
+        // The list ends into the next child
+        { "<inspection><inspector>Ann</inspector><finding>a</finding><finding>b</finding><finding>c</finding>"
+          "<mileage>1200</mileage></inspection>", "", 3, "" },
+        // Out of order, with an unknown child in between
+        { "<inspection><remark>late</remark><mileage>1200</mileage><extra><inspector>X</inspector></extra>"
+          "<finding>a</finding><date>2024-05-01</date><inspector>Ann</inspector><finding>b</finding></inspection>",
+          "2024-05-01", 2, "late" },
+    };
+    
+    for (const Case& c : cases) {
+        for (bool fast : { false, true }) {
+            XsdQt::XmlDocument<Inspection> doc;
+            doc.setFastReader(fast);
+            QString errorMsg;
+            QVERIFY2(doc.loadFromString(c.xml, &errorMsg), qPrintable(errorMsg));
+            QCOMPARE(doc.root()->getInspector(), QString("Ann"));
+            QCOMPARE(doc.root()->getDate(), QString(c.date));
+            QCOMPARE(doc.root()->getFindings().size(), c.findings);
+            QCOMPARE(doc.root()->getMileage(), 1200);
+            QCOMPARE(doc.root()->getRemark(), QString(c.remark));
+            if (c.findings) {
+                QCOMPARE(doc.root()->getFindings().first(), QString("a"));
+            }
+        }
+    }
+}
+
+void TestXmlSerialization::testGeneratorOutput() {
+    // The emitter itself, on the schema the generated types below come from
+    XsdGen::XsdParser parser;
+    QString errorMsg;
+    QVERIFY2(parser.parseFile(QFINDTESTDATA("inspection.xsd"), &errorMsg), qPrintable(errorMsg));
+    
+    auto generate = [&parser](const QString& outputDir, bool validation) {
+        XsdGen::CodeGenerator generator(parser.schema());
+        generator.setNamespace("Inspections");
+        generator.setFastReader(true);
+        generator.setValidation(validation);
+        QString errorMsg;
+        const bool generated = generator.generate(outputDir, &errorMsg);
+        if (!generated) {
+            qWarning() << errorMsg;
+        }
+        return generated;
+    };
+    auto contents = [](const QString& fileName) {
+        QFile file(fileName);
+        return file.open(QIODevice::ReadOnly) ? QString::fromUtf8(file.readAll()) : QString();
+    };
+    
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(generate(dir.path(), true));
+    const QString header = contents(dir.filePath("InspectionType.h"));
+    const QString source = contents(dir.filePath("InspectionType.cpp"));
+    QVERIFY(!header.isEmpty());
+    QVERIFY(!source.isEmpty());
+    
+    // Predicted sequence: the expected child first, a list predicts itself
+    QVERIFY(source.contains("    int next = 0;\n"));
+    QVERIFY(source.contains("            case 0: field = name == \"inspector\" ? 0 : -1; break;\n"));
+    QVERIFY(source.contains("            case 2: field = name == \"finding\" ? 2 : -1; break;\n"));
+    QVERIFY(source.contains("m_findings.append(XsdQt::XmlHelpers::readElementText(reader));\n"
+                            "                next = 2;\n"));
+    QVERIFY(source.contains("                else if (name == \"mileage\") field = 4;\n"));
+    
+    // Occurrence bits: @id, inspector, date, severity, mileage and remark;
+    // @id, inspector and mileage are required
+    QVERIFY(source.contains("    quint32 seen = 0;\n"));
+    QVERIFY(source.contains("if ((seen & 0x2u) && !XsdQt::XmlErrorCollector::report(reader, "
+                            "XsdQt::XmlParseError::Occurrences, \"inspector\", \"at most 1\", \"2\")) {"));
+    QVERIFY(source.contains("        if ((seen & 0x13u) != 0x13u) {\n"));
+    
+    // Presence bits of date, severity and remark
+    QVERIFY(header.contains("    quint32 m_inspectionTypePresent = 0;\n"));
+    QVERIFY(header.contains("    bool hasDate() const { return (m_inspectionTypePresent & 0x1u) != 0; }\n"));
+    QVERIFY(source.contains("m_date = value;\n                m_inspectionTypePresent |= 0x1u;\n"));
+    QVERIFY(source.contains("    if (m_inspectionTypePresent & 0x4u) {\n"));
+    
+    // Integers read at full width, narrower ones range-checked
+    QVERIFY(source.contains("m_odometer = attributes.toInt64(i, m_odometer, &ok);"));
+    QVERIFY(source.contains("m_grade = XsdQt::XmlHelpers::narrowed<qint8>(attributes.toInt(i, m_grade, &ok), m_grade, &ok);"));
+    
+    // Facets, enumerations and contiguous lists
+    QVERIFY(source.contains("if (!validateInspector(value, &expected)\n"));
+    QVERIFY(contents(dir.filePath("InspectionsFacets.h"))
+                .contains("inline bool validateInspector(const QString& value, const char** expected = nullptr) {\n"));
+    QVERIFY(contents(dir.filePath("Severity.h")).contains("enum class Severity : quint8 {\n    Minor,\n    Major\n};\n"));
+    QVERIFY(header.contains("    QVector<QString> m_findings;\n"));
+    
+    // Builder: values moved on, the object created on first use
+    QVERIFY(header.contains("        Builder& addFinding(QString value) { object().addFinding(std::move(value)); return *this; }\n"));
+    QVERIFY(header.contains("        Builder& setGrade(qint8 value) { object().setGrade(std::move(value)); return *this; }\n"));
+    QVERIFY(header.contains("        QSharedPointer<InspectionType> build() { object(); return std::move(m_object); }\n"));
+    
+    // The choice keeps its alternatives in one XmlChoice
+    const QString payment = contents(dir.filePath("PaymentType.h"));
+    QVERIFY(payment.contains("    XsdQt::XmlChoice<double, QString> m_paymentTypeChoice;\n"));
+    QVERIFY(payment.contains("    bool hasCard() const { return m_paymentTypeChoice.index() == 1; }\n"));
+    
+    // Registration table, sorted by element name
+    QVERIFY(contents(dir.filePath("InspectionsRegistry.cpp")).contains(
+        "    { \"inspection\", \"InspectionType\", &XsdQt::createXmlType<InspectionType> },\n"
+        "    { \"payment\", \"PaymentType\", &XsdQt::createXmlType<PaymentType> },\n"));
+    
+    // Without --validate: no occurrence bits, and values that don't convert
+    // are reported only to an installed collector
+    QTemporaryDir lenientDir;
+    QVERIFY(lenientDir.isValid());
+    QVERIFY(generate(lenientDir.path(), false));
+    const QString lenient = contents(lenientDir.filePath("InspectionType.cpp"));
+    QVERIFY(!lenient.contains("quint32 seen"));
+    QVERIFY(lenient.contains("    int next = 0;\n"));
+    QVERIFY(lenient.contains("if (!ok && !XsdQt::XmlErrorCollector::reportIfCollecting(reader, "
+                             "XsdQt::XmlParseError::InvalidValue, \"mileage\", \"xs:int\", text)) {"));
+}
+
+void TestXmlSerialization::testGeneratedTypes() {
+    // Types xsd2cpp generated from inspection.xsd (--validate --fast-reader
+    // --utf8-writer) at build time, read like the Inspection mock
+    using Inspections::InspectionType;
+    using Inspections::PaymentType;
+    using Inspections::Severity;
+    
+    struct Case {
+        const char* xml;
+        bool date;
+        int findings;
+        const char* remark;
+    };
+    const Case cases[] = {
+        // Declaration order: every prediction hits
+        { "<inspection id=\"I1\"><inspector>Ann</inspector><date>2024-05-01</date><finding>a</finding><finding>b</finding>"
+          "<severity>major</severity><mileage>1200</mileage><remark>ok</remark></inspection>", true, 2, "ok" },
+        // Optional date and remark left out, so is the list
+        { "<inspection id=\"I1\"><inspector>Ann</inspector><mileage>1200</mileage></inspection>", false, 0, "" },
+        // The list ends into the next child
+        { "<inspection id=\"I1\"><inspector>Ann</inspector><finding>a</finding><finding>b</finding><finding>c</finding>"
+          "<mileage>1200</mileage></inspection>", false, 3, "" },
+        // Out of order
+        { "<inspection id=\"I1\"><remark>late</remark><mileage>1200</mileage><finding>a</finding>"
+          "<date>2024-05-01</date><inspector>Ann</inspector><finding>b</finding></inspection>", true, 2, "late" },
+    };
+    
+    for (const Case& c : cases) {
+        for (bool fast : { false, true }) {
+            XsdQt::XmlDocument<InspectionType> doc;
+            doc.setFastReader(fast);
+            QString errorMsg;
+            QVERIFY2(doc.loadFromString(c.xml, &errorMsg), qPrintable(errorMsg));
+            QCOMPARE(doc.root()->getId(), QString("I1"));
+            QCOMPARE(doc.root()->getInspector(), QString("Ann"));
+            QCOMPARE(doc.root()->hasDate(), c.date);
+            if (c.date) {
+                QCOMPARE(doc.root()->getDate(), QDate(2024, 5, 1));
+            }
+            QCOMPARE(doc.root()->getFindings().size(), c.findings);
+            QCOMPARE(doc.root()->getMileage(), 1200);
+            QCOMPARE(doc.root()->hasRemark(), *c.remark != '\0');
+            QCOMPARE(doc.root()->getRemark(), QString(c.remark));
+            if (c.findings) {
+                QCOMPARE(doc.root()->getFindings().first(), QString("a"));
+            }
+        }
+    }
+    
+    // Occurrences, facets and range checks fail the document
+    struct Invalid {
+        const char* xml;
+        const char* message;
+    };
+    const Invalid invalid[] = {
+        { "<inspection id=\"I1\"><inspector>Ann</inspector></inspection>",
+          "mileage: found 0 occurrences, expected at least 1" },
+        { "<inspection id=\"I1\"><inspector>Ann</inspector><inspector>Bo</inspector><mileage>1</mileage></inspection>",
+          "inspector: found 2 occurrences, expected at most 1" },
+        { "<inspection id=\"I1\"><inspector>Annabelle M.</inspector><mileage>1</mileage></inspection>",
+          "inspector: expected at most 8 characters" },
+        { "<inspection id=\"I1\" grade=\"300\"><inspector>Ann</inspector><mileage>1</mileage></inspection>",
+          "@grade: expected xs:byte, found \"300\"" },
+        { "<inspection><inspector>Ann</inspector><mileage>1</mileage></inspection>",
+          "@id: found 0 occurrences, expected at least 1" },
+    };
+    for (const Invalid& i : invalid) {
+        for (bool fast : { false, true }) {
+            XsdQt::XmlDocument<InspectionType> doc;
+            doc.setFastReader(fast);
+            QString errorMsg;
+            QVERIFY(!doc.loadFromString(i.xml, &errorMsg));
+            QVERIFY2(errorMsg.contains(i.message), qPrintable(errorMsg));
+        }
+    }
+    
+    // Unknown children are reported and skipped
+    {
+        XsdQt::XmlErrorCollector errors(XsdQt::XmlErrorCollector::CollectAll);
+        XsdQt::XmlErrorCollectorScope scope(&errors);
+        XsdQt::XmlDocument<InspectionType> doc;
+        QVERIFY(!doc.loadFromString("<inspection id=\"I1\"><inspector>Ann</inspector><extra><mileage>7</mileage></extra>"
+                                    "<mileage>1200</mileage></inspection>"));
+        QCOMPARE(errors.count(), 1);
+        QCOMPARE(errors.errors().first().kind, XsdQt::XmlParseError::UnexpectedElement);
+        QCOMPARE(doc.root()->getMileage(), 1200);
+    }
+    
+    // Built, written through both writers alike, and read back
+    QSharedPointer<InspectionType> built = InspectionType::Builder()
+        .setId("I2")
+        .setOdometer(3000000000LL)
+        .setGrade(-5)
+        .setInspector("Bo")
+        .addFinding("rust")
+        .setSeverity(Severity::Major)
+        .setMileage(99)
+        .build();
+    QVERIFY(built->hasSeverity());
+    QVERIFY(!built->hasDate());
+    
+    XsdQt::XmlDocument<InspectionType> doc(built);
+    XsdQt::XmlWriterOptions options = XsdQt::XmlWriterOptions::compact();
+    doc.setWriterOptions(options);
+    const QString xml = doc.saveToString();
+    QVERIFY(!xml.contains("<date>"));
+    QVERIFY(!xml.contains("<remark>"));
+    options.directUtf8 = true;
+    doc.setWriterOptions(options);
+    QCOMPARE(doc.saveToString(), xml);
+    
+    XsdQt::XmlDocument<InspectionType> loaded;
+    QString errorMsg;
+    QVERIFY2(loaded.loadFromString(xml, &errorMsg), qPrintable(errorMsg));
+    QCOMPARE(loaded.root()->getOdometer(), qint64(3000000000LL));
+    QCOMPARE(loaded.root()->getGrade(), qint8(-5));
+    QCOMPARE(loaded.root()->getFindings(), QVector<QString>{ "rust" });
+    QVERIFY(loaded.root()->getSeverity() == Severity::Major);
+    QCOMPARE(loaded.root()->getMileage(), 99);
+    
+    // One alternative of the choice
+    XsdQt::XmlDocument<PaymentType> payment;
+    QVERIFY2(payment.loadFromString("<payment><card>visa</card></payment>", &errorMsg), qPrintable(errorMsg));
+    QVERIFY(payment.root()->getChoice() == PaymentType::Choice::Card);
+    QCOMPARE(payment.root()->getCard(), QString("visa"));
+    QVERIFY(!payment.root()->hasCash());
+}
+
+void TestXmlSerialization::testChoiceStorage() {
+    // Storage of a generated xs:choice; alternatives of the same type stay apart
+    using Payment = XsdQt::XmlChoice<QString, QVector<int>, QSharedPointer<Vehicle>, QString>;
+    Payment payment;
+    QVERIFY(payment.isEmpty());
+    QCOMPARE(payment.index(), -1);
+    QVERIFY(payment.value<0>().isEmpty());
+    QVERIFY(!payment.value<2>());
+    
+    payment.select<0>() = "card";
+    QCOMPARE(payment.index(), 0);
+    QCOMPARE(payment.value<0>(), QString("card"));
+    QVERIFY(payment.value<3>().isEmpty());
+    
+    // Selecting another alternative replaces the first
+    payment.select<3>() = "voucher";
+    QCOMPARE(payment.index(), 3);
+    QVERIFY(payment.value<0>().isEmpty());
+    QCOMPARE(payment.value<3>(), QString("voucher"));
+    
+    payment.select<1>().append(1);
+    payment.select<1>().append(2);
+    QCOMPARE(payment.value<1>(), QVector<int>() << 1 << 2);
+    
+    Payment copy(payment);
+    QCOMPARE(copy.index(), 1);
+    QCOMPARE(copy.value<1>().size(), 2);
+    
+    QSharedPointer<Vehicle> vehicle = QSharedPointer<Vehicle>::create();
+    payment.select<2>() = vehicle;
+    QCOMPARE(copy.index(), 1);
+    Payment moved(std::move(payment));
+    QVERIFY(payment.isEmpty());
+    QVERIFY(moved.value<2>() == vehicle);
+    
+    copy = moved;
+    moved.clear();
+    QVERIFY(moved.isEmpty());
+    QVERIFY(copy.value<2>() == vehicle);
+}
+
+void TestXmlSerialization::testOptionalPresence() {
+    // Absent optional scalars are not written back with their default
+    XsdQt::XmlDocument<ServiceRecord> doc;
+    QString errorMsg;
+    QVERIFY2(doc.loadFromString("<serviceRecord vehicleId=\"V1\"><date>2024-05-01</date></serviceRecord>", &errorMsg),
+             qPrintable(errorMsg));
+    QVERIFY(!doc.root()->hasMileage());
+    QCOMPARE(doc.root()->getMileage(), 0);
+    QVERIFY(!doc.saveToString().contains("mileage"));
+    
+    QVERIFY(doc.loadFromString("<serviceRecord vehicleId=\"V1\"><date>2024-05-01</date><mileage>0</mileage></serviceRecord>",
+                               &errorMsg));
+    QVERIFY(doc.root()->hasMileage());
+    QVERIFY(doc.saveToString().contains("<mileage>0</mileage>"));
+    
+    ServiceRecord record;
+    record.setVehicleId("V2");
+    record.setMileage(1200);
+    QVERIFY(record.hasMileage());
+    record.clearMileage();
+    QVERIFY(!record.hasMileage());
+    
+    XsdQt::XmlDocument<ServiceRecord> saved(QSharedPointer<ServiceRecord>::create(record));
+    QVERIFY(!saved.saveToString().contains("mileage"));
+}
+
+void TestXmlSerialization::testColumns() {
+    Fleet fleet;
+    for (int i = 0; i < 5; ++i) {
+        QSharedPointer<Vehicle> vehicle;
+        if (i % 2) {
+            QSharedPointer<Car> car = QSharedPointer<Car>::create();
+            car->setNumDoors(2 + i);
+            vehicle = car;
+        } else {
+            vehicle = QSharedPointer<Vehicle>::create();
+        }
+        vehicle->setId(QString("V%1").arg(i));
+        vehicle->setYear(2010 + i);
+        fleet.addVehicle(vehicle);
+    }
+    fleet.addVehicle(QSharedPointer<Vehicle>());
+    
+    // Grouped by concrete class, each group in list order
+    const FleetVehicleColumns columns = FleetVehicleColumns::fromObjects(fleet);
+    QCOMPARE(columns.size(), 5);
+    QCOMPARE(columns.vehicle.itemPosition_, QVector<int>() << 0 << 2 << 4);
+    QCOMPARE(columns.vehicle.year, QVector<int>() << 2010 << 2012 << 2014);
+    QCOMPARE(columns.car.itemPosition_, QVector<int>() << 1 << 3);
+    QCOMPARE(columns.car.numDoors, QVector<int>() << 3 << 5);
+    QCOMPARE(columns.car.id, QVector<QString>() << "V1" << "V3");
+    QCOMPARE(columns.car.year.size(), columns.car.trunkCapacity.size());
+}
+
+void TestXmlSerialization::testListMoves() {
+    Fleet fleet;
+    fleet.reserveVehicles(8);
+    QVERIFY(fleet.getVehicles().capacity() >= 8);
+    
+    // Moved in, not copied: the caller's pointer and vector are left empty
+    QSharedPointer<Vehicle> vehicle = QSharedPointer<Vehicle>::create();
+    Vehicle* raw = vehicle.data();
+    fleet.addVehicle(std::move(vehicle));
+    QVERIFY(vehicle.isNull());
+    QCOMPARE(fleet.getVehicles().first().data(), raw);
+    
+    QVector<QSharedPointer<Vehicle>> vehicles(3);
+    const QSharedPointer<Vehicle>* storage = vehicles.constData();
+    fleet.setVehicles(std::move(vehicles));
+    QVERIFY(vehicles.isEmpty());
+    QCOMPARE(fleet.getVehicles().size(), 3);
+    QCOMPARE(fleet.getVehicles().constData(), storage);
+}
+
+void TestXmlSerialization::testBuilders() {
+    // Values moved through the builder keep their buffer
+    QString plate = "BLD-0001";
+    const QChar* buffer = plate.constData();
+    QSharedPointer<Car> car = Car::Builder()
+        .setId("C1")
+        .setLicensePlate(std::move(plate))
+        .setYear(2023)
+        .setNumDoors(5)
+        .build();
+    QVERIFY(car);
+    QVERIFY(car->getLicensePlate().constData() == buffer);
+    QCOMPARE(car->getYear(), 2023);
+    QCOMPARE(car->getNumDoors(), 5);
+    
+    // A reused builder starts over instead of touching the built object
+    Car::Builder builder;
+    QSharedPointer<Car> first = builder.setId("R1").setYear(2001).build();
+    QSharedPointer<Car> second = builder.setId("R2").build();
+    QSharedPointer<Car> empty = builder.build();
+    QVERIFY(first && second && empty);
+    QVERIFY(first != second && second != empty);
+    QCOMPARE(first->getId(), QString("R1"));
+    QCOMPARE(first->getYear(), 2001);
+    QCOMPARE(second->getId(), QString("R2"));
+    QVERIFY(empty->getId().isEmpty());
+    
+    // Items emplaced into the list are the ones returned
+    Fleet fleet;
+    QSharedPointer<Car> emplaced = fleet.emplaceVehicle<Car>();
+    emplaced->setId(QString("C2"));
+    QSharedPointer<Vehicle> plain = fleet.emplaceVehicle();
+    QCOMPARE(fleet.getVehicles().size(), 2);
+    QVERIFY(fleet.getVehicles().at(0).dynamicCast<Car>() == emplaced);
+    QCOMPARE(fleet.getVehicles().at(0)->getId(), QString("C2"));
+    QVERIFY(fleet.getVehicles().at(1) == plain);
+    
+    XsdQt::XmlDocument<Car> doc(car);
+    QVERIFY(doc.saveToString().contains("BLD-0001"));
+}
+
+void TestXmlSerialization::testBatchLoader() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    
+    QStringList files;
+    for (int i = 0; i < 20; ++i) {
+        QSharedPointer<Vehicle> vehicle = QSharedPointer<Vehicle>::create();
+        vehicle->setId(QString("B%1").arg(i));
+        vehicle->setLicensePlate(QString("BAT-%1").arg(i));
+        vehicle->setYear(2000 + i);
+        
+        XsdQt::XmlDocument<Vehicle> doc(vehicle);
+        QString fileName = dir.filePath(QString("vehicle_%1.xml").arg(i));
+        QVERIFY(doc.saveToFile(fileName));
+        files << fileName;
+    }
+    
+    QString brokenFile = dir.filePath("broken.xml");
+    QFile broken(brokenFile);
+    QVERIFY(broken.open(QIODevice::WriteOnly));
+    broken.write("<vehicle id=\"X\"><licensePlate>");
+    broken.close();
+    files.insert(5, brokenFile);
+    files.insert(10, dir.filePath("missing.xml"));
+    
+    XsdQt::XmlBatchLoader<Vehicle> loader;
+    loader.setMaxThreads(4);
+    auto results = loader.load(files);
+    
+    QCOMPARE(results.size(), files.size());
+    QVERIFY(!results[5].isOk());
+    QVERIFY(!results[5].errorMsg.isEmpty());
+    QVERIFY(!results[10].isOk());
+    QVERIFY(results[10].errorMsg.contains("missing.xml"));
+    
+    int loaded = 0;
+    for (int i = 0; i < results.size(); ++i) {
+        QCOMPARE(results[i].fileName, files[i]);
+        if (i == 5 || i == 10) {
+            continue;
+        }
+        QVERIFY2(results[i].isOk(), qPrintable(results[i].errorMsg));
+        QVERIFY(results[i].root->getLicensePlate().startsWith("BAT-"));
+        ++loaded;
+    }
+    QCOMPARE(loaded, 20);
+    QCOMPARE(results[0].root->getYear(), 2000);
+    
+    // Called from the only thread of its own pool, the batch still completes
+    struct NestedLoad : QRunnable {
+        XsdQt::XmlBatchLoader<Vehicle> loader;
+        QStringList files;
+        int loaded = 0;
+        void run() override {
+            for (const auto& result : loader.load(files)) {
+                loaded += result.isOk();
+            }
+        }
+    };
+    QThreadPool pool;
+    pool.setMaxThreadCount(1);
+    NestedLoad nested;
+    nested.setAutoDelete(false);
+    nested.loader.setThreadPool(&pool);
+    nested.loader.setMaxThreads(4);
+    nested.files = files;
+    pool.start(&nested);
+    QVERIFY(pool.waitForDone(10000));
+    QCOMPARE(nested.loaded, 20);
+    
+    // A null pool selects the global instance
+    loader.setThreadPool(nullptr);
+    QCOMPARE(loader.load(files).size(), files.size());
+}
+
+void TestXmlSerialization::testCodecContextReuse() {
+    XsdQt::XmlCodecContext context(256);
+    
+    for (int i = 0; i < 3; ++i) {
+        QSharedPointer<Car> car = QSharedPointer<Car>::create();
+        car->setId(QString("CTX-%1").arg(i));
+        car->setLicensePlate(QString("CTX-%1").arg(i));
+        car->setYear(2010 + i);
+        car->setNumDoors(2 + i);
+        
+        XsdQt::XmlDocument<Car> doc(car);
+        QString errorMsg;
+        QVERIFY2(doc.saveToData(context, &errorMsg), qPrintable(errorMsg));
+        
+        const QByteArray xml = context.output();
+        QVERIFY(xml.startsWith("<?xml"));
+        QVERIFY(xml.contains("xmlns:xsi="));
+        QCOMPARE(xml.count("<car"), 1);
+        
+        XsdQt::XmlDocument<Car> doc2;
+        QVERIFY2(doc2.loadFromData(xml, context, &errorMsg), qPrintable(errorMsg));
+        QCOMPARE(doc2.root()->getLicensePlate(), QString("CTX-%1").arg(i));
+        QCOMPARE(doc2.root()->getNumDoors(), 2 + i);
+    }
+    
+    // A malformed message must not poison the next one
+    XsdQt::XmlDocument<Car> bad;
+    QVERIFY(!bad.loadFromData("<car><year>", context));
+    
+    XsdQt::XmlDocument<Car> good;
+    QVERIFY(good.loadFromData("<car id=\"OK\"><year>2001</year></car>", context));
+    QCOMPARE(good.root()->getYear(), 2001);
+}
+
+void TestXmlSerialization::testStringPool() {
+    // manufacturer is read as an interned field by the mocks
+    const QByteArray first = "<vehicle id=\"P1\"><manufacturer>PoolMotors</manufacturer></vehicle>";
+    const QByteArray second = "<car id=\"P2\"><manufacturer>PoolMotors</manufacturer></car>";
+    
+    for (bool fast : { false, true }) {
+        XsdQt::XmlStringPool pool;
+        XsdQt::XmlCodecContext context;
+        context.setStringPool(&pool);
+        
+        XsdQt::XmlDocument<Vehicle> doc1;
+        XsdQt::XmlDocument<Car> doc2;
+        doc1.setFastReader(fast);
+        doc2.setFastReader(fast);
+        QString errorMsg;
+        QVERIFY2(doc1.loadFromData(first, context, &errorMsg), qPrintable(errorMsg));
+        QVERIFY2(doc2.loadFromData(second, context, &errorMsg), qPrintable(errorMsg));
+        
+        QCOMPARE(doc2.root()->getManufacturer(), QString("PoolMotors"));
+        QCOMPARE(doc1.root()->getManufacturer().constData(), doc2.root()->getManufacturer().constData());
+        QCOMPARE(pool.size(), 1);
+        
+        // No pool installed: separate strings
+        XsdQt::XmlDocument<Vehicle> doc3;
+        doc3.setFastReader(fast);
+        QVERIFY2(doc3.loadFromData(first, &errorMsg), qPrintable(errorMsg));
+        QCOMPARE(doc3.root()->getManufacturer(), QString("PoolMotors"));
+        QVERIFY(doc3.root()->getManufacturer().constData() != doc1.root()->getManufacturer().constData());
+        
+        // A scope covers loads without a context
+        XsdQt::XmlStringPoolScope scope(&pool);
+        QVERIFY2(doc3.loadFromData(first, &errorMsg), qPrintable(errorMsg));
+        QCOMPARE(doc3.root()->getManufacturer().constData(), doc1.root()->getManufacturer().constData());
+    }
+    
+    QVERIFY(!XsdQt::XmlStringPool::current());
+}
+
+void TestXmlSerialization::testCompactWriterOptions() {
+    QSharedPointer<Car> car = QSharedPointer<Car>::create();
+    car->setId("W001");
+    car->setLicensePlate("CMP-001");
+    car->setYear(2020);
+    car->setNumDoors(3);
+    
+    XsdQt::XmlDocument<Car> doc(car);
+    QString pretty = doc.saveToString();
+    
+    doc.setWriterOptions(XsdQt::XmlWriterOptions::compact());
+    QString compact = doc.saveToString();
+    
+    QVERIFY(!compact.trimmed().contains('\n'));
+    QVERIFY(compact.size() < pretty.size());
+    QVERIFY(compact.startsWith("<?xml"));
+    QVERIFY(compact.contains("<car xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" id=\"W001\">"));
+    
+    XsdQt::XmlDocument<Car> doc2;
+    QString errorMsg;
+    QVERIFY2(doc2.loadFromString(compact, &errorMsg), qPrintable(errorMsg));
+    QCOMPARE(doc2.root()->getLicensePlate(), QString("CMP-001"));
+    QCOMPARE(doc2.root()->getNumDoors(), 3);
+    
+    // No declaration, no namespaces
+    XsdQt::XmlWriterOptions bare = XsdQt::XmlWriterOptions::compact();
+    bare.writeDeclaration = false;
+    bare.namespaces.clear();
+    doc.setWriterOptions(bare);
+    QString minimal = doc.saveToString();
+    QVERIFY(minimal.startsWith("<car id=\"W001\">"));
+    
+    // Same options through a reusable context
+    XsdQt::XmlCodecContext context(XsdQt::XmlWriterOptions::compact());
+    QVERIFY(doc.saveToData(context));
+    QCOMPARE(QString::fromUtf8(context.output()), compact);
+}
+
+void TestXmlSerialization::testDirectUtf8Writer() {
+    QSharedPointer<Fleet> fleet = QSharedPointer<Fleet>::create();
+    fleet->setName(QString::fromUtf8("Fleet <A&B> \"quoted\" caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x9a\x97"));
+    
+    QSharedPointer<Vehicle> vehicle = QSharedPointer<Vehicle>::create();
+    vehicle->setId("V\t1\n\"x\"");
+    vehicle->setLicensePlate("PLATE-0123456789-ABCDEFGHIJ");
+    vehicle->setYear(-2147483647 - 1);
+    fleet->addVehicle(vehicle);
+    
+    QSharedPointer<Car> car = QSharedPointer<Car>::create();
+    car->setId("C1");
+    car->setLicensePlate("line1\r\nline2 > line3");
+    car->setYear(2024);
+    car->setManufacturer(QString::fromUtf8("\xc3\x84rger & S\xc3\xb6hne"));
+    car->setNumDoors(5);
+    car->setTrunkCapacity(0.1 + 0.2);
+    fleet->addVehicle(car);
+    
+    XsdQt::XmlDocument<Fleet> doc(fleet);
+    XsdQt::XmlWriterOptions options = XsdQt::XmlWriterOptions::compact();
+    doc.setWriterOptions(options);
+    QByteArray viaStreamWriter = doc.saveToString().toUtf8();
+    
+    options.directUtf8 = true;
+    doc.setWriterOptions(options);
+    QByteArray direct = doc.saveToString().toUtf8();
+    QCOMPARE(direct, viaStreamWriter);
+    
+    XsdQt::XmlCodecContext context(options);
+    QVERIFY(doc.saveToData(context));
+    QCOMPARE(context.output(), viaStreamWriter);
+    
+    // Empty text elements and empty complex elements
+    XsdQt::XmlDocument<Vehicle> empty(QSharedPointer<Vehicle>::create());
+    empty.setWriterOptions(XsdQt::XmlWriterOptions::compact());
+    QByteArray emptyViaStreamWriter = empty.saveToString().toUtf8();
+    empty.setWriterOptions(options);
+    QCOMPARE(empty.saveToString().toUtf8(), emptyViaStreamWriter);
+    
+    XsdQt::XmlDocument<Fleet> doc2;
+    QString errorMsg;
+    QVERIFY2(doc2.loadFromString(QString::fromUtf8(direct), &errorMsg), qPrintable(errorMsg));
+    QCOMPARE(doc2.root()->getName(), fleet->getName());
+    QCOMPARE(doc2.root()->getVehicles().size(), 2);
+    
+    // 64-bit, unsigned and floating-point values are formatted as XmlHelpers formats them
+    QString streamed;
+    QXmlStreamWriter streamWriter(&streamed);
+    streamWriter.writeStartElement("record");
+    XsdQt::XmlHelpers::writeAttribute(streamWriter, "total", std::numeric_limits<qint64>::min());
+    XsdQt::XmlHelpers::writeAttribute(streamWriter, "count", std::numeric_limits<quint32>::max());
+    XsdQt::XmlHelpers::writeAttribute(streamWriter, "big", std::numeric_limits<quint64>::max());
+    XsdQt::XmlHelpers::writeAttribute(streamWriter, "ratio", 0.1 + 0.2);
+    XsdQt::XmlHelpers::writeElement(streamWriter, "long", std::numeric_limits<qint64>::max());
+    XsdQt::XmlHelpers::writeElement(streamWriter, "unsignedInt", quint32(0));
+    XsdQt::XmlHelpers::writeElement(streamWriter, "unsignedLong", std::numeric_limits<quint64>::max());
+    streamWriter.writeEndElement();
+    
+    QByteArray utf8;
+    XsdQt::XmlUtf8Writer utf8Writer(&utf8);
+    utf8Writer.writeStartElement("record");
+    utf8Writer.writeAttribute("total", std::numeric_limits<qint64>::min());
+    utf8Writer.writeAttribute("count", std::numeric_limits<quint32>::max());
+    utf8Writer.writeAttribute("big", std::numeric_limits<quint64>::max());
+    utf8Writer.writeAttribute("ratio", 0.1 + 0.2);
+    utf8Writer.writeTextElement("long", std::numeric_limits<qint64>::max());
+    utf8Writer.writeTextElement("unsignedInt", quint32(0));
+    utf8Writer.writeTextElement("unsignedLong", std::numeric_limits<quint64>::max());
+    utf8Writer.writeEndElement();
+    QVERIFY(!utf8Writer.hasError());
+    QCOMPARE(utf8, streamed.toUtf8());
+}
+
+void TestXmlSerialization::testFastReader() {
+    QByteArray xml =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<p:root xmlns:p=\"urn:test\" a=\"1 &amp; 2\" b='x\ty'>"
+        "<item>caf\xc3\xa9 &lt;&#x41;&#66;&gt;</item>"
+        "<empty/>"
+        "<!-- comment --><![CDATA[<raw & text>]]>"
+        "</p:root>\n";
+    
+    XsdQt::XmlFastReader reader(xml);
+    QCOMPARE(reader.readNext(), XsdQt::XmlFastReader::StartDocument);
+    QCOMPARE(reader.readNext(), XsdQt::XmlFastReader::StartElement);
+    QVERIFY(reader.qualifiedName() == "p:root");
+    QVERIFY(reader.name() == "root");
+    QVERIFY(reader.namespaceUri() == "urn:test");
+    QCOMPARE(reader.attributeValue("a").toString(), QString("1 & 2"));
+    QCOMPARE(reader.attributeValue("b").toString(), QString("x y"));
+    
+    QCOMPARE(reader.readNext(), XsdQt::XmlFastReader::StartElement);
+    QCOMPARE(reader.readElementText(), QString::fromUtf8("caf\xc3\xa9 <AB>"));
+    QVERIFY(reader.isEndElement());
+    
+    QCOMPARE(reader.readNext(), XsdQt::XmlFastReader::StartElement);
+    QVERIFY(reader.name() == "empty");
+    QCOMPARE(reader.readNext(), XsdQt::XmlFastReader::EndElement);
+    QVERIFY(reader.name() == "empty");
+    
+    QCOMPARE(reader.readNext(), XsdQt::XmlFastReader::Comment);
+    QCOMPARE(reader.readNext(), XsdQt::XmlFastReader::Characters);
+    QVERIFY(reader.isCDATA());
+    QVERIFY(reader.text() == "<raw & text>");
+    QCOMPARE(reader.readNext(), XsdQt::XmlFastReader::EndElement);
+    QCOMPARE(reader.readNext(), XsdQt::XmlFastReader::EndDocument);
+    QVERIFY(!reader.hasError());
+    
+    // Malformed input
+    reader.setData("<a><b></a>");
+    while (!reader.atEnd()) {
+        reader.readNext();
+    }
+    QVERIFY(reader.hasError());
+    QVERIFY(!reader.isUnsupported());
+    
+    QVERIFY(XsdQt::XmlFastReader::canRead("<?xml version=\"1.0\" encoding=\"utf-8\"?><a/>"));
+    QVERIFY(!XsdQt::XmlFastReader::canRead("<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?><a/>"));
+    
+    // Same objects through both readers
+    QSharedPointer<Fleet> fleet = QSharedPointer<Fleet>::create();
+    fleet->setName(QString::fromUtf8("Fleet <A&B> caf\xc3\xa9"));
+    for (int i = 0; i < 20; ++i) {
+        QSharedPointer<Vehicle> vehicle = (i % 2) ? QSharedPointer<Vehicle>(QSharedPointer<Car>::create())
+                                                  : QSharedPointer<Vehicle>::create();
+        vehicle->setId(QString("F%1").arg(i));
+        vehicle->setLicensePlate(QString("FAST-%1\r\nline").arg(i));
+        vehicle->setYear(2000 + i);
+        fleet->addVehicle(vehicle);
+    }
+    QString saved = XsdQt::XmlDocument<Fleet>(fleet).saveToString();
+    
+    XsdQt::XmlDocument<Fleet> viaStreamReader;
+    XsdQt::XmlDocument<Fleet> viaFastReader;
+    viaFastReader.setFastReader(true);
+    QString errorMsg;
+    QVERIFY2(viaStreamReader.loadFromString(saved, &errorMsg), qPrintable(errorMsg));
+    QVERIFY2(viaFastReader.loadFromString(saved, &errorMsg), qPrintable(errorMsg));
+    
+    QCOMPARE(viaFastReader.root()->getName(), viaStreamReader.root()->getName());
+    QCOMPARE(viaFastReader.root()->getVehicles().size(), 20);
+    for (int i = 0; i < 20; ++i) {
+        const auto& expected = viaStreamReader.root()->getVehicles().at(i);
+        const auto& actual = viaFastReader.root()->getVehicles().at(i);
+        QCOMPARE(actual->xsdTypeName(), expected->xsdTypeName());
+        QCOMPARE(actual->getId(), expected->getId());
+        QCOMPARE(actual->getLicensePlate(), expected->getLicensePlate());
+        QCOMPARE(actual->getYear(), expected->getYear());
+    }
+    
+    XsdQt::XmlCodecContext context;
+    XsdQt::XmlDocument<Fleet> viaContext;
+    viaContext.setFastReader(true);
+    QVERIFY2(viaContext.loadFromData(saved.toUtf8(), context, &errorMsg), qPrintable(errorMsg));
+    QCOMPARE(viaContext.root()->getVehicles().size(), 20);
+    
+    // Errors are reported, not retried
+    XsdQt::XmlDocument<Fleet> broken;
+    broken.setFastReader(true);
+    QVERIFY(!broken.loadFromString("<fleet><name>x</fleet>", &errorMsg));
+    QVERIFY(!errorMsg.isEmpty());
+    
+    // DTDs fall back to QXmlStreamReader
+    XsdQt::XmlDocument<Vehicle> withDtd;
+    withDtd.setFastReader(true);
+    QVERIFY2(withDtd.loadFromString("<!DOCTYPE vehicle><vehicle id=\"D1\"><year>1999</year></vehicle>", &errorMsg),
+             qPrintable(errorMsg));
+    QCOMPARE(withDtd.root()->getId(), QString("D1"));
+    QCOMPARE(withDtd.root()->getYear(), 1999);
+}
+
+void TestXmlSerialization::testFastReaderRejects() {
+    // Both readers must reject the same malformed documents
+    const QByteArray malformed[] = {
+        "<1a/>",
+        "<a -b=\"1\"/>",
+        "<a:b:c xmlns:a=\"urn:a\"/>",
+        "<p:a/>",
+        "<a p:b=\"1\"/>",
+        "<a><p:b xmlns:q=\"urn:q\"/></a>",
+        "<a>\xff</a>",
+        "<a>caf\xc3\x28</a>",
+        "<a>\xed\xa0\x80</a>",
+        "<a>\x01</a>",
+        "<a b=\"\xc0\xaf\"/>",
+        "<a>x]]>y</a>",
+    };
+    for (const QByteArray& xml : malformed) {
+        QXmlStreamReader streamReader(xml);
+        while (!streamReader.atEnd()) {
+            streamReader.readNext();
+        }
+        XsdQt::XmlFastReader fastReader(xml);
+        while (!fastReader.atEnd()) {
+            fastReader.readNext();
+        }
+        QVERIFY2(streamReader.hasError(), xml.constData());
+        QVERIFY2(fastReader.hasError(), xml.constData());
+        QVERIFY(!fastReader.isUnsupported());
+    }
+    
+    // ...and accept the same well-formed ones
+    const QByteArray wellFormed[] = {
+        "<gr\xc3\xb6\xc3\x9f" "e a.b-c=\"1\" xml:lang=\"de\"/>",
+        "<p:a xmlns:p=\"urn:p\"><p:b p:c=\"1\"/></p:a>",
+        "<a>x]]y &#x10000; \xf0\x9f\x98\x80</a>",
+        "<a><![CDATA[]]]]><![CDATA[>]]></a>",
+    };
+    for (const QByteArray& xml : wellFormed) {
+        QXmlStreamReader streamReader(xml);
+        while (!streamReader.atEnd()) {
+            streamReader.readNext();
+        }
+        XsdQt::XmlFastReader fastReader(xml);
+        while (!fastReader.atEnd()) {
+            fastReader.readNext();
+        }
+        QVERIFY2(!streamReader.hasError(), qPrintable(streamReader.errorString()));
+        QVERIFY2(!fastReader.hasError(), qPrintable(fastReader.errorString()));
+    }
+    
+    // Error positions match after non-ASCII text, one past the BMP included
+    const QByteArray xml = "<fleet><name>caf\xc3\xa9 \xf0\x9f\x98\x80</name><car id=\"C1\"><year>19x9</year></car></fleet>";
+    XsdQt::XmlErrorCollector streamErrors(XsdQt::XmlErrorCollector::CollectAll);
+    {
+        XsdQt::XmlErrorCollectorScope scope(&streamErrors);
+        XsdQt::XmlDocument<Fleet> doc;
+        QVERIFY(!doc.loadFromData(xml));
+    }
+    XsdQt::XmlErrorCollector fastErrors(XsdQt::XmlErrorCollector::CollectAll);
+    {
+        XsdQt::XmlErrorCollectorScope scope(&fastErrors);
+        XsdQt::XmlDocument<Fleet> doc;
+        doc.setFastReader(true);
+        QVERIFY(!doc.loadFromData(xml));
+    }
+    QCOMPARE(streamErrors.count(), 1);
+    QCOMPARE(fastErrors.count(), 1);
+    QCOMPARE(fastErrors.errors().at(0).line, streamErrors.errors().at(0).line);
+    QCOMPARE(fastErrors.errors().at(0).column, streamErrors.errors().at(0).column);
+}
+
 QTEST_MAIN(TestXmlSerialization)
 #include "TestXmlSerialization.moc"
@@ -0,0 +1,667 @@
+#ifndef VEHICLETYPES_H
+#define VEHICLETYPES_H
+
+#include "XmlSerializable.h"
+#include "XmlHelpers.h"
+#include "XmlAttributeBinder.h"
+#include "XmlFacets.h"
+#include <typeinfo>
+
+// Mock generated enum, as xsd2cpp emits it for an xs:enumeration simpleType
+enum class FuelType : quint8 {
+    Petrol,
+    Diesel,
+    Electric,
+    Hybrid
+};
+
+inline const XsdQt::XmlEnumTable& xmlEnumTable(FuelType) {
+    static constexpr XsdQt::XmlUtf8View names[] = {
+        "petrol",
+        "diesel",
+        "electric",
+        "hybrid",
+    };
+    static constexpr qint16 slotIndex[] = {
+        -1, 0, -1, 2, -1, 3, -1, 1,
+    };
+    static constexpr XsdQt::XmlEnumTable table = { names, slotIndex, 1u, 3 };
+    return table;
+}
+
+inline QString toXmlString(FuelType value) {
+    static const QString names[] = {
+        QStringLiteral("petrol"),
+        QStringLiteral("diesel"),
+        QStringLiteral("electric"),
+        QStringLiteral("hybrid"),
+    };
+    return names[int(value)];
+}
+
+// Mock generated validator, as xsd2cpp --validate emits it for
+// <xs:restriction base="xs:string"> with minLength 2, maxLength 10
+// and pattern [A-Z0-9]+(-[A-Z0-9]+)*
+inline bool validateLicensePlateType(const QString& value, const char** expected = nullptr) {
+    const int length = XsdQt::xmlLength(value);
+    if (length < 2) {
+        if (expected) *expected = "at least 2 characters";
+        return false;
+    }
+    if (length > 10) {
+        if (expected) *expected = "at most 10 characters";
+        return false;
+    }
+    static const QRegularExpression pattern0 = XsdQt::compileXmlPattern(QStringLiteral("[A-Z0-9]+(-[A-Z0-9]+)*"));
+    if (!pattern0.match(value).hasMatch()) {
+        if (expected) *expected = "pattern [A-Z0-9]+(-[A-Z0-9]+)*";
+        return false;
+    }
+    return true;
+}
+
+// Mock generated classes, shared by the tests and benchmarks
+class Vehicle : public XsdQt::XmlSerializable {
+public:
+    Vehicle() : m_year(0) {}
+    virtual ~Vehicle() = default;
+    
+    const QString& getLicensePlate() const { return m_licensePlate; }
+    void setLicensePlate(const QString& value) { m_licensePlate = value; }
+    void setLicensePlate(QString&& value) { m_licensePlate = std::move(value); }
+    
+    int getYear() const { return m_year; }
+    void setYear(int value) { m_year = value; }
+    
+    const QString& getManufacturer() const { return m_manufacturer; }
+    void setManufacturer(const QString& value) { m_manufacturer = value; }
+    void setManufacturer(QString&& value) { m_manufacturer = std::move(value); }
+    
+    const QString& getId() const { return m_id; }
+    void setId(const QString& value) { m_id = value; }
+    void setId(QString&& value) { m_id = std::move(value); }
+    
+    void toXml(QXmlStreamWriter& writer) const override {
+        XsdQt::XmlHelpers::writeAttribute(writer, "id", m_id);
+        XsdQt::XmlHelpers::writeElement(writer, "licensePlate", m_licensePlate);
+        XsdQt::XmlHelpers::writeElement(writer, "year", m_year);
+        XsdQt::XmlHelpers::writeElement(writer, "manufacturer", m_manufacturer);
+    }
+    
+    bool toXml(XsdQt::XmlUtf8Writer& writer) const override {
+        writer.writeAttribute("id", m_id);
+        writer.writeTextElement("licensePlate", m_licensePlate);
+        writer.writeTextElement("year", m_year);
+        writer.writeTextElement("manufacturer", m_manufacturer);
+        return true;
+    }
+    
+    bool fromXml(QXmlStreamReader& reader) override { return read(reader); }
+    bool fromXml(XsdQt::XmlFastReader& reader) override { return read(reader); }
+    
+    // Same body for both readers, as the generator emits it
+    template<typename Reader>
+    bool read(Reader& reader) {
+        m_id = QString();
+        const XsdQt::XmlAttributeBinder<Reader> attributes(reader);
+        for (int i = 0; i < attributes.count(); ++i) {
+            switch (attributes.nameHash(i)) {
+            case XsdQt::xmlNameHash("id"):
+                if (attributes.nameIs(i, "id")) {
+                    m_id = attributes.text(i);
+                }
+                break;
+            default:
+                break;
+            }
+        }
+        
+        while (!reader.atEnd()) {
+            reader.readNext();
+            
+            if (reader.isEndElement()) {
+                break;
+            }
+            
+            if (reader.isStartElement()) {
+                QString name = reader.name().toString();
+                
+                if (name == "licensePlate") {
+                    m_licensePlate = XsdQt::XmlHelpers::readElementText(reader);
+                }
+                else if (name == "year") {
+                    bool ok = false;
+                    QString text;
+                    const int value = XsdQt::XmlHelpers::readInt(reader, &ok, &text);
+                    if (!ok && !XsdQt::XmlErrorCollector::reportIfCollecting(reader, XsdQt::XmlParseError::InvalidValue, "year", "xs:int", text)) {
+                        return false;
+                    }
+                    m_year = value;
+                }
+                else if (name == "manufacturer") {
+                    m_manufacturer = XsdQt::XmlHelpers::readInternedText(reader);
+                }
+            }
+        }
+        
+        return true;
+    }
+    
+    QString xmlElementName() const override { return "vehicle"; }
+    QString xsdTypeName() const override { return "VehicleType"; }
+    
+protected:
+    QString m_licensePlate;
+    int m_year;
+    QString m_manufacturer;
+    QString m_id;
+};
+
+class Car : public Vehicle {
+public:
+    Car() : m_numDoors(0), m_trunkCapacity(0.0) {}
+    
+    int getNumDoors() const { return m_numDoors; }
+    void setNumDoors(int value) { m_numDoors = value; }
+    
+    double getTrunkCapacity() const { return m_trunkCapacity; }
+    void setTrunkCapacity(double value) { m_trunkCapacity = value; }
+    
+    void toXml(QXmlStreamWriter& writer) const override {
+        Vehicle::toXml(writer);
+        XsdQt::XmlHelpers::writeElement(writer, "numDoors", m_numDoors);
+        XsdQt::XmlHelpers::writeElement(writer, "trunkCapacity", m_trunkCapacity);
+    }
+    
+    bool toXml(XsdQt::XmlUtf8Writer& writer) const override {
+        if (!Vehicle::toXml(writer)) {
+            return false;
+        }
+        writer.writeTextElement("numDoors", m_numDoors);
+        writer.writeTextElement("trunkCapacity", m_trunkCapacity);
+        return true;
+    }
+    
+    bool fromXml(QXmlStreamReader& reader) override { return read(reader); }
+    bool fromXml(XsdQt::XmlFastReader& reader) override { return read(reader); }
+    
+    template<typename Reader>
+    bool read(Reader& reader) {
+        m_id = QString();
+        const XsdQt::XmlAttributeBinder<Reader> attributes(reader);
+        for (int i = 0; i < attributes.count(); ++i) {
+            switch (attributes.nameHash(i)) {
+            case XsdQt::xmlNameHash("id"):
+                if (attributes.nameIs(i, "id")) {
+                    m_id = attributes.text(i);
+                }
+                break;
+            default:
+                break;
+            }
+        }
+        
+        while (!reader.atEnd()) {
+            reader.readNext();
+            
+            if (reader.isEndElement()) {
+                break;
+            }
+            
+            if (reader.isStartElement()) {
+                QString name = reader.name().toString();
+                
+                if (name == "licensePlate") {
+                    m_licensePlate = XsdQt::XmlHelpers::readElementText(reader);
+                }
+                else if (name == "year") {
+                    bool ok = false;
+                    QString text;
+                    const int value = XsdQt::XmlHelpers::readInt(reader, &ok, &text);
+                    if (!ok && !XsdQt::XmlErrorCollector::reportIfCollecting(reader, XsdQt::XmlParseError::InvalidValue, "year", "xs:int", text)) {
+                        return false;
+                    }
+                    m_year = value;
+                }
+                else if (name == "manufacturer") {
+                    m_manufacturer = XsdQt::XmlHelpers::readInternedText(reader);
+                }
+                else if (name == "numDoors") {
+                    m_numDoors = XsdQt::XmlHelpers::readInt(reader);
+                }
+                else if (name == "trunkCapacity") {
+                    m_trunkCapacity = XsdQt::XmlHelpers::readDouble(reader);
+                }
+            }
+        }
+        
+        return true;
+    }
+    
+    QString xmlElementName() const override { return "car"; }
+    QString xsdTypeName() const override { return "CarType"; }
+    
+    class Builder {
+    public:
+        Builder& setLicensePlate(QString value) { object().setLicensePlate(std::move(value)); return *this; }
+        Builder& setYear(int value) { object().setYear(std::move(value)); return *this; }
+        Builder& setManufacturer(QString value) { object().setManufacturer(std::move(value)); return *this; }
+        Builder& setNumDoors(int value) { object().setNumDoors(std::move(value)); return *this; }
+        Builder& setTrunkCapacity(double value) { object().setTrunkCapacity(std::move(value)); return *this; }
+        Builder& setId(QString value) { object().setId(std::move(value)); return *this; }
+        
+        QSharedPointer<Car> build() { object(); return std::move(m_object); }
+        
+    private:
+        // Created on first use, so a builder can be reused after build()
+        Car& object() {
+            if (!m_object) {
+                m_object = QSharedPointer<Car>::create();
+            }
+            return *m_object;
+        }
+        
+        QSharedPointer<Car> m_object;
+    };
+    
+private:
+    int m_numDoors;
+    double m_trunkCapacity;
+};
+
+class Fleet : public XsdQt::XmlSerializable {
+public:
+    Fleet() {}
+    
+    const QString& getName() const { return m_name; }
+    void setName(const QString& value) { m_name = value; }
+    void setName(QString&& value) { m_name = std::move(value); }
+    
+    const QVector<QSharedPointer<Vehicle>>& getVehicles() const { return m_vehicles; }
+    void setVehicles(QVector<QSharedPointer<Vehicle>>&& vehicles) { m_vehicles = std::move(vehicles); }
+    void addVehicle(const QSharedPointer<Vehicle>& vehicle) { m_vehicles.append(vehicle); }
+    void addVehicle(QSharedPointer<Vehicle>&& vehicle) { m_vehicles.append(std::move(vehicle)); }
+    void reserveVehicles(int count) { m_vehicles.reserve(count); }
+    template<typename Class = Vehicle, typename... Args>
+    QSharedPointer<Class> emplaceVehicle(Args&&... args) {
+        QSharedPointer<Class> item = QSharedPointer<Class>::create(std::forward<Args>(args)...);
+        m_vehicles.append(item);
+        return item;
+    }
+    
+    void toXml(QXmlStreamWriter& writer) const override {
+        XsdQt::XmlHelpers::writeElement(writer, "name", m_name);
+        
+        for (const auto& vehicle : m_vehicles) {
+            if (vehicle) {
+                XsdQt::XmlHelpers::writePolymorphicElement(writer, vehicle);
+            }
+        }
+    }
+    
+    bool toXml(XsdQt::XmlUtf8Writer& writer) const override {
+        writer.writeTextElement("name", m_name);
+        
+        for (const auto& vehicle : m_vehicles) {
+            if (vehicle && !XsdQt::XmlHelpers::writePolymorphicElement(writer, vehicle)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    bool fromXml(QXmlStreamReader& reader) override { return read(reader); }
+    bool fromXml(XsdQt::XmlFastReader& reader) override { return read(reader); }
+    
+    template<typename Reader>
+    bool read(Reader& reader) {
+        while (!reader.atEnd()) {
+            reader.readNext();
+            
+            if (reader.isEndElement()) {
+                break;
+            }
+            
+            if (reader.isStartElement()) {
+                QString name = reader.name().toString();
+                
+                if (name == "name") {
+                    m_name = XsdQt::XmlHelpers::readElementText(reader);
+                }
+                // Per-field dispatch over the vehicle substitution group, as generated
+                else if (name == "vehicle") {
+                    const XsdQt::XmlErrorPath path("vehicle");
+                    appendVehicle(XsdQt::XmlHelpers::readSubstitutedElement<Vehicle, Vehicle>(reader));
+                }
+                else if (name == "car") {
+                    const XsdQt::XmlErrorPath path("car");
+                    appendVehicle(XsdQt::XmlHelpers::readSubstitutedElement<Vehicle, Car>(reader));
+                }
+                else if (name == "truck") {
+                    appendVehicle(XsdQt::XmlHelpers::readPolymorphicElement(reader).dynamicCast<Vehicle>());
+                }
+            }
+        }
+        
+        return true;
+    }
+    
+    QString xmlElementName() const override { return "fleet"; }
+    QString xsdTypeName() const override { return "FleetType"; }
+    
+private:
+    void appendVehicle(QSharedPointer<Vehicle>&& vehicle) {
+        if (vehicle) {
+            m_vehicles.append(std::move(vehicle));
+        }
+    }
+    
+    QString m_name;
+    QVector<QSharedPointer<Vehicle>> m_vehicles;
+};
+
+// Mock generated columnar view (xsd2cpp --columns) of the fleet's vehicles
+struct FleetVehicleColumns {
+    struct CarColumns {
+        QVector<int> itemPosition_;  // index of the item in the list
+        QVector<QString> licensePlate;
+        QVector<int> year;
+        QVector<QString> manufacturer;
+        QVector<int> numDoors;
+        QVector<double> trunkCapacity;
+        QVector<QString> id;
+    };
+    
+    struct VehicleColumns {
+        QVector<int> itemPosition_;  // index of the item in the list
+        QVector<QString> licensePlate;
+        QVector<int> year;
+        QVector<QString> manufacturer;
+        QVector<QString> id;
+    };
+    
+    CarColumns car;
+    VehicleColumns vehicle;
+    
+    static FleetVehicleColumns fromObjects(const Fleet& owner) {
+        FleetVehicleColumns columns;
+        const auto& items = owner.getVehicles();
+        for (int i = 0; i < items.size(); ++i) {
+            if (items.at(i)) {
+                columns.append(*items.at(i), i);
+            }
+        }
+        return columns;
+    }
+    
+    void append(const Vehicle& item, int position) {
+        const std::type_info& type = typeid(item);
+        if (type == typeid(Car)) {
+            const Car& row = static_cast<const Car&>(item);
+            car.itemPosition_.append(position);
+            car.licensePlate.append(row.getLicensePlate());
+            car.year.append(row.getYear());
+            car.manufacturer.append(row.getManufacturer());
+            car.numDoors.append(row.getNumDoors());
+            car.trunkCapacity.append(row.getTrunkCapacity());
+            car.id.append(row.getId());
+            return;
+        }
+        
+        vehicle.itemPosition_.append(position);
+        vehicle.licensePlate.append(item.getLicensePlate());
+        vehicle.year.append(item.getYear());
+        vehicle.manufacturer.append(item.getManufacturer());
+        vehicle.id.append(item.getId());
+    }
+    
+    int size() const { return car.itemPosition_.size() + vehicle.itemPosition_.size(); }
+};
+
+// Mock generated class with the xsd2cpp --validate occurrence checks, for
+// <xs:attribute name="vehicleId" use="required"/> and the sequence
+// date, mileage (minOccurs="0") and part (minOccurs="0" maxOccurs="3");
+// the optional mileage has a presence bit
+class ServiceRecord : public XsdQt::XmlSerializable {
+public:
+    ServiceRecord() : m_mileage(0) {}
+    
+    QString getVehicleId() const { return m_vehicleId; }
+    void setVehicleId(const QString& value) { m_vehicleId = value; }
+    
+    QString getDate() const { return m_date; }
+    void setDate(const QString& value) { m_date = value; }
+    
+    int getMileage() const { return m_mileage; }
+    void setMileage(const int& value) { m_mileage = value; m_serviceRecordTypePresent |= 0x1u; }
+    bool hasMileage() const { return (m_serviceRecordTypePresent & 0x1u) != 0; }
+    void clearMileage() { m_serviceRecordTypePresent &= ~0x1u; }
+    
+    const QVector<QString>& getParts() const { return m_parts; }
+    
+    void toXml(QXmlStreamWriter& writer) const override {
+        XsdQt::XmlHelpers::writeAttribute(writer, "vehicleId", m_vehicleId);
+        XsdQt::XmlHelpers::writeElement(writer, "date", m_date);
+        if (m_serviceRecordTypePresent & 0x1u) {
+            XsdQt::XmlHelpers::writeElement(writer, "mileage", m_mileage);
+        }
+        for (const QString& part : m_parts) {
+            XsdQt::XmlHelpers::writeElement(writer, "part", part);
+        }
+    }
+    
+    bool fromXml(QXmlStreamReader& reader) override { return read(reader); }
+    bool fromXml(XsdQt::XmlFastReader& reader) override { return read(reader); }
+    
+    template<typename Reader>
+    bool read(Reader& reader) {
+        quint32 seen = 0;
+        int partCount = 0;
+        
+        m_vehicleId = QString();
+        const XsdQt::XmlAttributeBinder<Reader> attributes(reader);
+        for (int i = 0; i < attributes.count(); ++i) {
+            switch (attributes.nameHash(i)) {
+            case XsdQt::xmlNameHash("vehicleId"):
+                if (attributes.nameIs(i, "vehicleId")) {
+                    seen |= 0x1u;
+                    m_vehicleId = attributes.text(i);
+                }
+                break;
+            default:
+                break;
+            }
+        }
+        
+        while (!reader.atEnd()) {
+            reader.readNext();
+            
+            if (reader.isEndElement()) {
+                break;
+            }
+            
+            if (reader.isStartElement()) {
+                QString name = reader.name().toString();
+                
+                if (name == "date") {
+                    if ((seen & 0x2u) && !XsdQt::XmlErrorCollector::report(reader, XsdQt::XmlParseError::Occurrences, "date", "at most 1", "2")) {
+                        return false;
+                    }
+                    seen |= 0x2u;
+                    m_date = XsdQt::XmlHelpers::readElementText(reader);
+                }
+                else if (name == "mileage") {
+                    if ((seen & 0x4u) && !XsdQt::XmlErrorCollector::report(reader, XsdQt::XmlParseError::Occurrences, "mileage", "at most 1", "2")) {
+                        return false;
+                    }
+                    seen |= 0x4u;
+                    bool ok = false;
+                    QString text;
+                    const int value = XsdQt::XmlHelpers::readInt(reader, &ok, &text);
+                    if (!ok && !XsdQt::XmlErrorCollector::report(reader, XsdQt::XmlParseError::InvalidValue, "mileage", "xs:int", text)) {
+                        return false;
+                    }
+                    m_mileage = value;
+                    m_serviceRecordTypePresent |= 0x1u;
+                }
+                else if (name == "part") {
+                    ++partCount;
+                    if (m_parts.isEmpty()) {
+                        m_parts.reserve(3);
+                    }
+                    m_parts.append(XsdQt::XmlHelpers::readElementText(reader));
+                }
+                else {
+                    XsdQt::XmlHelpers::skipCurrentElement(reader);
+                }
+            }
+        }
+        
+        // Required and bounded content, checked once the element is complete
+        if (!reader.hasError()) {
+            if ((seen & 0x3u) != 0x3u) {
+                if (!(seen & 0x1u)
+                    && !XsdQt::XmlErrorCollector::report(reader, XsdQt::XmlParseError::Occurrences, "@vehicleId", "at least 1", "0")) {
+                    return false;
+                }
+                if (!(seen & 0x2u)
+                    && !XsdQt::XmlErrorCollector::report(reader, XsdQt::XmlParseError::Occurrences, "date", "at least 1", "0")) {
+                    return false;
+                }
+            }
+            if (partCount > 3 && !XsdQt::XmlErrorCollector::report(reader, XsdQt::XmlParseError::Occurrences, "part", "at most 3", QString::number(partCount))) {
+                return false;
+            }
+        }
+        
+        return true;
+    }
+    
+    QString xmlElementName() const override { return "serviceRecord"; }
+    QString xsdTypeName() const override { return "ServiceRecordType"; }
+
+protected:
+    QString m_date;
+    int m_mileage;
+    QVector<QString> m_parts;
+    QString m_vehicleId;
+    quint32 m_serviceRecordTypePresent = 0;
+};
+
+// Mock generated class with the predicted dispatch of an xs:sequence:
+// inspector, date (minOccurs="0"), finding (maxOccurs="unbounded"),
+// mileage and remark (minOccurs="0")
+class Inspection : public XsdQt::XmlSerializable {
+public:
+    Inspection() : m_mileage(0) {}
+    
+    QString getInspector() const { return m_inspector; }
+    QString getDate() const { return m_date; }
+    const QVector<QString>& getFindings() const { return m_findings; }
+    int getMileage() const { return m_mileage; }
+    QString getRemark() const { return m_remark; }
+    
+    void toXml(QXmlStreamWriter& writer) const override {
+        XsdQt::XmlHelpers::writeElement(writer, "inspector", m_inspector);
+        XsdQt::XmlHelpers::writeElement(writer, "date", m_date);
+        for (const QString& finding : m_findings) {
+            XsdQt::XmlHelpers::writeElement(writer, "finding", finding);
+        }
+        XsdQt::XmlHelpers::writeElement(writer, "mileage", m_mileage);
+        XsdQt::XmlHelpers::writeElement(writer, "remark", m_remark);
+    }
+    
+    bool fromXml(QXmlStreamReader& reader) override { return read(reader); }
+    bool fromXml(XsdQt::XmlFastReader& reader) override { return read(reader); }
+    
+    template<typename Reader>
+    bool read(Reader& reader) {
+        int next = 0;
+        
+        while (!reader.atEnd()) {
+            reader.readNext();
+            
+            if (reader.isEndElement()) {
+                break;
+            }
+            
+            if (reader.isStartElement()) {
+                QString name = reader.name().toString();
+                
+                // Expected next child of the sequence first
+                int field = -1;
+                switch (next) {
+                case 0: field = name == "inspector" ? 0 : -1; break;
+                case 1: field = name == "date" ? 1 : -1; break;
+                case 2: field = name == "finding" ? 2 : -1; break;
+                case 3: field = name == "mileage" ? 3 : -1; break;
+                case 4: field = name == "remark" ? 4 : -1; break;
+                default: break;
+                }
+                if (field < 0) {
+                    if (name == "inspector") field = 0;
+                    else if (name == "date") field = 1;
+                    else if (name == "finding") field = 2;
+                    else if (name == "mileage") field = 3;
+                    else if (name == "remark") field = 4;
+                }
+                
+                switch (field) {
+                case 0: {
+                    m_inspector = XsdQt::XmlHelpers::readElementText(reader);
+                    next = 1;
+                    break;
+                }
+                case 1: {
+                    m_date = XsdQt::XmlHelpers::readElementText(reader);
+                    next = 2;
+                    break;
+                }
+                case 2: {
+                    m_findings.append(XsdQt::XmlHelpers::readElementText(reader));
+                    next = 2;
+                    break;
+                }
+                case 3: {
+                    bool ok = false;
+                    QString text;
+                    const int value = XsdQt::XmlHelpers::readInt(reader, &ok, &text);
+                    if (!ok && !XsdQt::XmlErrorCollector::reportIfCollecting(reader, XsdQt::XmlParseError::InvalidValue, "mileage", "xs:int", text)) {
+                        return false;
+                    }
+                    m_mileage = value;
+                    next = 4;
+                    break;
+                }
+                case 4: {
+                    m_remark = XsdQt::XmlHelpers::readElementText(reader);
+                    next = 5;
+                    break;
+                }
+                default:
+                    XsdQt::XmlHelpers::skipCurrentElement(reader);
+                    break;
+                }
+            }
+        }
+        
+        return true;
+    }
+    
+    QString xmlElementName() const override { return "inspection"; }
+    QString xsdTypeName() const override { return "InspectionType"; }
+
+protected:
+    QString m_inspector;
+    QString m_date;
+    QVector<QString> m_findings;
+    int m_mileage;
+    QString m_remark;
+};
+
+// Register types
+static XsdQt::XmlTypeRegistrar<Vehicle> vehicleReg("vehicle", "VehicleType");
+static XsdQt::XmlTypeRegistrar<Car> carReg("car", "CarType");
+static XsdQt::XmlTypeRegistrar<Fleet> fleetReg("fleet", "FleetType");
+
+#endif // VEHICLETYPES_H
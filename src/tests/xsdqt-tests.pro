@@ -7,13 +7,33 @@ CONFIG -= app_bundle
 
 TEMPLATE = app
 
-# Include runtime library headers
-INCLUDEPATH += ../runtime
+# Include runtime library and generator headers
+INCLUDEPATH += ../runtime ../generator
 
 # Link against runtime library
 LIBS += -L.. -lxsdqt-runtime
 
 SOURCES += \
-    TestXmlSerialization.cpp
+    TestXmlSerialization.cpp \
+    ../generator/XsdParser.cpp \
+    ../generator/CodeGenerator.cpp
 
-HEADERS +=
+HEADERS += \
+    VehicleTypes.h \
+    ../generator/XsdParser.h \
+    ../generator/CodeGenerator.h
+
+# Types generated from inspection.xsd by the xsd2cpp built alongside,
+# so the tests compile the generator's real output
+GENERATED_DIR = $$OUT_PWD/generated
+GENERATED_SCHEMAS = inspection.xsd
+INCLUDEPATH += $$GENERATED_DIR
+
+inspections.input = GENERATED_SCHEMAS
+inspections.output = $$GENERATED_DIR/InspectionsUnit0.cpp
+inspections.commands = $$OUT_PWD/../xsd2cpp ${QMAKE_FILE_IN} -o $$GENERATED_DIR \
+    -n Inspections --validate --fast-reader --utf8-writer --unity 1
+inspections.depends = $$OUT_PWD/../xsd2cpp
+inspections.variable_out = SOURCES
+inspections.CONFIG += target_predeps
+QMAKE_EXTRA_COMPILERS += inspections
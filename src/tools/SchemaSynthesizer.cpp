@@ -0,0 +1,381 @@
+#include "SchemaSynthesizer.h"
+#include <QDateTime>
+#include <QXmlStreamWriter>
+#include <algorithm>
+
+namespace XsdSynth {
+
+namespace {
+
+const QString XS_NS = QStringLiteral("http://www.w3.org/2001/XMLSchema");
+const QString XSI_NS = QStringLiteral("http://www.w3.org/2001/XMLSchema-instance");
+
+// Strings are listed twice so they make up a realistic share of the fields
+const char* const SCALAR_TYPES[] = {
+    "xs:string", "xs:string", "xs:int", "xs:long",
+    "xs:double", "xs:boolean", "xs:dateTime", "xs:date"
+};
+const int SCALAR_TYPE_COUNT = int(sizeof(SCALAR_TYPES) / sizeof(SCALAR_TYPES[0]));
+
+void writeElementDeclaration(QXmlStreamWriter& writer, const SynthField& field) {
+    writer.writeEmptyElement(XS_NS, "element");
+    writer.writeAttribute("name", field.name);
+    writer.writeAttribute("type", field.typeName);
+    if (field.optional || field.repeated) {
+        writer.writeAttribute("minOccurs", "0");
+    }
+    if (field.repeated) {
+        writer.writeAttribute("maxOccurs", "unbounded");
+    }
+}
+
+void writeAttributeDeclaration(QXmlStreamWriter& writer, const SynthField& field) {
+    writer.writeEmptyElement(XS_NS, "attribute");
+    writer.writeAttribute("name", field.name);
+    writer.writeAttribute("type", field.typeName);
+    if (!field.optional) {
+        writer.writeAttribute("use", "required");
+    }
+}
+
+} // anonymous namespace
+
+SchemaSynthesizer::SchemaSynthesizer(const SchemaOptions& options)
+    : m_options(options), m_counter(0) {
+    m_options.groups = qMax(1, m_options.groups);
+    m_options.depth = qMax(1, m_options.depth);
+    m_options.width = qMax(1, m_options.width);
+    m_options.wideWidth = qMax(1, m_options.wideWidth);
+    build();
+}
+
+void SchemaSynthesizer::build() {
+    m_random.seed(m_options.seed);
+
+    const int groups = m_options.groups;
+    const int derivedCount = qMax(0, m_options.typeCount - groups - 2);
+    m_types.reserve(groups + derivedCount);
+    m_derivedByGroup.fill(QVector<int>(), groups);
+
+    // Heads come first, so a head's index is its group number
+    for (int g = 0; g < groups; ++g) {
+        SynthType head;
+        head.name = QString("G%1BaseType").arg(g);
+        head.elementName = QString("g%1Item").arg(g);
+        head.group = g;
+
+        SynthField id;
+        id.name = head.elementName + "Id";
+        id.typeName = "xs:string";
+        head.attributes.append(id);
+
+        const int fieldCount = 1 + bounded(m_options.width);
+        for (int i = 0; i < fieldCount; ++i) {
+            head.elements.append(makeField(QString("%1F%2").arg(head.elementName).arg(i), false, g));
+        }
+        m_types.append(head);
+    }
+
+    // Derived types are dealt round-robin to the groups; within a group every
+    // depth-th type restarts at the head, the others extend the previous one
+    for (int k = 0; k < derivedCount; ++k) {
+        const int g = k % groups;
+        QVector<int>& derived = m_derivedByGroup[g];
+        const int local = derived.size();
+
+        SynthType type;
+        type.name = QString("G%1T%2Type").arg(g).arg(local);
+        type.elementName = QString("g%1t%2").arg(g).arg(local);
+        type.group = g;
+        type.base = (local % m_options.depth == 0) ? g : derived.last();
+        type.depth = m_types.at(type.base).depth + 1;
+
+        const int fieldCount = 1 + bounded(m_options.width);
+        for (int i = 0; i < fieldCount; ++i) {
+            type.elements.append(makeField(QString("%1F%2").arg(type.elementName).arg(i), true, g));
+        }
+
+        const int attributeCount = bounded(3);
+        for (int i = 0; i < attributeCount; ++i) {
+            SynthField attribute;
+            attribute.name = QString("%1A%2").arg(type.elementName).arg(i);
+            attribute.typeName = SCALAR_TYPES[bounded(SCALAR_TYPE_COUNT)];
+            attribute.optional = true;
+            type.attributes.append(attribute);
+        }
+
+        derived.append(m_types.size());
+        m_types.append(type);
+    }
+
+    for (int i = 0; i < m_options.wideWidth; ++i) {
+        SynthField field;
+        field.name = QString("wideF%1").arg(i);
+        field.typeName = SCALAR_TYPES[i % SCALAR_TYPE_COUNT];
+        m_wideElements.append(field);
+    }
+}
+
+SynthField SchemaSynthesizer::makeField(const QString& name, bool allowNested, int group) {
+    SynthField field;
+    field.name = name;
+
+    // About one in ten derived-type fields nests another group's head type
+    if (allowNested && m_options.groups > 1 && bounded(10) == 0) {
+        field.nestedGroup = (group + 1 + bounded(m_options.groups - 1)) % m_options.groups;
+        field.typeName = "tns:" + m_types.at(field.nestedGroup).name;
+    } else {
+        field.typeName = SCALAR_TYPES[bounded(SCALAR_TYPE_COUNT)];
+    }
+
+    const int occurs = bounded(8);
+    field.repeated = (occurs == 0);
+    field.optional = (occurs == 1 || occurs == 2);
+    return field;
+}
+
+int SchemaSynthesizer::maxDepth() const {
+    int depth = 0;
+    for (const SynthType& type : m_types) {
+        depth = qMax(depth, type.depth);
+    }
+    return depth;
+}
+
+QVector<int> SchemaSynthesizer::chain(int typeIndex) const {
+    QVector<int> result;
+    for (int index = typeIndex; index >= 0; index = m_types.at(index).base) {
+        result.append(index);
+    }
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+bool SchemaSynthesizer::writeSchema(QIODevice* device, QString* errorMsg) const {
+    const QString& ns = m_options.targetNamespace;
+
+    QXmlStreamWriter writer(device);
+    writer.setAutoFormatting(true);
+    writer.setAutoFormattingIndent(2);
+    writer.writeStartDocument();
+    writer.writeComment(QString(" xsdsynth: %1 complex types, %2 substitution groups, depth %3, width %4, seed %5 ")
+        .arg(complexTypeCount()).arg(m_options.groups).arg(m_options.depth)
+        .arg(m_options.width).arg(m_options.seed));
+
+    writer.writeNamespace(XS_NS, "xs");
+    writer.writeNamespace(ns, "tns");
+    writer.writeStartElement(XS_NS, "schema");
+    writer.writeAttribute("targetNamespace", ns);
+    writer.writeAttribute("elementFormDefault", "qualified");
+
+    for (const SynthType& type : m_types) {
+        writer.writeStartElement(XS_NS, "complexType");
+        writer.writeAttribute("name", type.name);
+        if (type.base >= 0) {
+            writer.writeStartElement(XS_NS, "complexContent");
+            writer.writeStartElement(XS_NS, "extension");
+            writer.writeAttribute("base", "tns:" + m_types.at(type.base).name);
+        }
+
+        writer.writeStartElement(XS_NS, "sequence");
+        for (const SynthField& field : type.elements) {
+            writeElementDeclaration(writer, field);
+        }
+        writer.writeEndElement(); // sequence
+        for (const SynthField& attribute : type.attributes) {
+            writeAttributeDeclaration(writer, attribute);
+        }
+
+        if (type.base >= 0) {
+            writer.writeEndElement(); // extension
+            writer.writeEndElement(); // complexContent
+        }
+        writer.writeEndElement(); // complexType
+    }
+
+    writer.writeStartElement(XS_NS, "complexType");
+    writer.writeAttribute("name", "WideType");
+    writer.writeStartElement(XS_NS, "sequence");
+    for (const SynthField& field : m_wideElements) {
+        writeElementDeclaration(writer, field);
+    }
+    writer.writeEndElement(); // sequence
+    writer.writeEndElement(); // complexType
+
+    writer.writeStartElement(XS_NS, "complexType");
+    writer.writeAttribute("name", "DocumentType");
+    writer.writeStartElement(XS_NS, "choice");
+    writer.writeAttribute("minOccurs", "0");
+    writer.writeAttribute("maxOccurs", "unbounded");
+    for (int g = 0; g < m_options.groups; ++g) {
+        writer.writeEmptyElement(XS_NS, "element");
+        writer.writeAttribute("ref", "tns:" + m_types.at(g).elementName);
+    }
+    writer.writeEmptyElement(XS_NS, "element");
+    writer.writeAttribute("ref", "tns:wide");
+    writer.writeEndElement(); // choice
+    writer.writeEndElement(); // complexType
+
+    for (const SynthType& type : m_types) {
+        writer.writeEmptyElement(XS_NS, "element");
+        writer.writeAttribute("name", type.elementName);
+        writer.writeAttribute("type", "tns:" + type.name);
+        if (type.base >= 0) {
+            writer.writeAttribute("substitutionGroup", "tns:" + m_types.at(type.group).elementName);
+        }
+    }
+
+    writer.writeEmptyElement(XS_NS, "element");
+    writer.writeAttribute("name", "wide");
+    writer.writeAttribute("type", "tns:WideType");
+
+    writer.writeEmptyElement(XS_NS, "element");
+    writer.writeAttribute("name", rootElementName());
+    writer.writeAttribute("type", "tns:DocumentType");
+
+    writer.writeEndElement(); // schema
+    writer.writeEndDocument();
+
+    if (writer.hasError()) {
+        if (errorMsg) *errorMsg = QString("Cannot write schema: %1").arg(device->errorString());
+        return false;
+    }
+    return true;
+}
+
+bool SchemaSynthesizer::writeInstance(QIODevice* device, const InstanceOptions& options,
+                                      qint64* itemsWritten, QString* errorMsg) {
+    // Separate stream from build(), so documents don't depend on how the schema was drawn
+    m_random.seed(m_options.seed ^ 0x9e3779b9u);
+    m_counter = 0;
+
+    const QString& ns = m_options.targetNamespace;
+    const qint64 start = device->pos();
+
+    QXmlStreamWriter writer(device);
+    writer.setAutoFormatting(!options.compact);
+    writer.setAutoFormattingIndent(2);
+    writer.writeStartDocument();
+    writer.writeNamespace(ns, "tns");
+    if (options.xsiTypeRatio > 0.0) {
+        writer.writeNamespace(XSI_NS, "xsi");
+    }
+    writer.writeStartElement(ns, rootElementName());
+
+    qint64 count = 0;
+    while (!writer.hasError()) {
+        if (options.targetBytes > 0 ? device->pos() - start >= options.targetBytes : count >= options.items) {
+            break;
+        }
+
+        if (unit() < options.wideRatio) {
+            writer.writeStartElement(ns, "wide");
+            for (const SynthField& field : m_wideElements) {
+                writer.writeTextElement(ns, field.name, valueFor(field.typeName));
+            }
+            writer.writeEndElement();
+        } else {
+            const int group = bounded(m_options.groups);
+            const QVector<int>& derived = m_derivedByGroup.at(group);
+            int index = group;
+            if (!derived.isEmpty() && unit() < options.polymorphism) {
+                index = derived.at(bounded(derived.size()));
+            }
+
+            const SynthType& type = m_types.at(index);
+            if (index != group && unit() < options.xsiTypeRatio) {
+                writer.writeStartElement(ns, m_types.at(group).elementName);
+                writer.writeAttribute(XSI_NS, "type", "tns:" + type.name);
+            } else {
+                writer.writeStartElement(ns, type.elementName);
+            }
+            writeContent(writer, index);
+            writer.writeEndElement();
+        }
+        ++count;
+    }
+
+    writer.writeEndElement(); // document
+    writer.writeEndDocument();
+
+    if (itemsWritten) *itemsWritten = count;
+    if (writer.hasError()) {
+        if (errorMsg) *errorMsg = QString("Cannot write instance: %1").arg(device->errorString());
+        return false;
+    }
+    return true;
+}
+
+void SchemaSynthesizer::writeContent(QXmlStreamWriter& writer, int typeIndex) {
+    const QString& ns = m_options.targetNamespace;
+    const QVector<int> types = chain(typeIndex);
+
+    // Attributes of the whole chain go on the start tag, then the base
+    // sequences in derivation order, as the extension content model requires
+    for (int index : types) {
+        for (const SynthField& attribute : m_types.at(index).attributes) {
+            if (attribute.optional && bounded(2) == 0) {
+                continue;
+            }
+            writer.writeAttribute(attribute.name, valueFor(attribute.typeName));
+        }
+    }
+
+    for (int index : types) {
+        for (const SynthField& field : m_types.at(index).elements) {
+            int occurs = 1;
+            if (field.repeated) {
+                occurs = bounded(4);
+            } else if (field.optional) {
+                occurs = bounded(4) == 0 ? 0 : 1;
+            }
+
+            for (int i = 0; i < occurs; ++i) {
+                if (field.nestedGroup >= 0) {
+                    writer.writeStartElement(ns, field.name);
+                    writeContent(writer, field.nestedGroup);
+                    writer.writeEndElement();
+                } else {
+                    writer.writeTextElement(ns, field.name, valueFor(field.typeName));
+                }
+            }
+        }
+    }
+}
+
+QString SchemaSynthesizer::valueFor(const QString& typeName) {
+    static const QDateTime epoch(QDate(2020, 1, 1), QTime(0, 0), Qt::UTC);
+    ++m_counter;
+
+    if (typeName == "xs:int") {
+        return QString::number(bounded(2000000) - 1000000);
+    }
+    if (typeName == "xs:long") {
+        return QString::number(qint64(m_random()) * 1000 + bounded(1000));
+    }
+    if (typeName == "xs:double") {
+        return QString::number(bounded(100000000) / 100.0, 'f', 2);
+    }
+    if (typeName == "xs:boolean") {
+        return bounded(2) ? QStringLiteral("true") : QStringLiteral("false");
+    }
+    if (typeName == "xs:dateTime") {
+        return epoch.addSecs(bounded(315360000)).toString(Qt::ISODate);
+    }
+    if (typeName == "xs:date") {
+        return epoch.date().addDays(bounded(3650)).toString(Qt::ISODate);
+    }
+
+    // Varying lengths, and now and then a character that must be escaped
+    QString value = QString("value %1").arg(m_counter);
+    const int extra = bounded(4);
+    for (int i = 0; i < extra; ++i) {
+        value += QString(" word%1").arg(bounded(1000));
+    }
+    if (bounded(16) == 0) {
+        value += " & <more>";
+    }
+    return value;
+}
+
+} // namespace XsdSynth
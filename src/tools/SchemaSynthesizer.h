@@ -0,0 +1,116 @@
+#ifndef SCHEMASYNTHESIZER_H
+#define SCHEMASYNTHESIZER_H
+
+#include <QIODevice>
+#include <QString>
+#include <QVector>
+#include <cstdint>
+#include <random>
+
+class QXmlStreamWriter;
+
+namespace XsdSynth {
+
+/**
+ * Shape of the synthetic schema
+ */
+struct SchemaOptions {
+    int typeCount = 1000;       // complex types, including heads, WideType and DocumentType
+    int groups = 8;             // substitution groups (one head type each)
+    int depth = 8;              // longest extension chain below a head
+    int width = 16;             // max elements in a type's own sequence
+    int wideWidth = 256;        // elements in WideType's sequence
+    quint32 seed = 1;
+    QString targetNamespace = "http://example.com/synthetic";
+};
+
+/**
+ * Size and polymorphism mix of a conforming instance document
+ */
+struct InstanceOptions {
+    qint64 items = 1000;        // children of the root element
+    qint64 targetBytes = 0;     // if > 0, keep writing items until the output reaches this size
+    double polymorphism = 0.8;  // share of group items that use a derived type
+    double xsiTypeRatio = 0.0;  // share of derived items written as head element + xsi:type
+    double wideRatio = 0.01;    // share of items that are WideType
+    bool compact = false;       // no indentation
+};
+
+/**
+ * Element or attribute of a synthetic type
+ */
+struct SynthField {
+    QString name;
+    QString typeName;           // xs:* or tns:G<n>BaseType for nested elements
+    int nestedGroup = -1;       // group whose head type is nested, or -1
+    bool optional = false;
+    bool repeated = false;      // maxOccurs="unbounded"
+};
+
+struct SynthType {
+    QString name;
+    QString elementName;        // global element, in the group's substitution group
+    int base = -1;              // index into types(), -1 for heads
+    int group = -1;
+    int depth = 0;              // extension steps below the head
+    QVector<SynthField> elements;
+    QVector<SynthField> attributes;
+};
+
+/**
+ * Generates a large XSD and instance documents that conform to it,
+ * for measuring xsd2cpp generation time and parse speed at scale
+ *
+ * The schema is fully determined by SchemaOptions (including the seed):
+ * per substitution group a head type and element, derived types forming
+ * extension chains up to the configured depth, each with its own global
+ * element substituting for the head, plus a wide type and a root element
+ * whose unbounded choice references every head. Instance documents are
+ * built from the same model, so they always validate against it.
+ */
+class SchemaSynthesizer {
+public:
+    explicit SchemaSynthesizer(const SchemaOptions& options = SchemaOptions());
+
+    const SchemaOptions& options() const { return m_options; }
+    const QVector<SynthType>& types() const { return m_types; }
+
+    /**
+     * Number of complex types written to the schema
+     */
+    int complexTypeCount() const { return m_types.size() + 2; }
+    int maxDepth() const;
+
+    bool writeSchema(QIODevice* device, QString* errorMsg = nullptr) const;
+
+    /**
+     * Write an instance document; the item count actually written is
+     * stored in itemsWritten (useful with targetBytes)
+     */
+    bool writeInstance(QIODevice* device, const InstanceOptions& options,
+                       qint64* itemsWritten = nullptr, QString* errorMsg = nullptr);
+
+    static QString rootElementName() { return QStringLiteral("document"); }
+
+private:
+    void build();
+    SynthField makeField(const QString& name, bool allowNested, int group);
+
+    QVector<int> chain(int typeIndex) const;     // head first
+    QString valueFor(const QString& typeName);
+    void writeContent(QXmlStreamWriter& writer, int typeIndex);
+
+    int bounded(int n) { return n > 0 ? int(m_random() % quint32(n)) : 0; }
+    double unit() { return double(m_random()) / 4294967296.0; }
+
+    SchemaOptions m_options;
+    QVector<SynthType> m_types;
+    QVector<QVector<int>> m_derivedByGroup;
+    QVector<SynthField> m_wideElements;
+    std::mt19937 m_random;                      // raw output only, so runs match across platforms
+    qint64 m_counter;
+};
+
+} // namespace XsdSynth
+
+#endif // SCHEMASYNTHESIZER_H
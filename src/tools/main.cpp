@@ -0,0 +1,183 @@
+#include "SchemaSynthesizer.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+
+namespace {
+
+bool intValue(const QCommandLineParser& parser, const QCommandLineOption& option, int minimum, int* value) {
+    bool ok = false;
+    const int result = parser.value(option).toInt(&ok);
+    if (!ok || result < minimum) {
+        qCritical().noquote() << QString("Error: --%1 expects an integer >= %2").arg(option.names().last()).arg(minimum);
+        return false;
+    }
+    *value = result;
+    return true;
+}
+
+bool ratioValue(const QCommandLineParser& parser, const QCommandLineOption& option, double* value) {
+    bool ok = false;
+    const double result = parser.value(option).toDouble(&ok);
+    if (!ok || result < 0.0 || result > 1.0) {
+        qCritical().noquote() << QString("Error: --%1 expects a value between 0 and 1").arg(option.names().last());
+        return false;
+    }
+    *value = result;
+    return true;
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("xsdsynth");
+    QCoreApplication::setApplicationVersion("1.0");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Synthetic XSD and instance generator for xsd2cpp scale testing");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption schemaOption(QStringList() << "s" << "schema",
+        "Write the schema to <file>", "file");
+    parser.addOption(schemaOption);
+
+    QCommandLineOption instanceOption(QStringList() << "i" << "instance",
+        "Write a conforming instance document to <file>", "file");
+    parser.addOption(instanceOption);
+
+    // Schema shape
+    QCommandLineOption typesOption("types",
+        "Number of complex types (default: 1000)", "count", "1000");
+    parser.addOption(typesOption);
+
+    QCommandLineOption groupsOption("groups",
+        "Number of substitution groups (default: 8)", "count", "8");
+    parser.addOption(groupsOption);
+
+    QCommandLineOption depthOption("depth",
+        "Longest extension chain below a group head (default: 8)", "count", "8");
+    parser.addOption(depthOption);
+
+    QCommandLineOption widthOption("width",
+        "Max elements in each type's own sequence (default: 16)", "count", "16");
+    parser.addOption(widthOption);
+
+    QCommandLineOption wideWidthOption("wide-width",
+        "Elements in the sequence of WideType (default: 256)", "count", "256");
+    parser.addOption(wideWidthOption);
+
+    QCommandLineOption seedOption("seed",
+        "Random seed; same seed and options give the same output (default: 1)", "number", "1");
+    parser.addOption(seedOption);
+
+    // Instance size and mix
+    QCommandLineOption itemsOption("items",
+        "Items under the root element (default: 1000)", "count", "1000");
+    parser.addOption(itemsOption);
+
+    QCommandLineOption sizeOption("size",
+        "Write items until the instance reaches <mb> megabytes (overrides --items)", "mb");
+    parser.addOption(sizeOption);
+
+    QCommandLineOption polymorphismOption("polymorphism",
+        "Share of items using a derived type instead of the group head (default: 0.8)", "ratio", "0.8");
+    parser.addOption(polymorphismOption);
+
+    QCommandLineOption xsiTypeOption("xsi-type",
+        "Share of derived items written as head element + xsi:type (default: 0)", "ratio", "0");
+    parser.addOption(xsiTypeOption);
+
+    QCommandLineOption wideRatioOption("wide-ratio",
+        "Share of items that are WideType (default: 0.01)", "ratio", "0.01");
+    parser.addOption(wideRatioOption);
+
+    QCommandLineOption compactOption("compact",
+        "Write the instance without indentation");
+    parser.addOption(compactOption);
+
+    parser.process(app);
+
+    if (!parser.isSet(schemaOption) && !parser.isSet(instanceOption)) {
+        qCritical() << "Error: Specify --schema and/or --instance";
+        parser.showHelp(1);
+        return 1;
+    }
+
+    XsdSynth::SchemaOptions schemaOptions;
+    int seed = 0;
+    if (!intValue(parser, typesOption, 1, &schemaOptions.typeCount)
+        || !intValue(parser, groupsOption, 1, &schemaOptions.groups)
+        || !intValue(parser, depthOption, 1, &schemaOptions.depth)
+        || !intValue(parser, widthOption, 1, &schemaOptions.width)
+        || !intValue(parser, wideWidthOption, 1, &schemaOptions.wideWidth)
+        || !intValue(parser, seedOption, 0, &seed)) {
+        return 1;
+    }
+    schemaOptions.seed = quint32(seed);
+
+    XsdSynth::InstanceOptions instanceOptions;
+    int items = 0;
+    if (!intValue(parser, itemsOption, 0, &items)
+        || !ratioValue(parser, polymorphismOption, &instanceOptions.polymorphism)
+        || !ratioValue(parser, xsiTypeOption, &instanceOptions.xsiTypeRatio)
+        || !ratioValue(parser, wideRatioOption, &instanceOptions.wideRatio)) {
+        return 1;
+    }
+    instanceOptions.items = items;
+    instanceOptions.compact = parser.isSet(compactOption);
+    if (parser.isSet(sizeOption)) {
+        bool ok = false;
+        const double megabytes = parser.value(sizeOption).toDouble(&ok);
+        if (!ok || megabytes <= 0.0) {
+            qCritical() << "Error: --size expects a positive number of megabytes";
+            return 1;
+        }
+        instanceOptions.targetBytes = qint64(megabytes * 1024 * 1024);
+    }
+
+    XsdSynth::SchemaSynthesizer synthesizer(schemaOptions);
+    QString errorMsg;
+    QElapsedTimer timer;
+
+    if (parser.isSet(schemaOption)) {
+        const QString schemaFile = parser.value(schemaOption);
+        QFile file(schemaFile);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCritical() << "Cannot open file:" << schemaFile;
+            return 1;
+        }
+
+        timer.start();
+        if (!synthesizer.writeSchema(&file, &errorMsg)) {
+            qCritical() << "Failed to write schema:" << errorMsg;
+            return 1;
+        }
+        qInfo().noquote() << QString("Schema: %1 (%2 complex types, max depth %3, %4 KB, %5 ms)")
+            .arg(schemaFile).arg(synthesizer.complexTypeCount()).arg(synthesizer.maxDepth())
+            .arg(file.size() / 1024).arg(timer.elapsed());
+    }
+
+    if (parser.isSet(instanceOption)) {
+        const QString instanceFile = parser.value(instanceOption);
+        QFile file(instanceFile);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCritical() << "Cannot open file:" << instanceFile;
+            return 1;
+        }
+
+        timer.start();
+        qint64 written = 0;
+        if (!synthesizer.writeInstance(&file, instanceOptions, &written, &errorMsg)) {
+            qCritical() << "Failed to write instance:" << errorMsg;
+            return 1;
+        }
+        qInfo().noquote() << QString("Instance: %1 (%2 items, %3 KB, %4 ms)")
+            .arg(instanceFile).arg(written).arg(file.size() / 1024).arg(timer.elapsed());
+    }
+
+    return 0;
+}
@@ -0,0 +1,17 @@
+QT += core
+QT -= gui
+
+TARGET = xsdsynth
+CONFIG += console c++14
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+    main.cpp \
+    SchemaSynthesizer.cpp
+
+HEADERS += \
+    SchemaSynthesizer.h
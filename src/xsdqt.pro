@@ -3,14 +3,19 @@ TEMPLATE = subdirs
 SUBDIRS += \
     runtime \
     generator \
-    tests
+    tests \
+    benchmarks \
+    tools
 
 runtime.file = xsdqt-runtime.pro
 generator.file = xsdqt-generator.pro
 tests.file = tests/xsdqt-tests.pro
+benchmarks.file = benchmarks/xsdqt-benchmarks.pro
+tools.file = tools/xsdqt-tools.pro
 
 # Build order
 generator.depends = runtime
-tests.depends = runtime
+tests.depends = runtime generator
+benchmarks.depends = runtime
 
 CONFIG += ordered